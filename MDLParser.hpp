@@ -6,6 +6,28 @@
 namespace MdlParser {}
 
 #include "source/accessors.hpp"
+#include "source/async-loader.hpp"
+#include "source/attachment-transforms.hpp"
+#include "source/body-groups.hpp"
+#include "source/bone-bounds.hpp"
+#include "source/bone-name-index.hpp"
+#include "source/bone-palette.hpp"
+#include "source/dedup-store.hpp"
+#include "source/draw-batches.hpp"
+#include "source/glb-exporter.hpp"
+#include "source/hot-reloader.hpp"
+#include "source/include-model-cache.hpp"
+#include "source/key-values.hpp"
+#include "source/lod-generator.hpp"
+#include "source/lod-geometry.hpp"
 #include "source/mdl.hpp"
+#include "source/model-cache.hpp"
+#include "source/model-triple.hpp"
+#include "source/parse-limits.hpp"
+#include "source/parse-stats.hpp"
 #include "source/vtx.hpp"
+#include "source/validator.hpp"
+#include "source/vpk.hpp"
+#include "source/virtual-model.hpp"
 #include "source/vvd.hpp"
+#include "source/welded-mesh.hpp"
@@ -0,0 +1,436 @@
+#include "async-loader.hpp"
+#include <array>
+#include <atomic>
+#include <deque>
+#include <system_error>
+#include <unordered_set>
+#include <vector>
+#include "helpers/io-uring.hpp"
+#include "helpers/read-file.hpp"
+#include "helpers/thread-pool.hpp"
+
+#ifdef MDLPARSER_HAS_IO_URING
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/eventfd.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace MdlParser {
+  namespace {
+    constexpr size_t FILES_PER_MODEL = 3;
+  }
+
+  struct AsyncLoader::PendingLoad {
+    ModelPaths paths;
+    Callback onComplete;
+    std::array<std::vector<std::byte>, FILES_PER_MODEL> buffers;
+    std::atomic<size_t> remainingFiles = FILES_PER_MODEL;
+
+    std::mutex errorMutex;
+    std::exception_ptr error;
+
+    [[nodiscard]] const std::filesystem::path& getPath(const size_t file) const {
+      switch (file) {
+        case 0:
+          return paths.mdl;
+        case 1:
+          return paths.vtx;
+        default:
+          return paths.vvd;
+      }
+    }
+
+    void setError(std::exception_ptr newError) {
+      std::scoped_lock lock(errorMutex);
+      if (!error) {
+        error = std::move(newError);
+      }
+    }
+  };
+
+#ifdef MDLPARSER_HAS_IO_URING
+  struct AsyncLoader::IoUringBackend {
+    /**
+     * One file of a pending load, tracked from submission to completion. The address doubles as the io_uring user data.
+     */
+    struct FileRead {
+      std::shared_ptr<PendingLoad> pending;
+      size_t file;
+      int fd = -1;
+      iovec buffer{};
+      size_t bytesRead = 0;
+    };
+
+    static constexpr uint32_t RING_ENTRIES = 256;
+    static constexpr uint64_t WAKE_USER_DATA = 0;
+
+    /**
+     * Buffers of reads abandoned after the ring failed, which the kernel may still write into until the ring is closed.
+     * Declared before the ring so they outlive it.
+     */
+    std::vector<std::vector<std::byte>> abandonedBuffers;
+
+    IoUring ring{RING_ENTRIES};
+    int wakeFd = -1;
+    std::thread thread;
+
+    std::mutex mutex;
+    std::vector<std::unique_ptr<FileRead>> incoming;
+    bool stopping = false;
+
+    IoUringBackend() {
+      wakeFd = eventfd(0, EFD_CLOEXEC);
+      if (wakeFd < 0) {
+        throw std::system_error(errno, std::system_category(), "Failed to create eventfd for io_uring loader");
+      }
+    }
+
+    ~IoUringBackend() {
+      close(wakeFd);
+    }
+
+    IoUringBackend(const IoUringBackend&) = delete;
+    IoUringBackend& operator=(const IoUringBackend&) = delete;
+    IoUringBackend(IoUringBackend&&) = delete;
+    IoUringBackend& operator=(IoUringBackend&&) = delete;
+
+    void wake() const {
+      const uint64_t value = 1;
+      [[maybe_unused]] const auto written = write(wakeFd, &value, sizeof(value));
+    }
+  };
+#else
+  struct AsyncLoader::IoUringBackend {};
+#endif
+
+  AsyncLoader::Awaitable::Awaitable(AsyncLoader& loader, ModelPaths paths) : loader(loader), paths(std::move(paths)) {}
+
+  void AsyncLoader::Awaitable::await_suspend(const std::coroutine_handle<> handle) {
+    loader.load(std::move(paths), [this, handle](std::shared_ptr<const ModelTriple> loaded, std::exception_ptr failure) {
+      model = std::move(loaded);
+      error = std::move(failure);
+      handle.resume();
+    });
+  }
+
+  std::shared_ptr<const ModelTriple> AsyncLoader::Awaitable::await_resume() {
+    if (error) {
+      std::rethrow_exception(error);
+    }
+
+    return std::move(model);
+  }
+
+  AsyncLoader::AsyncLoader(const size_t workerCount, const Backend backend) : backend(backend) {
+#ifdef MDLPARSER_HAS_IO_URING
+    if (backend != Backend::ThreadPool) {
+      try {
+        ioUring = std::make_unique<IoUringBackend>();
+        this->backend = Backend::IoUring;
+      } catch (const std::system_error&) {
+        if (backend == Backend::IoUring) {
+          throw;
+        }
+      }
+    }
+#else
+    if (backend == Backend::IoUring) {
+      throw std::system_error(
+        std::make_error_code(std::errc::function_not_supported), "io_uring is not supported on this platform"
+      );
+    }
+#endif
+
+    if (!ioUring) {
+      this->backend = Backend::ThreadPool;
+    }
+
+    workers = std::make_unique<ThreadPool>(workerCount);
+
+#ifdef MDLPARSER_HAS_IO_URING
+    if (ioUring) {
+      ioUring->thread = std::thread([this] { runIoUring(); });
+    }
+#endif
+  }
+
+  AsyncLoader::~AsyncLoader() {
+#ifdef MDLPARSER_HAS_IO_URING
+    if (ioUring) {
+      {
+        std::scoped_lock lock(ioUring->mutex);
+        ioUring->stopping = true;
+      }
+      ioUring->wake();
+      ioUring->thread.join();
+    }
+#endif
+
+    // Drains any parse jobs queued by the final reads
+    workers.reset();
+  }
+
+  void AsyncLoader::load(ModelPaths paths, Callback onComplete) {
+    auto pending = std::make_shared<PendingLoad>();
+    pending->paths = std::move(paths);
+    pending->onComplete = std::move(onComplete);
+
+    {
+      std::scoped_lock lock(outstandingMutex);
+      outstanding++;
+    }
+
+#ifdef MDLPARSER_HAS_IO_URING
+    if (ioUring) {
+      {
+        std::scoped_lock lock(ioUring->mutex);
+        for (size_t file = 0; file < FILES_PER_MODEL; file++) {
+          ioUring->incoming.push_back(
+            std::make_unique<IoUringBackend::FileRead>(IoUringBackend::FileRead{.pending = pending, .file = file})
+          );
+        }
+      }
+      ioUring->wake();
+      return;
+    }
+#endif
+
+    for (size_t file = 0; file < FILES_PER_MODEL; file++) {
+      workers->enqueue([this, pending, file] {
+        try {
+          pending->buffers[file] = readFile(pending->getPath(file));
+        } catch (...) {
+          pending->setError(std::current_exception());
+        }
+
+        fileCompleted(pending);
+      });
+    }
+  }
+
+  AsyncLoader::Awaitable AsyncLoader::loadAsync(ModelPaths paths) {
+    return {*this, std::move(paths)};
+  }
+
+  void AsyncLoader::waitIdle() {
+    std::unique_lock lock(outstandingMutex);
+    outstandingChanged.wait(lock, [this] { return outstanding == 0; });
+  }
+
+  AsyncLoader::Backend AsyncLoader::getBackend() const {
+    return backend;
+  }
+
+  void AsyncLoader::fileCompleted(const std::shared_ptr<PendingLoad>& pending) {
+    if (pending->remainingFiles.fetch_sub(1, std::memory_order_acq_rel) != 1) {
+      return;
+    }
+
+    if (backend == Backend::ThreadPool) {
+      // Already on a worker, so parse immediately while the data is hot in cache
+      finish(pending);
+    } else {
+      workers->enqueue([this, pending] { finish(pending); });
+    }
+  }
+
+  void AsyncLoader::finish(const std::shared_ptr<PendingLoad>& pending) {
+    std::shared_ptr<const ModelTriple> model;
+    auto error = pending->error;
+
+    if (!error) {
+      try {
+        model = std::make_shared<const ModelTriple>(pending->buffers[0], pending->buffers[1], pending->buffers[2]);
+      } catch (...) {
+        error = std::current_exception();
+      }
+    }
+
+    pending->buffers = {};
+    pending->onComplete(std::move(model), std::move(error));
+
+    {
+      std::scoped_lock lock(outstandingMutex);
+      outstanding--;
+    }
+    outstandingChanged.notify_all();
+  }
+
+  void AsyncLoader::runIoUring() {
+#ifdef MDLPARSER_HAS_IO_URING
+    using FileRead = IoUringBackend::FileRead;
+
+    auto& ring = ioUring->ring;
+    const auto maxInFlight = ring.getCapacity() - 1; // One entry is always reserved for the wake poll
+
+    std::deque<std::unique_ptr<FileRead>> backlog;
+    std::unordered_set<FileRead*> inFlight;
+
+    // Set if the ring stops working, after which every read fails with it
+    std::exception_ptr ringError;
+
+    const auto fail = [this](std::unique_ptr<FileRead> read, std::exception_ptr error) {
+      if (read->fd >= 0) {
+        close(read->fd);
+      }
+
+      read->pending->setError(std::move(error));
+      fileCompleted(read->pending);
+    };
+
+    const auto complete = [this](std::unique_ptr<FileRead> read) {
+      close(read->fd);
+      fileCompleted(read->pending);
+    };
+
+    // Returns false if the submission queue is full, in which case the read is put back at the front of the backlog
+    const auto submit = [&](std::unique_ptr<FileRead> read) {
+      if (!ring.queueRead(read->fd, &read->buffer, read->bytesRead, reinterpret_cast<uint64_t>(read.get()))) {
+        backlog.push_front(std::move(read));
+        return false;
+      }
+
+      inFlight.insert(read.release());
+      return true;
+    };
+
+    const auto start = [&](std::unique_ptr<FileRead> read) {
+      // Reads put back by submit() have already been opened
+      if (read->fd >= 0) {
+        return submit(std::move(read));
+      }
+
+      const auto& path = read->pending->getPath(read->file);
+
+      read->fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+      struct stat fileStats {};
+      if (read->fd < 0 || fstat(read->fd, &fileStats) != 0) {
+        fail(
+          std::move(read),
+          std::make_exception_ptr(std::system_error(errno, std::system_category(), "Failed to open " + path.string()))
+        );
+        return true;
+      }
+
+      auto& buffer = read->pending->buffers[read->file];
+      buffer.resize(static_cast<size_t>(fileStats.st_size));
+
+      if (buffer.empty()) {
+        complete(std::move(read));
+        return true;
+      }
+
+      read->buffer = {.iov_base = buffer.data(), .iov_len = buffer.size()};
+      return submit(std::move(read));
+    };
+
+    const auto failAll = [&]() {
+      for (auto* inFlightRead : inFlight) {
+        std::unique_ptr<FileRead> read(inFlightRead);
+        ioUring->abandonedBuffers.push_back(std::move(read->pending->buffers[read->file]));
+        fail(std::move(read), ringError);
+      }
+      inFlight.clear();
+
+      while (!backlog.empty()) {
+        auto read = std::move(backlog.front());
+        backlog.pop_front();
+        fail(std::move(read), ringError);
+      }
+    };
+
+    const auto handleCompletion = [&](const IoUring::Completion& completion) {
+      std::unique_ptr<FileRead> read(reinterpret_cast<FileRead*>(completion.userData));
+      inFlight.erase(read.get());
+
+      if (completion.result == -EINTR || completion.result == -EAGAIN) {
+        submit(std::move(read));
+        return;
+      }
+
+      if (completion.result <= 0) {
+        const auto& path = read->pending->getPath(read->file);
+        const auto error = completion.result < 0
+          ? std::system_error(-completion.result, std::system_category(), "Failed to read " + path.string())
+          : std::system_error(std::make_error_code(std::errc::io_error), "Unexpected end of file in " + path.string());
+
+        fail(std::move(read), std::make_exception_ptr(error));
+        return;
+      }
+
+      read->bytesRead += static_cast<size_t>(completion.result);
+      const auto& buffer = read->pending->buffers[read->file];
+
+      if (read->bytesRead < buffer.size()) {
+        // Short read, queue up the remainder
+        read->buffer = {.iov_base = const_cast<std::byte*>(buffer.data()) + read->bytesRead,
+                        .iov_len = buffer.size() - read->bytesRead};
+        submit(std::move(read));
+        return;
+      }
+
+      complete(std::move(read));
+    };
+
+    ring.queuePoll(ioUring->wakeFd, IoUringBackend::WAKE_USER_DATA);
+
+    while (true) {
+      bool stopping;
+      {
+        std::scoped_lock lock(ioUring->mutex);
+        for (auto& read : ioUring->incoming) {
+          backlog.push_back(std::move(read));
+        }
+        ioUring->incoming.clear();
+        stopping = ioUring->stopping;
+      }
+
+      if (ringError) {
+        failAll();
+        if (stopping) {
+          return;
+        }
+
+        // Without a working ring, block on the eventfd directly until more loads arrive (or the loader stops)
+        uint64_t value;
+        [[maybe_unused]] const auto bytesRead = read(ioUring->wakeFd, &value, sizeof(value));
+        continue;
+      }
+
+      while (inFlight.size() < maxInFlight && !backlog.empty()) {
+        auto read = std::move(backlog.front());
+        backlog.pop_front();
+        if (!start(std::move(read))) {
+          break;
+        }
+      }
+
+      if (stopping && inFlight.empty() && backlog.empty()) {
+        return;
+      }
+
+      try {
+        // Only waits if a completion is coming, as reads left in the backlog by a full queue need another pass
+        ring.submitAndWait(inFlight.empty() && !backlog.empty() ? 0 : 1);
+      } catch (...) {
+        ringError = std::current_exception();
+        continue;
+      }
+
+      IoUring::Completion completion{};
+      while (ring.popCompletion(completion)) {
+        if (completion.userData == IoUringBackend::WAKE_USER_DATA) {
+          uint64_t value;
+          [[maybe_unused]] const auto bytesRead = read(ioUring->wakeFd, &value, sizeof(value));
+          ring.queuePoll(ioUring->wakeFd, IoUringBackend::WAKE_USER_DATA);
+          continue;
+        }
+
+        handleCompletion(completion);
+      }
+    }
+#endif
+  }
+}
@@ -0,0 +1,144 @@
+#pragma once
+
+#include <condition_variable>
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include "model-triple.hpp"
+
+namespace MdlParser {
+  class ThreadPool;
+
+  /**
+   * Loads and parses models from disk asynchronously, overlapping file I/O with parsing.
+   *
+   * Reads for every file of every requested model are kept in flight at once, and each model is parsed on a worker
+   * thread as soon as the last of its three files arrives.
+   * On Linux, reads are issued through io_uring where the kernel allows it, otherwise each file is read by a worker.
+   */
+  class AsyncLoader {
+  public:
+    /**
+     * Mechanism used to read files.
+     */
+    enum class Backend : uint8_t {
+      /**
+       * Use io_uring if available, falling back to the thread pool.
+       */
+      Automatic,
+
+      /**
+       * Submit reads to a Linux io_uring from a dedicated I/O thread.
+       */
+      IoUring,
+
+      /**
+       * Perform blocking reads on the worker threads.
+       */
+      ThreadPool,
+    };
+
+    /**
+     * Called on a worker thread once a model has finished loading.
+     * Exactly one of model and error will be set. Must not throw.
+     */
+    using Callback = std::function<void(std::shared_ptr<const ModelTriple> model, std::exception_ptr error)>;
+
+    /**
+     * Awaitable returned by loadAsync() for use in C++20 coroutines.
+     * @remarks The awaiting coroutine is resumed on one of the loader's worker threads.
+     */
+    class Awaitable {
+    public:
+      [[nodiscard]] bool await_ready() const noexcept {
+        return false;
+      }
+
+      void await_suspend(std::coroutine_handle<> handle);
+
+      /**
+       * @return The parsed model.
+       * @throws Any error raised while reading or parsing the model.
+       */
+      std::shared_ptr<const ModelTriple> await_resume();
+
+    private:
+      friend class AsyncLoader;
+
+      Awaitable(AsyncLoader& loader, ModelPaths paths);
+
+      AsyncLoader& loader;
+      ModelPaths paths;
+      std::shared_ptr<const ModelTriple> model;
+      std::exception_ptr error;
+    };
+
+    /**
+     * Creates the loader and starts its worker threads.
+     * @param workerCount Number of threads used for parsing (and reading, if using the thread pool backend).
+     * @param backend Mechanism used to read files.
+     * @throws std::system_error if Backend::IoUring is requested but io_uring is unavailable.
+     */
+    explicit AsyncLoader(
+      size_t workerCount = std::thread::hardware_concurrency(), Backend backend = Backend::Automatic
+    );
+
+    /**
+     * Waits for all outstanding loads to complete (including their callbacks) before stopping the threads.
+     * @remarks Must not be called from within a callback or a coroutine resumed by this loader.
+     */
+    ~AsyncLoader();
+
+    AsyncLoader(const AsyncLoader&) = delete;
+    AsyncLoader& operator=(const AsyncLoader&) = delete;
+    AsyncLoader(AsyncLoader&&) = delete;
+    AsyncLoader& operator=(AsyncLoader&&) = delete;
+
+    /**
+     * Starts loading a model, returning immediately.
+     * @param paths Paths to the model's files.
+     * @param onComplete Called on a worker thread with the parsed model or the error which prevented loading it.
+     */
+    void load(ModelPaths paths, Callback onComplete);
+
+    /**
+     * Loads a model from within a coroutine.
+     * @code
+     * const auto model = co_await loader.loadAsync(ModelPaths::fromMdl("models/props_c17/oildrum001.mdl"));
+     * @endcode
+     * @param paths Paths to the model's files.
+     * @return Awaitable yielding the parsed model.
+     */
+    [[nodiscard]] Awaitable loadAsync(ModelPaths paths);
+
+    /**
+     * Blocks until every load started so far has completed and its callback has returned.
+     */
+    void waitIdle();
+
+    /**
+     * Gets the backend in use, which will never be Backend::Automatic.
+     */
+    [[nodiscard]] Backend getBackend() const;
+
+  private:
+    struct PendingLoad;
+    struct IoUringBackend;
+
+    Backend backend;
+    std::unique_ptr<ThreadPool> workers;
+    std::unique_ptr<IoUringBackend> ioUring;
+
+    std::mutex outstandingMutex;
+    std::condition_variable outstandingChanged;
+    size_t outstanding = 0;
+
+    void fileCompleted(const std::shared_ptr<PendingLoad>& pending);
+    void finish(const std::shared_ptr<PendingLoad>& pending);
+    void runIoUring();
+  };
+}
@@ -0,0 +1,69 @@
+#include "attachment-transforms.hpp"
+#include "errors.hpp"
+
+namespace MdlParser {
+  namespace {
+    /**
+     * Concatenates two affine transforms, as the engine's ConcatTransforms.
+     */
+    Structs::Matrix3x4 concatTransforms(const Structs::Matrix3x4& a, const Structs::Matrix3x4& b) {
+      Structs::Matrix3x4 out;
+
+      for (int row = 0; row < 3; row++) {
+        for (int column = 0; column < 4; column++) {
+          out[row][column] = a[row][0] * b[0][column] + a[row][1] * b[1][column] + a[row][2] * b[2][column];
+        }
+
+        out[row][3] += a[row][3];
+      }
+
+      return out;
+    }
+
+    Structs::Matrix3x4 getAttachmentTransform(
+      const Mdl::Attachment& attachment,
+      const std::span<const Structs::Matrix3x4> boneToWorld
+    ) {
+      if (attachment.bone < 0 || static_cast<size_t>(attachment.bone) >= boneToWorld.size()) {
+        throw Errors::OutOfBoundsAccess("Attachment bone is outside bone transforms");
+      }
+
+      return concatTransforms(boneToWorld[attachment.bone], attachment.local);
+    }
+  }
+
+  void getAttachmentTransforms(
+    const Mdl& mdl,
+    const std::span<const size_t> attachments,
+    const std::span<const Structs::Matrix3x4> boneToWorld,
+    const std::span<Structs::Matrix3x4> transforms
+  ) {
+    if (transforms.size() < attachments.size()) {
+      throw Errors::OutOfBoundsAccess("Attachment transforms output is smaller than the attachments requested");
+    }
+
+    const auto& allAttachments = mdl.getAttachments();
+    for (size_t i = 0; i < attachments.size(); i++) {
+      if (attachments[i] >= allAttachments.size()) {
+        throw Errors::OutOfBoundsAccess("Attachment is outside range");
+      }
+
+      transforms[i] = getAttachmentTransform(allAttachments[attachments[i]], boneToWorld);
+    }
+  }
+
+  void getAttachmentTransforms(
+    const Mdl& mdl,
+    const std::span<const Structs::Matrix3x4> boneToWorld,
+    const std::span<Structs::Matrix3x4> transforms
+  ) {
+    const auto& attachments = mdl.getAttachments();
+    if (transforms.size() < attachments.size()) {
+      throw Errors::OutOfBoundsAccess("Attachment transforms output is smaller than the attachments requested");
+    }
+
+    for (size_t i = 0; i < attachments.size(); i++) {
+      transforms[i] = getAttachmentTransform(attachments[i], boneToWorld);
+    }
+  }
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <span>
+#include "mdl.hpp"
+#include "structs/common.hpp"
+
+namespace MdlParser {
+  /**
+   * Computes the world transforms of a batch of a model's attachments.
+   * @param mdl The model the attachments belong to.
+   * @param attachments Indices into mdl.getAttachments() of the attachments to transform.
+   * @param boneToWorld The current world transform of each of the model's bones.
+   * @param transforms Receives the world transform of each attachment, in the same order as attachments.
+   * @throws Errors::OutOfBoundsAccess if transforms is smaller than attachments,
+   * or an attachment or its bone is out of range.
+   */
+  void getAttachmentTransforms(
+    const Mdl& mdl,
+    std::span<const size_t> attachments,
+    std::span<const Structs::Matrix3x4> boneToWorld,
+    std::span<Structs::Matrix3x4> transforms
+  );
+
+  /**
+   * Computes the world transforms of all of a model's attachments.
+   * @param mdl The model the attachments belong to.
+   * @param boneToWorld The current world transform of each of the model's bones.
+   * @param transforms Receives the world transform of each attachment, in the order of mdl.getAttachments().
+   * @throws Errors::OutOfBoundsAccess if transforms is smaller than the number of attachments,
+   * or an attachment's bone is out of range.
+   */
+  void getAttachmentTransforms(
+    const Mdl& mdl,
+    std::span<const Structs::Matrix3x4> boneToWorld,
+    std::span<Structs::Matrix3x4> transforms
+  );
+}
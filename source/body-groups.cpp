@@ -0,0 +1,102 @@
+#include "body-groups.hpp"
+#include <functional>
+#include <utility>
+
+namespace MdlParser {
+  namespace {
+    /**
+     * Gets the body value selecting the same models as body, equivalent to encoding the decoded value but without
+     * allocating.
+     */
+    int32_t normaliseBodyValue(const Mdl& mdl, const int32_t body) {
+      int32_t normalised = 0;
+      for (const auto& bodyPart : mdl.getBodyParts()) {
+        normalised = setBodyGroup(bodyPart, normalised, getBodyGroup(bodyPart, body));
+      }
+
+      return normalised;
+    }
+  }
+
+  size_t getBodyGroup(const Mdl::BodyPart& bodyPart, const int32_t body) {
+    // As in the engine, body parts with a single model never change, and a corrupt base is treated the same
+    if (bodyPart.models.size() <= 1 || bodyPart.base <= 0) {
+      return 0;
+    }
+
+    // Negative body values are not meaningful, the engine would select a model before the start of the body part
+    const auto model = body / bodyPart.base % static_cast<int32_t>(bodyPart.models.size());
+    return model < 0 ? 0 : static_cast<size_t>(model);
+  }
+
+  int32_t setBodyGroup(const Mdl::BodyPart& bodyPart, const int32_t body, const size_t model) {
+    if (model >= bodyPart.models.size() || bodyPart.base <= 0) {
+      return body;
+    }
+
+    const auto current = static_cast<int32_t>(getBodyGroup(bodyPart, body));
+    return body - current * bodyPart.base + static_cast<int32_t>(model) * bodyPart.base;
+  }
+
+  std::vector<size_t> decodeBodyValue(const Mdl& mdl, const int32_t body) {
+    const auto& bodyParts = mdl.getBodyParts();
+
+    std::vector<size_t> models(bodyParts.size());
+    for (size_t bodyPart = 0; bodyPart < bodyParts.size(); bodyPart++) {
+      models[bodyPart] = getBodyGroup(bodyParts[bodyPart], body);
+    }
+
+    return models;
+  }
+
+  int32_t encodeBodyValue(const Mdl& mdl, const std::span<const size_t> models) {
+    const auto& bodyParts = mdl.getBodyParts();
+
+    int32_t body = 0;
+    for (size_t bodyPart = 0; bodyPart < bodyParts.size() && bodyPart < models.size(); bodyPart++) {
+      body = setBodyGroup(bodyParts[bodyPart], body, models[bodyPart]);
+    }
+
+    return body;
+  }
+
+  size_t BodyGroupCache::KeyHash::operator()(const Key& key) const {
+    return std::hash<int32_t>()(key.body) ^ (std::hash<size_t>()(key.skinFamily) * 0x9e3779b97f4a7c15) ^
+      (std::hash<size_t>()(key.lod) * 0xc2b2ae3d27d4eb4f);
+  }
+
+  BodyGroupCache::BodyGroupCache(std::shared_ptr<const ModelTriple> model) : model(std::move(model)) {}
+
+  std::shared_ptr<const DrawBatches> BodyGroupCache::get(
+    const int32_t body,
+    const size_t skinFamily,
+    const size_t lod
+  ) {
+    const Key key{ .body = normaliseBodyValue(model->mdl, body), .skinFamily = skinFamily, .lod = lod };
+
+    {
+      const std::lock_guard lock(mutex);
+      if (const auto combination = combinations.find(key); combination != combinations.end()) {
+        return combination->second;
+      }
+    }
+
+    // Built without the lock so lookups of cached combinations never wait on a build
+    const auto models = decodeBodyValue(model->mdl, body);
+    auto drawBatches = std::make_shared<const DrawBatches>(
+      buildDrawBatches(model->mdl, model->vtx, skinFamily, models, lod)
+    );
+
+    const std::lock_guard lock(mutex);
+    return combinations.try_emplace(key, std::move(drawBatches)).first->second;
+  }
+
+  size_t BodyGroupCache::getCombinationCount() const {
+    const std::lock_guard lock(mutex);
+    return combinations.size();
+  }
+
+  const ModelTriple& BodyGroupCache::getModel() const {
+    return *model;
+  }
+}
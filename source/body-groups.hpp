@@ -0,0 +1,102 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <unordered_map>
+#include <vector>
+#include "draw-batches.hpp"
+#include "mdl.hpp"
+#include "model-triple.hpp"
+
+namespace MdlParser {
+  /**
+   * Gets which model of a body part a body value selects, as the engine's GetBodygroup.
+   * @param bodyPart Body part in the MDL data.
+   * @param body The body value, combining the selected model of every body part.
+   * @return Index of the selected model in bodyPart.models.
+   */
+  [[nodiscard]] size_t getBodyGroup(const Mdl::BodyPart& bodyPart, int32_t body);
+
+  /**
+   * Changes which model of a body part a body value selects, as the engine's SetBodygroup.
+   * @param bodyPart Body part in the MDL data.
+   * @param body The body value, combining the selected model of every body part.
+   * @param model Index of the model in bodyPart.models to select. Out of range indices leave body unchanged.
+   * @return The new body value.
+   */
+  [[nodiscard]] int32_t setBodyGroup(const Mdl::BodyPart& bodyPart, int32_t body, size_t model);
+
+  /**
+   * Splits a body value into the selected model of each body part.
+   * @param mdl MDL data.
+   * @param body The body value.
+   * @return Index of the selected model in each body part, suitable for buildDrawBatches.
+   */
+  [[nodiscard]] std::vector<size_t> decodeBodyValue(const Mdl& mdl, int32_t body);
+
+  /**
+   * Combines the selected model of each body part into a body value.
+   * @param mdl MDL data.
+   * @param models Index of the selected model in each body part. Missing or out of range entries select model 0.
+   * @return The body value.
+   */
+  [[nodiscard]] int32_t encodeBodyValue(const Mdl& mdl, std::span<const size_t> models);
+
+  /**
+   * Thread-safe cache of a model's draw batches for each combination of body groups, skin and level of detail,
+   * so that switching an entity's body groups is a hash lookup once each combination has been seen.
+   *
+   * Body values are normalised before lookup, so values selecting the same models share an entry.
+   */
+  class BodyGroupCache {
+  public:
+    /**
+     * Creates an empty cache for a model, keeping the model alive for as long as the cache.
+     * @param model
+     */
+    explicit BodyGroupCache(std::shared_ptr<const ModelTriple> model);
+
+    /**
+     * Gets the draw batches for a combination of body groups, building them if they are not cached.
+     * @remarks Threads missing the same combination at once may each build it, with the first stored being kept.
+     * @param body The body value.
+     * @param skinFamily Row of the skin lookup table to resolve materials with.
+     * @param lod The level of detail.
+     * @return The shared draw batches.
+     * @throws Errors::OutOfBoundsAccess as buildDrawBatches.
+     */
+    [[nodiscard]] std::shared_ptr<const DrawBatches> get(int32_t body, size_t skinFamily = 0, size_t lod = 0);
+
+    /**
+     * Gets the number of cached combinations.
+     */
+    [[nodiscard]] size_t getCombinationCount() const;
+
+    [[nodiscard]] const ModelTriple& getModel() const;
+
+  private:
+    struct Key {
+      /**
+       * The normalised body value.
+       */
+      int32_t body;
+
+      size_t skinFamily;
+      size_t lod;
+
+      bool operator==(const Key&) const = default;
+    };
+
+    struct KeyHash {
+      size_t operator()(const Key& key) const;
+    };
+
+    std::shared_ptr<const ModelTriple> model;
+
+    mutable std::mutex mutex;
+    std::unordered_map<Key, std::shared_ptr<const DrawBatches>, KeyHash> combinations;
+  };
+}
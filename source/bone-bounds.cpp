@@ -0,0 +1,222 @@
+#include "bone-bounds.hpp"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include "errors.hpp"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define MDLPARSER_BONE_BOUNDS_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace MdlParser {
+  namespace {
+    constexpr auto INF = std::numeric_limits<float>::infinity();
+
+    Structs::Vector transformPoint(const Structs::Matrix3x4& matrix, const Structs::Vector& point) {
+      return {
+        matrix[0][0] * point.x + matrix[0][1] * point.y + matrix[0][2] * point.z + matrix[0][3],
+        matrix[1][0] * point.x + matrix[1][1] * point.y + matrix[1][2] * point.z + matrix[1][3],
+        matrix[2][0] * point.x + matrix[2][1] * point.y + matrix[2][2] * point.z + matrix[2][3],
+      };
+    }
+
+    /**
+     * Bounds of a set of points with no points in, which any point expands.
+     */
+    struct Extremes {
+      std::array<float, 3> min{INF, INF, INF};
+      std::array<float, 3> max{-INF, -INF, -INF};
+
+      void add(const Structs::Vector& point) {
+        min = {std::min(min[0], point.x), std::min(min[1], point.y), std::min(min[2], point.z)};
+        max = {std::max(max[0], point.x), std::max(max[1], point.y), std::max(max[2], point.z)};
+      }
+
+      [[nodiscard]] bool isEmpty() const {
+        return min[0] > max[0];
+      }
+    };
+
+    /**
+     * Expands the extremes by a bone's bounds transformed by its bone to world matrix, using the transformed centre and
+     * the extent projected onto each axis.
+     */
+    void addTransformedBounds(
+      Extremes& extremes, const BoneBounds& boneBounds, const size_t index, const Structs::Matrix3x4& matrix
+    ) {
+      const std::array<float, 3> centre{
+        boneBounds.centreX[index], boneBounds.centreY[index], boneBounds.centreZ[index]
+      };
+      const std::array<float, 3> extent{
+        boneBounds.extentX[index], boneBounds.extentY[index], boneBounds.extentZ[index]
+      };
+
+      for (int row = 0; row < 3; row++) {
+        const auto transformedCentre =
+          matrix[row][0] * centre[0] + matrix[row][1] * centre[1] + matrix[row][2] * centre[2] + matrix[row][3];
+        const auto transformedExtent = std::abs(matrix[row][0]) * extent[0] + std::abs(matrix[row][1]) * extent[1] +
+          std::abs(matrix[row][2]) * extent[2];
+
+        extremes.min[row] = std::min(extremes.min[row], transformedCentre - transformedExtent);
+        extremes.max[row] = std::max(extremes.max[row], transformedCentre + transformedExtent);
+      }
+    }
+
+#ifdef MDLPARSER_BONE_BOUNDS_SSE2
+    /**
+     * Extremes of each axis, with each lane tracking a different subset of bones.
+     */
+    struct SimdExtremes {
+      __m128 min[3];
+      __m128 max[3];
+    };
+
+    /**
+     * Expands the extremes by the transformed bounds of bones [first, first + 4), with each SSE lane handling one bone.
+     */
+    void addTransformedBounds4(
+      SimdExtremes& extremes,
+      const BoneBounds& boneBounds,
+      const size_t first,
+      const std::span<const Structs::Matrix3x4> boneToWorld
+    ) {
+      const auto centreX = _mm_loadu_ps(&boneBounds.centreX[first]);
+      const auto centreY = _mm_loadu_ps(&boneBounds.centreY[first]);
+      const auto centreZ = _mm_loadu_ps(&boneBounds.centreZ[first]);
+      const auto extentX = _mm_loadu_ps(&boneBounds.extentX[first]);
+      const auto extentY = _mm_loadu_ps(&boneBounds.extentY[first]);
+      const auto extentZ = _mm_loadu_ps(&boneBounds.extentZ[first]);
+      const auto absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+
+      const auto& matrix0 = boneToWorld[boneBounds.bones[first]];
+      const auto& matrix1 = boneToWorld[boneBounds.bones[first + 1]];
+      const auto& matrix2 = boneToWorld[boneBounds.bones[first + 2]];
+      const auto& matrix3 = boneToWorld[boneBounds.bones[first + 3]];
+
+      for (int row = 0; row < 3; row++) {
+        // Transposing the same row of four matrices gives each of its columns across the four bones
+        auto column0 = _mm_loadu_ps(matrix0[row].data());
+        auto column1 = _mm_loadu_ps(matrix1[row].data());
+        auto column2 = _mm_loadu_ps(matrix2[row].data());
+        auto column3 = _mm_loadu_ps(matrix3[row].data());
+        _MM_TRANSPOSE4_PS(column0, column1, column2, column3);
+
+        const auto centre = _mm_add_ps(
+          _mm_add_ps(_mm_mul_ps(column0, centreX), _mm_mul_ps(column1, centreY)),
+          _mm_add_ps(_mm_mul_ps(column2, centreZ), column3)
+        );
+        const auto extent = _mm_add_ps(
+          _mm_add_ps(
+            _mm_mul_ps(_mm_and_ps(column0, absMask), extentX), _mm_mul_ps(_mm_and_ps(column1, absMask), extentY)
+          ),
+          _mm_mul_ps(_mm_and_ps(column2, absMask), extentZ)
+        );
+
+        extremes.min[row] = _mm_min_ps(extremes.min[row], _mm_sub_ps(centre, extent));
+        extremes.max[row] = _mm_max_ps(extremes.max[row], _mm_add_ps(centre, extent));
+      }
+    }
+#endif
+  }
+
+  Aabb BoneBounds::getBoneSpaceBounds(const size_t index) const {
+    return {
+      .min = {centreX[index] - extentX[index], centreY[index] - extentY[index], centreZ[index] - extentZ[index]},
+      .max = {centreX[index] + extentX[index], centreY[index] + extentY[index], centreZ[index] + extentZ[index]},
+    };
+  }
+
+  BoneBounds buildBoneBounds(const Mdl& mdl, const Vvd& vvd) {
+    const auto& bones = mdl.getBones();
+    std::vector<Extremes> extremes(bones.size());
+
+    for (const auto& vertex : vvd.getVertices()) {
+      const Structs::Vvd::BoneWeight boneWeights = vertex.boneWeights;
+      const Structs::Vector position = vertex.pos;
+      const auto influences = std::min<size_t>(boneWeights.numBones, boneWeights.bone.size());
+
+      for (size_t influence = 0; influence < influences; influence++) {
+        if (!(boneWeights.weight[influence] > 0.0f)) {
+          continue;
+        }
+
+        const auto bone = static_cast<uint8_t>(boneWeights.bone[influence]);
+        if (bone >= bones.size()) {
+          throw Errors::OutOfBoundsAccess("Vertex is weighted to a bone outside the MDL");
+        }
+
+        const Structs::Matrix3x4 poseToBone = bones[bone].poseToBone;
+        extremes[bone].add(transformPoint(poseToBone, position));
+      }
+    }
+
+    BoneBounds boneBounds;
+    for (size_t bone = 0; bone < extremes.size(); bone++) {
+      const auto& [min, max] = extremes[bone];
+      if (extremes[bone].isEmpty()) {
+        continue;
+      }
+
+      boneBounds.bones.push_back(static_cast<int32_t>(bone));
+      boneBounds.centreX.push_back((min[0] + max[0]) * 0.5f);
+      boneBounds.centreY.push_back((min[1] + max[1]) * 0.5f);
+      boneBounds.centreZ.push_back((min[2] + max[2]) * 0.5f);
+      boneBounds.extentX.push_back((max[0] - min[0]) * 0.5f);
+      boneBounds.extentY.push_back((max[1] - min[1]) * 0.5f);
+      boneBounds.extentZ.push_back((max[2] - min[2]) * 0.5f);
+    }
+
+    return boneBounds;
+  }
+
+  std::optional<Aabb> getSkinnedBounds(
+    const BoneBounds& boneBounds,
+    const std::span<const Structs::Matrix3x4> boneToWorld
+  ) {
+    const auto count = boneBounds.bones.size();
+    if (count == 0) {
+      return std::nullopt;
+    }
+
+    // Bones are in ascending order, so only the first and last need checking
+    if (boneBounds.bones.front() < 0 || static_cast<size_t>(boneBounds.bones.back()) >= boneToWorld.size()) {
+      throw Errors::OutOfBoundsAccess("Bone is outside bone transforms");
+    }
+
+    Extremes extremes;
+    size_t index = 0;
+
+#ifdef MDLPARSER_BONE_BOUNDS_SSE2
+    if (count >= 4) {
+      const auto inf = _mm_set1_ps(INF);
+      const auto negativeInf = _mm_set1_ps(-INF);
+      SimdExtremes simdExtremes{.min = {inf, inf, inf}, .max = {negativeInf, negativeInf, negativeInf}};
+
+      for (; index + 4 <= count; index += 4) {
+        addTransformedBounds4(simdExtremes, boneBounds, index, boneToWorld);
+      }
+
+      for (int axis = 0; axis < 3; axis++) {
+        alignas(16) std::array<float, 4> minimum{};
+        alignas(16) std::array<float, 4> maximum{};
+        _mm_store_ps(minimum.data(), simdExtremes.min[axis]);
+        _mm_store_ps(maximum.data(), simdExtremes.max[axis]);
+
+        extremes.min[axis] = *std::ranges::min_element(minimum);
+        extremes.max[axis] = *std::ranges::max_element(maximum);
+      }
+    }
+#endif
+
+    for (; index < count; index++) {
+      addTransformedBounds(extremes, boneBounds, index, boneToWorld[boneBounds.bones[index]]);
+    }
+
+    return Aabb{
+      .min = {extremes.min[0], extremes.min[1], extremes.min[2]},
+      .max = {extremes.max[0], extremes.max[1], extremes.max[2]},
+    };
+  }
+}
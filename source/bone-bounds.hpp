@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <vector>
+#include "mdl.hpp"
+#include "structs/common.hpp"
+#include "vvd.hpp"
+
+namespace MdlParser {
+  /**
+   * An axis aligned bounding box.
+   */
+  struct Aabb {
+    Structs::Vector min;
+    Structs::Vector max;
+  };
+
+  /**
+   * The bone space bounds of the vertices influenced by each bone of a model, used to bound the skinned model from its
+   * bone transforms alone.
+   */
+  struct BoneBounds {
+    /**
+     * Index in the MDL of each bone influencing at least one vertex, in ascending order.
+     */
+    std::vector<int32_t> bones;
+
+    /**
+     * Centre of each bone's bounds, one entry per entry in bones.
+     * Components are stored in separate arrays so that several bones can be transformed at once.
+     */
+    std::vector<float> centreX, centreY, centreZ;
+
+    /**
+     * Half the size of each bone's bounds, one entry per entry in bones.
+     */
+    std::vector<float> extentX, extentY, extentZ;
+
+    /**
+     * Gets the bounds of a bone in its own space.
+     * @param index Index into bones.
+     */
+    [[nodiscard]] Aabb getBoneSpaceBounds(size_t index) const;
+  };
+
+  /**
+   * Computes the bounds of the vertices each bone influences, in that bone's space (as given by its poseToBone).
+   * Vertices are only counted towards bones they have a non-zero weight for.
+   * @param mdl The model the vertices belong to.
+   * @param vvd The model's vertices.
+   * @return The bounds of every bone influencing at least one vertex.
+   * @throws Errors::OutOfBoundsAccess if a vertex is weighted to a bone outside the MDL.
+   */
+  [[nodiscard]] BoneBounds buildBoneBounds(const Mdl& mdl, const Vvd& vvd);
+
+  /**
+   * Computes bounds containing every vertex of a model skinned with the given bone transforms, in O(bones) rather than
+   * O(vertices). Transforms four bones at a time with SSE where available.
+   * @remarks The bounds are conservative: as each skinned vertex is a weighted average of its position transformed by
+   * each bone, it lies within the union of the transformed bounds of the bones influencing it, though this may be
+   * noticeably larger than the tightest bounds when bones are rotated far from their bind pose.
+   * @param boneBounds Bounds built by buildBoneBounds.
+   * @param boneToWorld The current world transform of each of the model's bones.
+   * @return The bounds, or nothing if no bone influences any vertex.
+   * @throws Errors::OutOfBoundsAccess if a bone in boneBounds is outside boneToWorld.
+   */
+  [[nodiscard]] std::optional<Aabb> getSkinnedBounds(
+    const BoneBounds& boneBounds,
+    std::span<const Structs::Matrix3x4> boneToWorld
+  );
+}
@@ -0,0 +1,202 @@
+#include "bone-name-index.hpp"
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include "helpers/heap-size.hpp"
+#include "helpers/name-hash.hpp"
+
+namespace MdlParser {
+  using namespace Errors;
+
+  namespace {
+    constexpr uint32_t FILE_ID = 'B' + ('N' << 8) + ('I' << 16) + ('X' << 24);
+    // Bumped whenever getSlot() changes, as indices written by older versions would place names in the wrong slots
+    constexpr uint32_t VERSION = 2;
+    constexpr size_t HEADER_SIZE = sizeof(uint32_t) * 3;
+
+    // Far more than is ever needed in practice, only here so that pathological input cannot loop forever
+    constexpr int32_t MAX_SEED = 1 << 20;
+
+    /**
+     * Finalizer from MurmurHash3, so every bit of the result depends on every bit of the input.
+     */
+    uint32_t mixHash(uint32_t hash) {
+      hash ^= hash >> 16;
+      hash *= 0x85ebca6b;
+      hash ^= hash >> 13;
+      hash *= 0xc2b2ae35;
+      hash ^= hash >> 16;
+      return hash;
+    }
+
+    size_t getSlot(const std::string_view name, const uint32_t seed, const size_t slotCount) {
+      // FNV-1a's low bits only depend on the low bits of its seed, so with a power of two slot count every seed would
+      // place names into the same slots unless the hash is mixed first
+      return mixHash(getNameHash(name, seed) ^ (seed * 0x9e3779b9)) % slotCount;
+    }
+  }
+
+  Expected<BoneNameIndex> BoneNameIndex::build(const std::span<const std::string_view> names) {
+    BoneNameIndex index;
+    const auto slotCount = names.size();
+    if (slotCount == 0) {
+      return std::move(index);
+    }
+
+    std::vector<std::vector<int32_t>> buckets(slotCount);
+    for (size_t bone = 0; bone < names.size(); bone++) {
+      auto& bucket = buckets[getNameHash(names[bone]) % slotCount];
+
+      // Repeated names always share a bucket and could never be placed into distinct slots, so only keep the first
+      const auto isRepeated = std::ranges::any_of(bucket, [&](const int32_t key) {
+        return isNameEqual(names[key], names[bone]);
+      });
+      if (!isRepeated) {
+        bucket.push_back(static_cast<int32_t>(bone));
+      }
+    }
+
+    std::vector<size_t> bucketOrder(slotCount);
+    for (size_t bucket = 0; bucket < slotCount; bucket++) {
+      bucketOrder[bucket] = bucket;
+    }
+
+    // Place the largest buckets first, while most slots are still free
+    std::ranges::stable_sort(bucketOrder, [&](const size_t a, const size_t b) {
+      return buckets[a].size() > buckets[b].size();
+    });
+
+    index.displacements.assign(slotCount, 0);
+    index.bones.assign(slotCount, -1);
+
+    std::vector<size_t> bucketSlots;
+    size_t nextFreeSlot = 0;
+
+    for (const auto bucket : bucketOrder) {
+      const auto& bucketKeys = buckets[bucket];
+      if (bucketKeys.empty()) {
+        break;
+      }
+
+      if (bucketKeys.size() == 1) {
+        while (index.bones[nextFreeSlot] != -1) {
+          nextFreeSlot++;
+        }
+
+        index.displacements[bucket] = -1 - static_cast<int32_t>(nextFreeSlot);
+        index.bones[nextFreeSlot] = bucketKeys.front();
+        continue;
+      }
+
+      int32_t seed = 1;
+      for (; seed < MAX_SEED; seed++) {
+        bucketSlots.clear();
+
+        const auto isPlaced = std::ranges::all_of(bucketKeys, [&](const int32_t key) {
+          const auto slot = getSlot(names[key], seed, slotCount);
+          if (index.bones[slot] != -1 || std::ranges::find(bucketSlots, slot) != bucketSlots.end()) {
+            return false;
+          }
+
+          bucketSlots.push_back(slot);
+          return true;
+        });
+        if (isPlaced) {
+          break;
+        }
+      }
+
+      if (seed == MAX_SEED) {
+        return makeError(Reason::InvalidBody, 0, "Failed to find a perfect hash for MDL bone names");
+      }
+
+      index.displacements[bucket] = seed;
+      for (size_t i = 0; i < bucketKeys.size(); i++) {
+        index.bones[bucketSlots[i]] = bucketKeys[i];
+      }
+    }
+
+    return std::move(index);
+  }
+
+  BoneNameIndex BoneNameIndex::deserialize(const std::span<const std::byte> data, const size_t boneCount) {
+    return valueOrThrow(tryDeserialize(data, boneCount));
+  }
+
+  Expected<BoneNameIndex> BoneNameIndex::tryDeserialize(const std::span<const std::byte> data, const size_t boneCount) {
+    std::array<uint32_t, 3> header;
+    if (data.size() < HEADER_SIZE) {
+      return makeError(Reason::InvalidHeader, 0, "Bone name index is too small for its header");
+    }
+    std::memcpy(header.data(), data.data(), HEADER_SIZE);
+
+    const auto [fileId, version, slotCount] = header;
+    if (fileId != FILE_ID || version != VERSION) {
+      return makeError(Reason::InvalidHeader, 0, "Bone name index header does not match");
+    }
+    if (slotCount != boneCount || data.size() != HEADER_SIZE + sizeof(int32_t) * 2 * slotCount) {
+      return makeError(Reason::InvalidBody, HEADER_SIZE, "Bone name index size does not match its bone count");
+    }
+
+    BoneNameIndex index;
+    index.displacements.resize(slotCount);
+    index.bones.resize(slotCount);
+
+    if (slotCount > 0) {
+      const auto* body = data.data() + HEADER_SIZE;
+      std::memcpy(index.displacements.data(), body, sizeof(int32_t) * slotCount);
+      std::memcpy(index.bones.data(), body + sizeof(int32_t) * slotCount, sizeof(int32_t) * slotCount);
+    }
+
+    // Validated so that lookups into untrusted cached indices can never go out of bounds
+    for (const auto displacement : index.displacements) {
+      if (displacement < 0 && static_cast<size_t>(-1 - static_cast<int64_t>(displacement)) >= slotCount) {
+        return makeError(Reason::OutOfBoundsAccess, HEADER_SIZE, "Bone name index slot is out of range");
+      }
+    }
+    for (const auto bone : index.bones) {
+      if (bone < -1 || bone >= static_cast<int64_t>(boneCount)) {
+        return makeError(Reason::OutOfBoundsAccess, HEADER_SIZE, "Bone name index bone is out of range");
+      }
+    }
+
+    return std::move(index);
+  }
+
+  std::vector<std::byte> BoneNameIndex::serialize() const {
+    const auto slotCount = static_cast<uint32_t>(bones.size());
+    const std::array<uint32_t, 3> header = {FILE_ID, VERSION, slotCount};
+
+    std::vector<std::byte> data(HEADER_SIZE + sizeof(int32_t) * 2 * slotCount);
+    std::memcpy(data.data(), header.data(), HEADER_SIZE);
+
+    // Skipped for empty indices, as memcpy must not be given their null data pointers
+    if (slotCount > 0) {
+      std::memcpy(data.data() + HEADER_SIZE, displacements.data(), sizeof(int32_t) * slotCount);
+      std::memcpy(data.data() + HEADER_SIZE + sizeof(int32_t) * slotCount, bones.data(), sizeof(int32_t) * slotCount);
+    }
+
+    return data;
+  }
+
+  std::optional<size_t> BoneNameIndex::findCandidate(const std::string_view name) const {
+    if (bones.empty()) {
+      return std::nullopt;
+    }
+
+    const auto displacement = displacements[getNameHash(name) % displacements.size()];
+    const auto slot = displacement < 0
+      ? static_cast<size_t>(-1 - displacement)
+      : getSlot(name, static_cast<uint32_t>(displacement), bones.size());
+
+    if (bones[slot] == -1) {
+      return std::nullopt;
+    }
+
+    return bones[slot];
+  }
+
+  size_t BoneNameIndex::getHeapSize() const {
+    return MdlParser::getHeapSize(displacements) + MdlParser::getHeapSize(bones);
+  }
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string_view>
+#include <vector>
+#include "errors.hpp"
+
+namespace MdlParser {
+  /**
+   * A minimal perfect hash from bone names (ignoring case, as the engine does) to bone indices.
+   *
+   * Built with hash and displace: names are split into buckets by one hash, then each bucket is given a seed for a
+   * second hash (or a direct slot) which places all of its names into free slots. Lookups take two hashes and a single
+   * name comparison, without allocating.
+   */
+  class BoneNameIndex {
+  public:
+    BoneNameIndex() = default;
+
+    /**
+     * Builds the index for a set of bone names. Where names are repeated, the first bone with that name is used.
+     * @remarks There is one slot per bone, so the hash is minimal as long as every name is unique.
+     * @param names The name of each bone, in bone order.
+     * @return The index, or an error if no perfect hash could be found (which should never happen in practice).
+     */
+    [[nodiscard]] static Errors::Expected<BoneNameIndex> build(std::span<const std::string_view> names);
+
+    /**
+     * Loads an index previously written by serialize(), without rebuilding it.
+     * @param data
+     * @param boneCount The number of bones in the model the index was built for.
+     * @throws Errors::InvalidBody if the data is not a valid index for that many bones.
+     */
+    [[nodiscard]] static BoneNameIndex deserialize(std::span<const std::byte> data, size_t boneCount);
+
+    /**
+     * Loads an index in the same way as deserialize(), but returns any error instead of throwing it.
+     */
+    [[nodiscard]] static Errors::Expected<BoneNameIndex> tryDeserialize(
+      std::span<const std::byte> data,
+      size_t boneCount
+    );
+
+    /**
+     * Writes the index out so it can be stored alongside a cached model and loaded with deserialize().
+     * @return The serialized index.
+     */
+    [[nodiscard]] std::vector<std::byte> serialize() const;
+
+    /**
+     * Finds the only bone which could have the given name.
+     * @remarks Names which are not in the index still map to a bone, so the caller must compare the bone's name.
+     * @param name
+     * @return Index of the candidate bone, or nullopt if no bone can have the name.
+     */
+    [[nodiscard]] std::optional<size_t> findCandidate(std::string_view name) const;
+
+    /**
+     * Gets the number of bytes the index has allocated on the heap.
+     */
+    [[nodiscard]] size_t getHeapSize() const;
+
+  private:
+    /**
+     * For each bucket, either the seed of the hash placing its names (if positive), or -1 - the slot of its only name.
+     */
+    std::vector<int32_t> displacements;
+
+    /**
+     * The bone index in each slot, or -1 for slots left empty by repeated names.
+     */
+    std::vector<int32_t> bones;
+  };
+}
@@ -0,0 +1,195 @@
+#include "bone-palette.hpp"
+#include <algorithm>
+#include <array>
+#include <iterator>
+#include <limits>
+#include "errors.hpp"
+
+namespace MdlParser {
+  namespace {
+    // Vertex bone ids are signed 8 bit, so no palette can have more slots than this
+    constexpr size_t MAX_PALETTE_SLOTS = std::numeric_limits<int8_t>::max() + 1;
+    constexpr auto unassigned = std::numeric_limits<size_t>::max();
+
+    /**
+     * The bones of every strip and vertex in a strip group, with the hardware palette slots resolved to MDL bones.
+     */
+    struct ResolvedBones {
+      /**
+       * The sorted unique bones referenced by each strip.
+       */
+      std::vector<std::vector<int32_t>> stripBones;
+
+      /**
+       * The bone referenced by each of a vertex's bone ids.
+       */
+      std::vector<std::array<int32_t, 3>> vertexBones;
+    };
+
+    ResolvedBones resolveBones(const Vtx::StripGroup& stripGroup) {
+      std::array<int32_t, MAX_PALETTE_SLOTS> slots;
+      slots.fill(-1);
+
+      ResolvedBones resolved{
+        .vertexBones = std::vector<std::array<int32_t, 3>>(stripGroup.vertices.size(), {-1, -1, -1}),
+      };
+      resolved.stripBones.reserve(stripGroup.strips.size());
+
+      std::vector<bool> isVertexResolved(stripGroup.vertices.size(), false);
+
+      // The hardware palette is not reset between strips, so changes accumulate over the whole strip group
+      for (const auto& strip : stripGroup.strips) {
+        for (const auto& change : strip.boneStateChanges) {
+          if (change.hardwareId < 0 || static_cast<size_t>(change.hardwareId) >= slots.size()) {
+            throw Errors::OutOfBoundsAccess("VTX bone state change is outside the hardware palette");
+          }
+
+          slots[change.hardwareId] = change.boneId;
+        }
+
+        auto& bones = resolved.stripBones.emplace_back();
+        const auto verticesEnd = static_cast<size_t>(strip.verticesOffset) + strip.verticesCount;
+
+        for (auto vertexIndex = static_cast<size_t>(strip.verticesOffset); vertexIndex < verticesEnd; vertexIndex++) {
+          const auto& vertex = stripGroup.vertices[vertexIndex];
+          std::array<int32_t, 3> vertexBones = {-1, -1, -1};
+
+          for (size_t i = 0; i < std::min<size_t>(vertex.numBones, vertex.boneId.size()); i++) {
+            const auto slot = vertex.boneId[i];
+            if (slot < 0 || slots[slot] < 0) {
+              throw Errors::OutOfBoundsAccess("VTX vertex references an empty hardware palette slot");
+            }
+
+            vertexBones[i] = slots[slot];
+            bones.push_back(slots[slot]);
+          }
+
+          if (isVertexResolved[vertexIndex] && resolved.vertexBones[vertexIndex] != vertexBones) {
+            throw Errors::InvalidBody("VTX vertex is shared by strips with different bones loaded");
+          }
+
+          resolved.vertexBones[vertexIndex] = vertexBones;
+          isVertexResolved[vertexIndex] = true;
+        }
+
+        std::ranges::sort(bones);
+        bones.erase(std::unique(bones.begin(), bones.end()), bones.end());
+      }
+
+      return resolved;
+    }
+
+    BonePalettes remapVertices(
+      const Vtx::StripGroup& stripGroup,
+      const ResolvedBones& resolved,
+      std::vector<BonePalettes::Palette>&& palettes
+    ) {
+      BonePalettes remapped{ .palettes = std::move(palettes), .vertices = stripGroup.vertices };
+      std::vector<size_t> vertexPalettes(stripGroup.vertices.size(), unassigned);
+
+      for (size_t paletteIndex = 0; paletteIndex < remapped.palettes.size(); paletteIndex++) {
+        const auto& palette = remapped.palettes[paletteIndex];
+
+        for (const auto stripIndex : palette.strips) {
+          const auto& strip = stripGroup.strips[stripIndex];
+          const auto verticesEnd = static_cast<size_t>(strip.verticesOffset) + strip.verticesCount;
+
+          for (auto vertexIndex = static_cast<size_t>(strip.verticesOffset); vertexIndex < verticesEnd; vertexIndex++) {
+            auto& vertexPalette = vertexPalettes[vertexIndex];
+            if (vertexPalette == paletteIndex) {
+              continue;
+            }
+
+            // A vertex shared with a strip in another palette must have its bones in the same slots of both
+            const auto isShared = vertexPalette != unassigned;
+            vertexPalette = paletteIndex;
+
+            auto& vertex = remapped.vertices[vertexIndex];
+            for (size_t i = 0; i < std::min<size_t>(vertex.numBones, vertex.boneId.size()); i++) {
+              // Palettes are sorted, so the slot is found by binary search
+              const auto slot = std::ranges::lower_bound(palette.bones, resolved.vertexBones[vertexIndex][i]);
+              const auto boneId = static_cast<int8_t>(std::distance(palette.bones.begin(), slot));
+
+              if (isShared && vertex.boneId[i] != boneId) {
+                throw Errors::InvalidBody("VTX vertex is shared by strips with its bones in different palette slots");
+              }
+              vertex.boneId[i] = boneId;
+            }
+          }
+        }
+      }
+
+      return remapped;
+    }
+  }
+
+  BonePalettes buildBonePalettes(const Vtx::StripGroup& stripGroup) {
+    auto resolved = resolveBones(stripGroup);
+
+    std::vector<BonePalettes::Palette> palettes;
+    palettes.reserve(stripGroup.strips.size());
+
+    for (size_t stripIndex = 0; stripIndex < stripGroup.strips.size(); stripIndex++) {
+      palettes.push_back({ .bones = resolved.stripBones[stripIndex], .strips = { stripIndex } });
+    }
+
+    return remapVertices(stripGroup, resolved, std::move(palettes));
+  }
+
+  BonePalettes mergeBonePalettes(const Vtx::StripGroup& stripGroup, size_t maxBones) {
+    maxBones = std::min(maxBones, MAX_PALETTE_SLOTS);
+    auto resolved = resolveBones(stripGroup);
+
+    std::vector<size_t> stripOrder(stripGroup.strips.size());
+    for (size_t stripIndex = 0; stripIndex < stripOrder.size(); stripIndex++) {
+      stripOrder[stripIndex] = stripIndex;
+    }
+
+    std::ranges::stable_sort(stripOrder, [&](const size_t a, const size_t b) {
+      return resolved.stripBones[a].size() > resolved.stripBones[b].size();
+    });
+
+    std::vector<BonePalettes::Palette> palettes;
+    std::vector<int32_t> merged;
+
+    for (const auto stripIndex : stripOrder) {
+      const auto& bones = resolved.stripBones[stripIndex];
+      if (bones.size() > maxBones) {
+        throw Errors::InvalidBody("VTX strip uses more bones than the palette limit");
+      }
+
+      auto bestPalette = unassigned;
+      auto bestGrowth = std::numeric_limits<size_t>::max();
+
+      for (size_t paletteIndex = 0; paletteIndex < palettes.size(); paletteIndex++) {
+        const auto& paletteBones = palettes[paletteIndex].bones;
+
+        merged.clear();
+        std::ranges::set_union(paletteBones, bones, std::back_inserter(merged));
+
+        const auto growth = merged.size() - paletteBones.size();
+        if (merged.size() <= maxBones && growth < bestGrowth) {
+          bestPalette = paletteIndex;
+          bestGrowth = growth;
+        }
+      }
+
+      if (bestPalette == unassigned) {
+        palettes.push_back({ .bones = bones, .strips = { stripIndex } });
+        continue;
+      }
+
+      auto& palette = palettes[bestPalette];
+      merged.clear();
+      std::ranges::set_union(palette.bones, bones, std::back_inserter(merged));
+      palette.bones.swap(merged);
+      palette.strips.push_back(stripIndex);
+    }
+
+    for (auto& palette : palettes) {
+      std::ranges::sort(palette.strips);
+    }
+
+    return remapVertices(stripGroup, resolved, std::move(palettes));
+  }
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "structs/vtx.hpp"
+#include "vtx.hpp"
+
+namespace MdlParser {
+  /**
+   * The bone palettes used to skin a strip group, each being the set of bones loaded for a single skinning dispatch.
+   */
+  struct BonePalettes {
+    struct Palette {
+      /**
+       * The index of the bone in the MDL for each slot of the palette.
+       */
+      std::vector<int32_t> bones;
+
+      /**
+       * Indices of the strip group's strips to draw with this palette, in their original order.
+       */
+      std::vector<size_t> strips;
+    };
+
+    std::vector<Palette> palettes;
+
+    /**
+     * The strip group's vertices, with each boneId remapped to a slot in the palette of the strip using it.
+     */
+    std::vector<Structs::Vtx::Vertex> vertices;
+  };
+
+  /**
+   * Resolves the bone state changes of a strip group into one compact palette per strip,
+   * containing only the bones that the strip's vertices actually reference.
+   * @param stripGroup Strip group in the VTX data.
+   * @return The palettes and remapped vertices.
+   * @throws Errors::OutOfBoundsAccess if a vertex references a palette slot no bone has been loaded into.
+   * @throws Errors::InvalidBody if a vertex is shared by strips resolving it to different bones, or by strips whose
+   * palettes put its bones in different slots (as happens when the strips use different sets of bones).
+   */
+  [[nodiscard]] BonePalettes buildBonePalettes(const Vtx::StripGroup& stripGroup);
+
+  /**
+   * Resolves the bone state changes of a strip group in the same way as buildBonePalettes, then merges the strips
+   * into as few palettes as possible of at most maxBones bones each, so fewer skinning dispatches are needed.
+   * @remarks Merging is greedy (largest strips first, into the palette which grows the least) so is not always optimal.
+   * As vertex bone ids are 8 bit, maxBones is capped at 128.
+   * @param stripGroup Strip group in the VTX data.
+   * @param maxBones The maximum number of bones in a palette.
+   * @return The palettes and remapped vertices.
+   * @throws Errors::OutOfBoundsAccess if a vertex references a palette slot no bone has been loaded into.
+   * @throws Errors::InvalidBody if a strip on its own uses more than maxBones bones, a vertex is shared by strips
+   * resolving it to different bones, or a vertex is shared by strips placed in palettes which put its bones in
+   * different slots.
+   */
+  [[nodiscard]] BonePalettes mergeBonePalettes(const Vtx::StripGroup& stripGroup, size_t maxBones);
+}
@@ -0,0 +1,193 @@
+#include "dedup-store.hpp"
+#include <array>
+#include <cstring>
+#include <mutex>
+#include <unordered_map>
+#include "accessors.hpp"
+#include "errors.hpp"
+#include "helpers/content-hash.hpp"
+
+namespace MdlParser {
+  namespace {
+    template <typename T>
+    std::span<const T> getRange(const std::vector<T>& data, const int32_t offset, const int32_t count) {
+      if (offset < 0 || count < 0 || static_cast<size_t>(offset) + count > data.size()) {
+        throw Errors::OutOfBoundsAccess("Model accesses outside VVD vertex data");
+      }
+
+      return std::span(data).subspan(offset, count);
+    }
+  }
+
+  /**
+   * Buffers of one element type, split into independently locked shards by hash to reduce contention.
+   */
+  template <typename T>
+  class DedupStore::Pool {
+  public:
+    static constexpr size_t SHARD_COUNT = 16;
+
+    /**
+     * Finds a live buffer equal to data, removing any expired entries with the same hash along the way.
+     */
+    Buffer<T> find(const uint64_t hash, const std::span<const T> data) {
+      auto& shard = getShard(hash);
+      std::scoped_lock lock(shard.mutex);
+      return findLocked(shard, hash, data);
+    }
+
+    /**
+     * Inserts a newly allocated buffer, unless an equal one was inserted by another thread since find() was called.
+     * @return The buffer now held by the pool, and whether it was the one passed in.
+     */
+    std::pair<Buffer<T>, bool> insert(const uint64_t hash, Buffer<T> buffer) {
+      auto& shard = getShard(hash);
+      std::scoped_lock lock(shard.mutex);
+
+      if (auto existing = findLocked(shard, hash, *buffer)) {
+        return {std::move(existing), false};
+      }
+
+      shard.buffers.emplace(hash, buffer);
+      return {std::move(buffer), true};
+    }
+
+    void purge() {
+      for (auto& shard : shards) {
+        std::scoped_lock lock(shard.mutex);
+        std::erase_if(shard.buffers, [](const auto& entry) { return entry.second.expired(); });
+      }
+    }
+
+  private:
+    struct Shard {
+      std::mutex mutex;
+      std::unordered_multimap<uint64_t, std::weak_ptr<const std::vector<T>>> buffers;
+    };
+
+    std::array<Shard, SHARD_COUNT> shards;
+
+    Shard& getShard(const uint64_t hash) {
+      // The low bits pick the bucket within the shard's map, so use the high bits to pick the shard
+      return shards[(hash >> 60) % SHARD_COUNT];
+    }
+
+    static Buffer<T> findLocked(Shard& shard, const uint64_t hash, const std::span<const T> data) {
+      auto [entry, end] = shard.buffers.equal_range(hash);
+
+      while (entry != end) {
+        auto buffer = entry->second.lock();
+        if (!buffer) {
+          entry = shard.buffers.erase(entry);
+          continue;
+        }
+
+        const auto isEqual = buffer->size() == data.size()
+          && (data.empty() || std::memcmp(buffer->data(), data.data(), data.size_bytes()) == 0);
+        if (isEqual) {
+          return buffer;
+        }
+
+        ++entry;
+      }
+
+      return nullptr;
+    }
+  };
+
+  DedupStore::DedupStore()
+    : vvdVertices(std::make_unique<Pool<Structs::Vvd::Vertex>>()),
+      tangents(std::make_unique<Pool<Structs::Vector4D>>()),
+      vtxVertices(std::make_unique<Pool<Structs::Vtx::Vertex>>()),
+      indices(std::make_unique<Pool<uint16_t>>()) {}
+
+  DedupStore::~DedupStore() = default;
+
+  DedupStore::Geometry DedupStore::add(const Mdl& mdl, const Vtx& vtx, const Vvd& vvd) {
+    Geometry geometry;
+
+    Accessors::iterateBodyParts(mdl, vtx, [&](const Mdl::BodyPart& mdlBodyPart, const Vtx::BodyPart& vtxBodyPart) {
+      auto& bodyPart = geometry.bodyParts.emplace_back();
+
+      Accessors::iterateModels(mdlBodyPart, vtxBodyPart, [&](const Mdl::Model& mdlModel, const Vtx::Model& vtxModel) {
+        auto& model = bodyPart.models.emplace_back(
+          Model{
+            .vertices = intern(getRange(vvd.getVertices(), mdlModel.vertexOffset, mdlModel.vertexCount)),
+            .tangents = intern(getRange(vvd.getTangents(), mdlModel.tangentsOffset, mdlModel.vertexCount)),
+          }
+        );
+
+        for (const auto& vtxLod : vtxModel.levelOfDetails) {
+          auto& lod = model.levelOfDetails.emplace_back();
+
+          for (const auto& vtxMesh : vtxLod.meshes) {
+            auto& mesh = lod.meshes.emplace_back();
+
+            for (const auto& vtxStripGroup : vtxMesh.stripGroups) {
+              mesh.stripGroups.push_back(
+                {
+                  .vertices = intern(std::span(vtxStripGroup.vertices)),
+                  .indices = intern(std::span(vtxStripGroup.indices)),
+                }
+              );
+            }
+          }
+        }
+      });
+    });
+
+    return geometry;
+  }
+
+  DedupStore::Buffer<Structs::Vvd::Vertex> DedupStore::intern(const std::span<const Structs::Vvd::Vertex> data) {
+    return intern(*vvdVertices, data);
+  }
+
+  DedupStore::Buffer<Structs::Vector4D> DedupStore::intern(const std::span<const Structs::Vector4D> data) {
+    return intern(*tangents, data);
+  }
+
+  DedupStore::Buffer<Structs::Vtx::Vertex> DedupStore::intern(const std::span<const Structs::Vtx::Vertex> data) {
+    return intern(*vtxVertices, data);
+  }
+
+  DedupStore::Buffer<uint16_t> DedupStore::intern(const std::span<const uint16_t> data) {
+    return intern(*indices, data);
+  }
+
+  DedupStore::Report DedupStore::getReport() const {
+    return {
+      .buffersRequested = buffersRequested.load(std::memory_order_relaxed),
+      .buffersStored = buffersStored.load(std::memory_order_relaxed),
+      .bytesRequested = bytesRequested.load(std::memory_order_relaxed),
+      .bytesStored = bytesStored.load(std::memory_order_relaxed),
+    };
+  }
+
+  void DedupStore::purge() {
+    vvdVertices->purge();
+    tangents->purge();
+    vtxVertices->purge();
+    indices->purge();
+  }
+
+  template <typename T>
+  DedupStore::Buffer<T> DedupStore::intern(Pool<T>& pool, const std::span<const T> data) {
+    const auto hash = getContentHash(std::as_bytes(data));
+    buffersRequested.fetch_add(1, std::memory_order_relaxed);
+    bytesRequested.fetch_add(data.size_bytes(), std::memory_order_relaxed);
+
+    if (auto existing = pool.find(hash, data)) {
+      return existing;
+    }
+
+    // Copy outside the lock so other threads hashing into the same shard are not held up
+    auto [buffer, inserted] = pool.insert(hash, std::make_shared<const std::vector<T>>(data.begin(), data.end()));
+    if (inserted) {
+      buffersStored.fetch_add(1, std::memory_order_relaxed);
+      bytesStored.fetch_add(data.size_bytes(), std::memory_order_relaxed);
+    }
+
+    return std::move(buffer);
+  }
+}
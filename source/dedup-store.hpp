@@ -0,0 +1,158 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <vector>
+#include "mdl.hpp"
+#include "vtx.hpp"
+#include "vvd.hpp"
+
+namespace MdlParser {
+  /**
+   * Corpus-wide store of immutable geometry buffers, deduplicated by content.
+   *
+   * Models which differ only by material (recoloured props, skin variants compiled as separate MDLs, etc.) share
+   * identical vertex and index data. Adding each model to a single store makes every identical block reference the
+   * same buffer, so only one copy is kept in memory however many models use it.
+   *
+   * Buffers are matched by a 64-bit content hash and then compared byte for byte, so collisions never merge different
+   * data. The store only holds weak references, so buffers are freed once no model uses them.
+   *
+   * All functions are safe to call concurrently.
+   */
+  class DedupStore {
+  public:
+    template <typename T>
+    using Buffer = std::shared_ptr<const std::vector<T>>;
+
+    struct StripGroup {
+      Buffer<Structs::Vtx::Vertex> vertices;
+      Buffer<uint16_t> indices;
+    };
+
+    struct Mesh {
+      std::vector<StripGroup> stripGroups;
+    };
+
+    struct ModelLod {
+      std::vector<Mesh> meshes;
+    };
+
+    struct Model {
+      /**
+       * The model's block of VVD vertices, with any fixups already applied.
+       */
+      Buffer<Structs::Vvd::Vertex> vertices;
+
+      /**
+       * The model's block of VVD tangents.
+       */
+      Buffer<Structs::Vector4D> tangents;
+
+      std::vector<ModelLod> levelOfDetails;
+    };
+
+    struct BodyPart {
+      std::vector<Model> models;
+    };
+
+    /**
+     * The geometry of a single model, mirroring the structure of the VTX with each block of data in a shared buffer.
+     * Vertex indices are unchanged, so these can be used as drop-in replacements for the VTX and VVD data.
+     */
+    struct Geometry {
+      std::vector<BodyPart> bodyParts;
+    };
+
+    /**
+     * Running totals of the data added to the store since it was created.
+     */
+    struct Report {
+      /**
+       * Number of buffers requested through add() and intern().
+       */
+      size_t buffersRequested;
+
+      /**
+       * Number of those buffers which did not match an existing one and so were allocated.
+       */
+      size_t buffersStored;
+
+      /**
+       * Total size of the requested buffers in bytes.
+       */
+      size_t bytesRequested;
+
+      /**
+       * Total size of the allocated buffers in bytes.
+       */
+      size_t bytesStored;
+
+      /**
+       * Gets the number of bytes which would have been allocated without deduplication, but were not.
+       */
+      [[nodiscard]] size_t getBytesSaved() const {
+        return bytesRequested - bytesStored;
+      }
+    };
+
+    DedupStore();
+    ~DedupStore();
+    DedupStore(const DedupStore&) = delete;
+    DedupStore& operator=(const DedupStore&) = delete;
+    DedupStore(DedupStore&&) = delete;
+    DedupStore& operator=(DedupStore&&) = delete;
+
+    /**
+     * Adds the geometry of a model to the store, reusing existing buffers wherever the contents match.
+     * @param mdl
+     * @param vtx
+     * @param vvd
+     * @return The model's geometry in shared buffers.
+     * @throws Errors::OutOfBoundsAccess if the MDL, VTX and VVD do not describe the same geometry.
+     */
+    [[nodiscard]] Geometry add(const Mdl& mdl, const Vtx& vtx, const Vvd& vvd);
+
+    /**
+     * Gets a shared buffer with the given contents, allocating one only if no identical buffer is alive in the store.
+     * @param data
+     * @return Shared immutable buffer equal to data.
+     */
+    [[nodiscard]] Buffer<Structs::Vvd::Vertex> intern(std::span<const Structs::Vvd::Vertex> data);
+    [[nodiscard]] Buffer<Structs::Vector4D> intern(std::span<const Structs::Vector4D> data);
+    [[nodiscard]] Buffer<Structs::Vtx::Vertex> intern(std::span<const Structs::Vtx::Vertex> data);
+    [[nodiscard]] Buffer<uint16_t> intern(std::span<const uint16_t> data);
+
+    /**
+     * Gets the totals of the data added to the store.
+     * @return Report of the memory saved.
+     */
+    [[nodiscard]] Report getReport() const;
+
+    /**
+     * Removes entries for buffers which are no longer used by any model.
+     * This happens gradually as new buffers are added, so is only needed to reclaim memory immediately.
+     */
+    void purge();
+
+  private:
+    template <typename T>
+    class Pool;
+
+    std::unique_ptr<Pool<Structs::Vvd::Vertex>> vvdVertices;
+    std::unique_ptr<Pool<Structs::Vector4D>> tangents;
+    std::unique_ptr<Pool<Structs::Vtx::Vertex>> vtxVertices;
+    std::unique_ptr<Pool<uint16_t>> indices;
+
+    std::atomic<size_t> buffersRequested = 0;
+    std::atomic<size_t> buffersStored = 0;
+    std::atomic<size_t> bytesRequested = 0;
+    std::atomic<size_t> bytesStored = 0;
+
+    template <typename T>
+    Buffer<T> intern(Pool<T>& pool, std::span<const T> data);
+  };
+}
@@ -0,0 +1,144 @@
+#include "draw-batches.hpp"
+#include <algorithm>
+#include <utility>
+#include "errors.hpp"
+#include "helpers/mesh-vertex-range.hpp"
+#include "welded-mesh.hpp"
+
+namespace MdlParser {
+  namespace {
+    /**
+     * A strip group's indices waiting to be placed into the batch for its material and flags.
+     */
+    struct Fragment {
+      int32_t texture;
+      Enums::Vtx::StripGroupFlags flags;
+
+      /**
+       * Index of the welded mesh the fragment's indices belong to.
+       */
+      size_t mesh;
+
+      WeldedMesh::StripGroupRange range;
+    };
+  }
+
+  DrawBatches buildDrawBatches(
+    const Mdl& mdl,
+    const Vtx& vtx,
+    const size_t skinFamily,
+    const std::span<const size_t> bodyGroups,
+    const size_t lod
+  ) {
+    const auto& mdlBodyParts = mdl.getBodyParts();
+    const auto& vtxBodyParts = vtx.getBodyParts();
+    if (mdlBodyParts.size() != vtxBodyParts.size()) {
+      throw Errors::OutOfBoundsAccess("VTX body part count does not match MDL");
+    }
+    if (bodyGroups.size() != mdlBodyParts.size()) {
+      throw Errors::OutOfBoundsAccess("Body group count does not match the number of body parts");
+    }
+    if (!mdl.getSkinLookupTable().empty() && skinFamily >= mdl.getSkinLookupTable().size()) {
+      throw Errors::OutOfBoundsAccess("Skin family is outside the skin lookup table");
+    }
+
+    DrawBatches drawBatches;
+    std::vector<WeldedMesh> weldedMeshes;
+    std::vector<uint32_t> vertexBases;
+    std::vector<Fragment> fragments;
+
+    for (size_t bodyPart = 0; bodyPart < mdlBodyParts.size(); bodyPart++) {
+      const auto& mdlModels = mdlBodyParts[bodyPart].models;
+      const auto& vtxModels = vtxBodyParts[bodyPart].models;
+      if (mdlModels.size() != vtxModels.size()) {
+        throw Errors::OutOfBoundsAccess("VTX model count does not match MDL");
+      }
+      if (bodyGroups[bodyPart] >= mdlModels.size()) {
+        throw Errors::OutOfBoundsAccess("Selected body group model is out of range");
+      }
+
+      const auto& mdlModel = mdlModels[bodyGroups[bodyPart]];
+      const auto& vtxLods = vtxModels[bodyGroups[bodyPart]].levelOfDetails;
+      if (vtxLods.empty()) {
+        continue;
+      }
+
+      const auto& vtxMeshes = vtxLods[std::min(lod, vtxLods.size() - 1)].meshes;
+      if (vtxMeshes.size() != mdlModel.meshes.size()) {
+        throw Errors::OutOfBoundsAccess("VTX mesh count does not match MDL");
+      }
+
+      for (size_t mesh = 0; mesh < vtxMeshes.size(); mesh++) {
+        const auto& mdlMesh = mdlModel.meshes[mesh];
+        if (mdlModel.vertexOffset < 0) {
+          throw Errors::OutOfBoundsAccess("MDL model vertex offset is negative");
+        }
+        checkMeshVertexRange(mdlModel, mdlMesh);
+
+        auto welded = weldMesh(mdlMesh, vtxMeshes[mesh]);
+        if (welded.indices.empty()) {
+          continue;
+        }
+
+        const auto texture = mdl.resolveTexture(skinFamily, mdlMesh.material);
+        if (!texture) {
+          throw Errors::OutOfBoundsAccess("Mesh material does not resolve to a texture");
+        }
+        // Both offsets are non-negative int32, so their sum always fits in 32 bits unsigned
+        const auto meshVertexOffset =
+          static_cast<uint32_t>(mdlModel.vertexOffset) + static_cast<uint32_t>(mdlMesh.vertexOffset);
+
+        vertexBases.push_back(static_cast<uint32_t>(drawBatches.vertices.size()));
+        for (const auto vertex : welded.vertices) {
+          drawBatches.vertices.push_back(meshVertexOffset + vertex);
+        }
+
+        for (const auto& range : welded.stripGroups) {
+          if (range.indexCount > 0) {
+            fragments.push_back({
+              .texture = static_cast<int32_t>(*texture),
+              .flags = range.flags,
+              .mesh = weldedMeshes.size(),
+              .range = range,
+            });
+          }
+        }
+
+        weldedMeshes.push_back(std::move(welded));
+      }
+    }
+
+    // Stable so that indices within a batch keep their original draw order
+    std::ranges::stable_sort(fragments, [](const Fragment& a, const Fragment& b) {
+      return std::pair(a.texture, a.flags) < std::pair(b.texture, b.flags);
+    });
+
+    size_t indexCount = 0;
+    for (const auto& fragment : fragments) {
+      indexCount += fragment.range.indexCount;
+    }
+    drawBatches.indices.reserve(indexCount);
+
+    for (const auto& fragment : fragments) {
+      auto& batches = drawBatches.batches;
+      if (batches.empty() || batches.back().texture != fragment.texture || batches.back().flags != fragment.flags) {
+        batches.push_back({
+          .texture = fragment.texture,
+          .flags = fragment.flags,
+          .indexOffset = static_cast<uint32_t>(drawBatches.indices.size()),
+          .indexCount = 0,
+        });
+      }
+
+      const auto& indices = weldedMeshes[fragment.mesh].indices;
+      const auto vertexBase = vertexBases[fragment.mesh];
+      for (size_t index = 0; index < fragment.range.indexCount; index++) {
+        drawBatches.indices.push_back(vertexBase + indices[fragment.range.indexOffset + index]);
+      }
+
+      batches.back().indexCount += fragment.range.indexCount;
+    }
+
+    return drawBatches;
+  }
+}
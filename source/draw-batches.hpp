@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+#include "enums.hpp"
+#include "mdl.hpp"
+#include "vtx.hpp"
+
+namespace MdlParser {
+  /**
+   * The geometry of a model with a given skin, body group selection and level of detail, grouped into as few draws as
+   * possible.
+   */
+  struct DrawBatches {
+    /**
+     * A single draw of every index sharing a material and strip group flags.
+     */
+    struct Batch {
+      /**
+       * Index into mdl.getTextures() of the material, with the skin already resolved.
+       */
+      int32_t texture;
+
+      Enums::Vtx::StripGroupFlags flags;
+
+      /**
+       * Offset of the batch's first index in indices.
+       */
+      uint32_t indexOffset;
+
+      uint32_t indexCount;
+    };
+
+    /**
+     * Offsets into the VVD's vertices (including the model and mesh offsets) making up the vertex buffer.
+     */
+    std::vector<uint32_t> vertices;
+
+    /**
+     * The indices of every batch, indexing into vertices.
+     */
+    std::vector<uint32_t> indices;
+
+    /**
+     * The batches, ordered by texture then flags.
+     */
+    std::vector<Batch> batches;
+  };
+
+  /**
+   * Merges the meshes of every selected model which share a material (and strip group flags) into a single draw each,
+   * across body parts, models, meshes and strip groups.
+   * @param mdl MDL data.
+   * @param vtx The corresponding VTX data.
+   * @param skinFamily Row of the skin lookup table to resolve materials with.
+   * @param bodyGroups Index of the selected model in each body part.
+   * @param lod The level of detail to draw. Models with fewer levels of detail use their lowest.
+   * @return The batches.
+   * @throws Errors::OutOfBoundsAccess if the skin family, a selected model or a mesh's material are out of range,
+   * or the MDL and VTX do not match.
+   */
+  [[nodiscard]] DrawBatches buildDrawBatches(
+    const Mdl& mdl,
+    const Vtx& vtx,
+    size_t skinFamily,
+    std::span<const size_t> bodyGroups,
+    size_t lod
+  );
+}
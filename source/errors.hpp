@@ -1,7 +1,10 @@
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
+#include <expected>
 #include <stdexcept>
+#include <type_traits>
 
 #define ERROR_FOR_REASON(reason) \
   class reason : public Error { \
@@ -16,6 +19,7 @@ namespace MdlParser::Errors {
     InvalidChecksum,
     UnsupportedVersion,
     OutOfBoundsAccess,
+    AllocationLimitExceeded,
   };
 
   class Error : public std::runtime_error {
@@ -35,6 +39,71 @@ namespace MdlParser::Errors {
   ERROR_FOR_REASON(InvalidChecksum);
   ERROR_FOR_REASON(UnsupportedVersion);
   ERROR_FOR_REASON(OutOfBoundsAccess);
+  ERROR_FOR_REASON(AllocationLimitExceeded);
+
+  /**
+   * Describes why parsing failed, returned by the non-throwing tryParse functions in place of an exception.
+   */
+  struct ParseError {
+    Reason reason;
+
+    /**
+     * Offset in bytes into the data at which the failing structure (or value) starts.
+     */
+    size_t offset;
+
+    /**
+     * Static description of what was being parsed when the error occurred.
+     */
+    const char* message;
+  };
+
+  /**
+   * Result of an operation which can fail without throwing.
+   */
+  template <typename T>
+  using Expected = std::expected<T, ParseError>;
+
+  [[nodiscard]] inline std::unexpected<ParseError> makeError(
+    const Reason reason, const size_t offset, const char* message
+  ) {
+    return std::unexpected(ParseError{.reason = reason, .offset = offset, .message = message});
+  }
+
+  /**
+   * Throws the Error subclass corresponding to the reason the parse failed.
+   */
+  [[noreturn]] inline void throwError(const ParseError& error) {
+    switch (error.reason) {
+      case Reason::InvalidHeader:
+        throw InvalidHeader(error.message);
+      case Reason::InvalidBody:
+        throw InvalidBody(error.message);
+      case Reason::InvalidChecksum:
+        throw InvalidChecksum(error.message);
+      case Reason::UnsupportedVersion:
+        throw UnsupportedVersion(error.message);
+      case Reason::AllocationLimitExceeded:
+        throw AllocationLimitExceeded(error.message);
+      case Reason::OutOfBoundsAccess:
+      default:
+        throw OutOfBoundsAccess(error.message);
+    }
+  }
+
+  /**
+   * Unwraps the value of a successful result, or throws the corresponding Error if it failed.
+   */
+  template <typename T>
+  T valueOrThrow(Expected<T>&& result) {
+    if (!result) {
+      throwError(result.error());
+    }
+
+    if constexpr (!std::is_void_v<T>) {
+      return std::move(*result);
+    }
+  }
 }
 
 #undef ERROR_FOR_REASON
@@ -0,0 +1,785 @@
+#include "glb-exporter.hpp"
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <numeric>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "errors.hpp"
+#include "lod-geometry.hpp"
+
+namespace MdlParser {
+  namespace {
+    constexpr uint32_t GLB_MAGIC = 0x46546C67;
+    constexpr uint32_t GLB_VERSION = 2;
+    constexpr uint32_t CHUNK_TYPE_JSON = 0x4E4F534A;
+    constexpr uint32_t CHUNK_TYPE_BIN = 0x004E4942;
+
+    constexpr uint32_t COMPONENT_UNSIGNED_BYTE = 5121;
+    constexpr uint32_t COMPONENT_UNSIGNED_SHORT = 5123;
+    constexpr uint32_t COMPONENT_UNSIGNED_INT = 5125;
+    constexpr uint32_t COMPONENT_FLOAT = 5126;
+
+    constexpr uint32_t TARGET_ARRAY_BUFFER = 34962;
+    constexpr uint32_t TARGET_ELEMENT_ARRAY_BUFFER = 34963;
+
+    constexpr uint32_t MODE_TRIANGLES = 4;
+
+    /**
+     * Size of the batches binary data is converted in before being passed to the sink.
+     */
+    constexpr size_t BATCH_SIZE = 256 * 1024;
+
+    constexpr size_t alignTo4(const size_t size) {
+      return (size + 3) & ~static_cast<size_t>(3);
+    }
+
+    /**
+     * Appends compact JSON to a string, inserting commas between values automatically.
+     */
+    class JsonWriter {
+    public:
+      JsonWriter& beginObject() {
+        separate();
+        text += '{';
+        needsComma = false;
+        return *this;
+      }
+
+      JsonWriter& endObject() {
+        text += '}';
+        needsComma = true;
+        return *this;
+      }
+
+      JsonWriter& beginArray() {
+        separate();
+        text += '[';
+        needsComma = false;
+        return *this;
+      }
+
+      JsonWriter& endArray() {
+        text += ']';
+        needsComma = true;
+        return *this;
+      }
+
+      JsonWriter& key(const std::string_view name) {
+        value(name);
+        text += ':';
+        needsComma = false;
+        return *this;
+      }
+
+      JsonWriter& value(const std::string_view string) {
+        separate();
+        text += '"';
+        for (const auto character : string) {
+          if (character == '"' || character == '\\') {
+            text += '\\';
+            text += character;
+          } else if (static_cast<unsigned char>(character) < 0x20) {
+            constexpr std::string_view hex = "0123456789abcdef";
+            text += "\\u00";
+            text += hex[(character >> 4) & 0xF];
+            text += hex[character & 0xF];
+          } else {
+            text += character;
+          }
+        }
+        text += '"';
+        needsComma = true;
+        return *this;
+      }
+
+      JsonWriter& value(const float number) {
+        separate();
+
+        // JSON has no representation of infinity or NaN
+        std::array<char, 32> buffer{};
+        const auto finite = std::isfinite(number) ? number : 0.0F;
+        const auto result = std::to_chars(buffer.data(), buffer.data() + buffer.size(), finite);
+        text.append(buffer.data(), result.ptr);
+        needsComma = true;
+        return *this;
+      }
+
+      template <std::integral T>
+      JsonWriter& value(const T number) {
+        separate();
+        std::array<char, 24> buffer{};
+        const auto result = std::to_chars(buffer.data(), buffer.data() + buffer.size(), number);
+        text.append(buffer.data(), result.ptr);
+        needsComma = true;
+        return *this;
+      }
+
+      template <typename T>
+      JsonWriter& member(const std::string_view name, const T& memberValue) {
+        key(name);
+        return value(memberValue);
+      }
+
+      /**
+       * Appends an already serialised JSON value.
+       */
+      JsonWriter& raw(const std::string_view json) {
+        separate();
+        text += json;
+        needsComma = true;
+        return *this;
+      }
+
+      [[nodiscard]] const std::string& getText() const {
+        return text;
+      }
+
+    private:
+      std::string text;
+      bool needsComma = false;
+
+      void separate() {
+        if (needsComma) {
+          text += ',';
+        }
+      }
+    };
+
+    /**
+     * Collects binary data into fixed size batches, passing each to the sink once full.
+     */
+    class BatchWriter {
+    public:
+      explicit BatchWriter(const GlbSink& sink) : sink(sink), batch(BATCH_SIZE) {}
+
+      /**
+       * Reserves space for size bytes (at most BATCH_SIZE) in the current batch, which the caller must fill.
+       */
+      std::byte* reserve(const size_t size) {
+        if (used + size > batch.size()) {
+          flush();
+        }
+
+        auto* reserved = batch.data() + used;
+        used += size;
+        return reserved;
+      }
+
+      void write(const void* data, const size_t size) {
+        if (size > batch.size()) {
+          flush();
+          sink({static_cast<const std::byte*>(data), size});
+          return;
+        }
+
+        std::memcpy(reserve(size), data, size);
+      }
+
+      template <typename T>
+      void write(const T& value) {
+        write(&value, sizeof(T));
+      }
+
+      void pad(const size_t size, const std::byte value) {
+        std::memset(reserve(size), static_cast<int>(value), size);
+      }
+
+      void flush() {
+        if (used > 0) {
+          sink({batch.data(), used});
+          used = 0;
+        }
+      }
+
+    private:
+      const GlbSink& sink;
+      std::vector<std::byte> batch;
+      size_t used = 0;
+    };
+
+    struct Bounds {
+      std::array<float, 3> min{
+        std::numeric_limits<float>::max(),
+        std::numeric_limits<float>::max(),
+        std::numeric_limits<float>::max(),
+      };
+      std::array<float, 3> max{
+        std::numeric_limits<float>::lowest(),
+        std::numeric_limits<float>::lowest(),
+        std::numeric_limits<float>::lowest(),
+      };
+
+      void expand(const Structs::Vector& point) {
+        min = {std::min(min[0], point.x), std::min(min[1], point.y), std::min(min[2], point.z)};
+        max = {std::max(max[0], point.x), std::max(max[1], point.y), std::max(max[2], point.z)};
+      }
+    };
+
+    /**
+     * Byte offsets of each attribute within an interleaved vertex.
+     */
+    struct VertexLayout {
+      bool hasTangents;
+      bool hasSkin;
+
+      uint32_t normal = 12;
+      uint32_t tangent = 24;
+      uint32_t texCoord;
+      uint32_t joints;
+      uint32_t weights;
+      uint32_t stride;
+
+      VertexLayout(const bool hasTangents, const bool hasSkin) : hasTangents(hasTangents), hasSkin(hasSkin) {
+        texCoord = hasTangents ? tangent + 16 : tangent;
+        joints = texCoord + 8;
+        weights = joints + 4;
+        stride = hasSkin ? weights + 16 : joints;
+      }
+    };
+
+    struct ModelPlan {
+      const Mdl::Model* mdlModel;
+      const Vtx::Model* vtxModel;
+      std::string name;
+
+      /**
+       * The model's geometry without its vertex and index data, which is rebuilt when the binary chunk is written so
+       * only one model's data is held at a time.
+       */
+      std::vector<LodGeometry::Lod> levelOfDetails;
+      size_t vertexCount;
+      size_t indexCount;
+
+      uint32_t node;
+
+      /**
+       * The levels of detail with anything to draw, paired with the node created for each.
+       */
+      std::vector<std::pair<size_t, uint32_t>> lodNodes;
+
+      /**
+       * Bounds of the vertices used by each level of detail.
+       */
+      std::vector<Bounds> lodBounds;
+
+      size_t vertexDataOffset;
+      size_t indexDataOffset;
+      uint32_t indexSize;
+    };
+
+    struct BodyPartPlan {
+      const Mdl::BodyPart* bodyPart;
+      uint32_t node;
+      std::vector<ModelPlan> models;
+    };
+
+    /**
+     * Checks every vertex referenced by the geometry is within the VVD and computes the bounds of each level of detail.
+     * Checking up front means nothing can fail once the file has started being written.
+     */
+    void checkAndMeasureVertices(
+      const ModelTriple& model, const VertexLayout& layout, const LodGeometry& geometry, ModelPlan& plan
+    ) {
+      const auto& vertices = model.vvd.getVertices();
+      const auto& tangents = model.vvd.getTangents();
+      const auto& levelOfDetails = geometry.levelOfDetails;
+
+      for (const auto vertex : geometry.vertices) {
+        if (
+          plan.mdlModel->vertexOffset < 0 || plan.mdlModel->vertexOffset + vertex >= vertices.size() ||
+          (layout.hasTangents &&
+           (plan.mdlModel->tangentsOffset < 0 || plan.mdlModel->tangentsOffset + vertex >= tangents.size()))
+        ) {
+          throw Errors::OutOfBoundsAccess("Model vertex is outside the VVD");
+        }
+      }
+
+      // Each level of detail uses a prefix of the vertex buffer, so one pass in order of size gives all the bounds
+      std::vector<size_t> bySize(levelOfDetails.size());
+      std::iota(bySize.begin(), bySize.end(), 0);
+      std::ranges::sort(bySize, {}, [&](const size_t lod) { return levelOfDetails[lod].vertexCount; });
+
+      plan.lodBounds.resize(levelOfDetails.size());
+      Bounds bounds;
+      size_t vertex = 0;
+
+      for (const auto lod : bySize) {
+        for (; vertex < levelOfDetails[lod].vertexCount; vertex++) {
+          bounds.expand(vertices[plan.mdlModel->vertexOffset + geometry.vertices[vertex]].pos);
+        }
+
+        plan.lodBounds[lod] = bounds;
+      }
+    }
+
+    /**
+     * Accumulates the glTF arrays which reference each other by index.
+     */
+    class Document {
+    public:
+      JsonWriter nodes;
+      JsonWriter meshes;
+      JsonWriter accessors;
+      JsonWriter bufferViews;
+
+      Document() {
+        nodes.beginArray();
+        meshes.beginArray();
+        accessors.beginArray();
+        bufferViews.beginArray();
+      }
+
+      uint32_t addBufferView(
+        const size_t byteOffset, const size_t byteLength, const uint32_t target, const uint32_t byteStride = 0
+      ) {
+        bufferViews.beginObject()
+          .member("buffer", 0)
+          .member("byteOffset", byteOffset)
+          .member("byteLength", byteLength);
+
+        if (byteStride != 0) {
+          bufferViews.member("byteStride", byteStride);
+        }
+        if (target != 0) {
+          bufferViews.member("target", target);
+        }
+
+        bufferViews.endObject();
+        return bufferViewCount++;
+      }
+
+      uint32_t addAccessor(
+        const uint32_t bufferView,
+        const size_t byteOffset,
+        const uint32_t componentType,
+        const size_t count,
+        const std::string_view type,
+        const Bounds* bounds = nullptr
+      ) {
+        accessors.beginObject()
+          .member("bufferView", bufferView)
+          .member("byteOffset", byteOffset)
+          .member("componentType", componentType)
+          .member("count", count)
+          .member("type", type);
+
+        if (bounds != nullptr) {
+          const auto& [min, max] = *bounds;
+          accessors.key("min").beginArray().value(min[0]).value(min[1]).value(min[2]).endArray();
+          accessors.key("max").beginArray().value(max[0]).value(max[1]).value(max[2]).endArray();
+        }
+
+        accessors.endObject();
+        return accessorCount++;
+      }
+
+      uint32_t beginMesh(const std::string_view name) {
+        meshes.beginObject().member("name", name).key("primitives").beginArray();
+        return meshCount++;
+      }
+
+      void endMesh() {
+        meshes.endArray().endObject();
+      }
+
+    private:
+      uint32_t bufferViewCount = 0;
+      uint32_t accessorCount = 0;
+      uint32_t meshCount = 0;
+    };
+
+    void writeVertices(
+      const ModelTriple& model,
+      const VertexLayout& layout,
+      const ModelPlan& plan,
+      const LodGeometry& geometry,
+      const size_t boneCount,
+      BatchWriter& writer
+    ) {
+      const auto& vertices = model.vvd.getVertices();
+      const auto& tangents = model.vvd.getTangents();
+
+      for (const auto modelVertex : geometry.vertices) {
+        auto* out = writer.reserve(layout.stride);
+
+        // Fields of the packed VVD structs are copied out before use
+        const auto& vertex = vertices[plan.mdlModel->vertexOffset + modelVertex];
+        const Structs::Vector position = vertex.pos;
+        const Structs::Vector normal = vertex.normal;
+        const Structs::Vector2D texCoord = vertex.texCoord;
+
+        std::memcpy(out, &position, sizeof(position));
+        std::memcpy(out + layout.normal, &normal, sizeof(normal));
+        std::memcpy(out + layout.texCoord, &texCoord, sizeof(texCoord));
+
+        if (layout.hasTangents) {
+          const Structs::Vector4D tangent = tangents[plan.mdlModel->tangentsOffset + modelVertex];
+          std::memcpy(out + layout.tangent, &tangent, sizeof(tangent));
+        }
+
+        if (layout.hasSkin) {
+          const Structs::Vvd::BoneWeight boneWeights = vertex.boneWeights;
+          std::array<uint8_t, 4> joints{};
+          std::array<float, 4> weights{};
+
+          const auto influences = std::min<size_t>(boneWeights.numBones, Limits::MAX_NUM_BONES_PER_VERT);
+          for (size_t influence = 0; influence < influences; influence++) {
+            const auto bone = static_cast<uint8_t>(boneWeights.bone[influence]);
+            if (bone < boneCount) {
+              joints[influence] = bone;
+              weights[influence] = boneWeights.weight[influence];
+            }
+          }
+
+          // Vertices without any valid influences follow the root bone
+          if (weights == std::array<float, 4>{}) {
+            weights[0] = 1.0F;
+          }
+
+          std::memcpy(out + layout.joints, joints.data(), sizeof(joints));
+          std::memcpy(out + layout.weights, weights.data(), sizeof(weights));
+        }
+      }
+    }
+
+    void writeIndices(const ModelPlan& plan, const LodGeometry& geometry, BatchWriter& writer) {
+      for (const auto index : geometry.indices) {
+        if (plan.indexSize == sizeof(uint16_t)) {
+          writer.write(static_cast<uint16_t>(index));
+        } else {
+          writer.write(index);
+        }
+      }
+
+      const auto size = geometry.indices.size() * plan.indexSize;
+      writer.pad(alignTo4(size) - size, std::byte{0});
+    }
+
+    void writeInverseBindMatrices(const Mdl& mdl, BatchWriter& writer) {
+      for (const auto& bone : mdl.getBones()) {
+        // poseToBone is a row-major 3x4 matrix, whereas glTF matrices are column-major 4x4
+        std::array<float, 16> matrix{};
+        for (size_t column = 0; column < 4; column++) {
+          for (size_t row = 0; row < 3; row++) {
+            matrix[column * 4 + row] = bone.poseToBone[static_cast<int>(row)][column];
+          }
+        }
+        matrix[15] = 1.0F;
+
+        writer.write(matrix);
+      }
+    }
+  }
+
+  void exportGlb(const ModelTriple& model, const GlbSink& sink) {
+    const auto& bones = model.mdl.getBones();
+    const auto& vtxBodyParts = model.vtx.getBodyParts();
+    const auto& mdlBodyParts = model.mdl.getBodyParts();
+
+    if (vtxBodyParts.size() != mdlBodyParts.size()) {
+      throw Errors::OutOfBoundsAccess("VTX body part count does not match MDL");
+    }
+
+    const VertexLayout layout(model.vvd.getTangents().size() >= model.vvd.getVertices().size(), !bones.empty());
+
+    // Plan the node hierarchy and binary layout, so the JSON can be written before any binary data
+    constexpr uint32_t rootNode = 0;
+    auto nodeCount = static_cast<uint32_t>(1 + bones.size());
+    size_t binaryLength = 0;
+    auto usesLodExtension = false;
+
+    std::vector<BodyPartPlan> bodyPartPlans;
+    for (size_t bodyPart = 0; bodyPart < mdlBodyParts.size(); bodyPart++) {
+      const auto& mdlModels = mdlBodyParts[bodyPart].models;
+      const auto& vtxModels = vtxBodyParts[bodyPart].models;
+      if (vtxModels.size() != mdlModels.size()) {
+        throw Errors::OutOfBoundsAccess("VTX model count does not match MDL");
+      }
+
+      auto& bodyPartPlan = bodyPartPlans.emplace_back(
+        BodyPartPlan{ .bodyPart = &mdlBodyParts[bodyPart], .node = nodeCount++ }
+      );
+
+      for (size_t index = 0; index < mdlModels.size(); index++) {
+        auto geometry = buildLodGeometry(mdlModels[index], vtxModels[index]);
+        auto& plan = bodyPartPlan.models.emplace_back(
+          ModelPlan{
+            .mdlModel = &mdlModels[index],
+            .vtxModel = &vtxModels[index],
+            .name = mdlBodyParts[bodyPart].name + " " + std::to_string(index),
+            .vertexCount = geometry.vertices.size(),
+            .indexCount = geometry.indices.size(),
+            .node = nodeCount++,
+          }
+        );
+
+        checkAndMeasureVertices(model, layout, geometry, plan);
+        plan.levelOfDetails = std::move(geometry.levelOfDetails);
+
+        const auto& levelOfDetails = plan.levelOfDetails;
+        for (size_t lod = 0; lod < levelOfDetails.size(); lod++) {
+          const auto hasPrimitives = levelOfDetails[lod].vertexCount > 0 &&
+            std::ranges::any_of(levelOfDetails[lod].meshes, [](const auto& mesh) { return mesh.indexCount > 0; });
+
+          if (hasPrimitives) {
+            plan.lodNodes.emplace_back(lod, nodeCount++);
+          }
+        }
+        usesLodExtension = usesLodExtension || plan.lodNodes.size() > 1;
+
+        if (plan.lodNodes.empty()) {
+          continue;
+        }
+
+        plan.indexSize = plan.vertexCount <= std::numeric_limits<uint16_t>::max() + size_t{1}
+          ? sizeof(uint16_t)
+          : sizeof(uint32_t);
+        plan.vertexDataOffset = binaryLength;
+        binaryLength += plan.vertexCount * layout.stride;
+        plan.indexDataOffset = binaryLength;
+        binaryLength += alignTo4(plan.indexCount * plan.indexSize);
+      }
+    }
+
+    const auto inverseBindMatricesOffset = binaryLength;
+    binaryLength += bones.size() * sizeof(std::array<float, 16>);
+
+    // Build the JSON
+    Document document;
+    std::vector<std::vector<uint32_t>> boneChildren(bones.size());
+    std::vector<uint32_t> rootChildren;
+
+    for (size_t bone = 0; bone < bones.size(); bone++) {
+      const auto parent = bones[bone].parent;
+      if (parent >= 0 && static_cast<size_t>(parent) < bones.size() && static_cast<size_t>(parent) != bone) {
+        boneChildren[parent].push_back(static_cast<uint32_t>(1 + bone));
+      } else {
+        rootChildren.push_back(static_cast<uint32_t>(1 + bone));
+      }
+    }
+
+    for (const auto& bodyPartPlan : bodyPartPlans) {
+      rootChildren.push_back(bodyPartPlan.node);
+    }
+
+    // Z-up to Y-up: -90 degrees around the X axis
+    document.nodes.beginObject().member("name", "root");
+    constexpr auto halfSqrt2 = 0.70710677F;
+    document.nodes.key("rotation").beginArray().value(-halfSqrt2).value(0.0F).value(0.0F).value(halfSqrt2).endArray();
+    document.nodes.key("children").beginArray();
+    for (const auto child : rootChildren) {
+      document.nodes.value(child);
+    }
+    document.nodes.endArray().endObject();
+
+    for (size_t bone = 0; bone < bones.size(); bone++) {
+      const Structs::Vector position = bones[bone].position;
+      const Structs::Quaternion orientation = bones[bone].orientation;
+
+      document.nodes.beginObject().member("name", bones[bone].name);
+      document.nodes.key("translation").beginArray().value(position.x).value(position.y).value(position.z).endArray();
+      document.nodes.key("rotation")
+        .beginArray()
+        .value(orientation.x)
+        .value(orientation.y)
+        .value(orientation.z)
+        .value(orientation.w)
+        .endArray();
+
+      if (!boneChildren[bone].empty()) {
+        document.nodes.key("children").beginArray();
+        for (const auto child : boneChildren[bone]) {
+          document.nodes.value(child);
+        }
+        document.nodes.endArray();
+      }
+
+      document.nodes.endObject();
+    }
+
+    std::optional<uint32_t> inverseBindMatrices;
+    if (!bones.empty()) {
+      const auto bufferView = document.addBufferView(inverseBindMatricesOffset, bones.size() * 64, 0);
+      inverseBindMatrices = document.addAccessor(bufferView, 0, COMPONENT_FLOAT, bones.size(), "MAT4");
+    }
+
+    for (const auto& bodyPartPlan : bodyPartPlans) {
+      document.nodes.beginObject().member("name", bodyPartPlan.bodyPart->name).key("children").beginArray();
+      for (const auto& plan : bodyPartPlan.models) {
+        document.nodes.value(plan.node);
+      }
+      document.nodes.endArray().endObject();
+
+      for (const auto& plan : bodyPartPlan.models) {
+        document.nodes.beginObject().member("name", plan.name);
+        if (!plan.lodNodes.empty()) {
+          document.nodes.key("children").beginArray().value(plan.lodNodes.front().second).endArray();
+        }
+        document.nodes.endObject();
+
+        if (plan.lodNodes.empty()) {
+          continue;
+        }
+
+        const auto vertexView = document.addBufferView(
+          plan.vertexDataOffset, plan.vertexCount * layout.stride, TARGET_ARRAY_BUFFER, layout.stride
+        );
+        const auto indexView = document.addBufferView(
+          plan.indexDataOffset, plan.indexCount * plan.indexSize, TARGET_ELEMENT_ARRAY_BUFFER
+        );
+
+        for (size_t lodNode = 0; lodNode < plan.lodNodes.size(); lodNode++) {
+          const auto lod = plan.lodNodes[lodNode].first;
+          const auto& levelOfDetail = plan.levelOfDetails[lod];
+          const auto vertexCount = levelOfDetail.vertexCount;
+
+          // Each level of detail gets its own attribute accessors, covering only the prefix of the buffer it uses
+          JsonWriter attributes;
+          const auto addAttribute = [&](
+            const std::string_view name,
+            const uint32_t offset,
+            const uint32_t componentType,
+            const std::string_view type,
+            const Bounds* bounds = nullptr
+          ) {
+            attributes.member(name, document.addAccessor(vertexView, offset, componentType, vertexCount, type, bounds));
+          };
+
+          attributes.beginObject();
+          addAttribute("POSITION", 0, COMPONENT_FLOAT, "VEC3", &plan.lodBounds[lod]);
+          addAttribute("NORMAL", layout.normal, COMPONENT_FLOAT, "VEC3");
+          if (layout.hasTangents) {
+            addAttribute("TANGENT", layout.tangent, COMPONENT_FLOAT, "VEC4");
+          }
+          addAttribute("TEXCOORD_0", layout.texCoord, COMPONENT_FLOAT, "VEC2");
+          if (layout.hasSkin) {
+            addAttribute("JOINTS_0", layout.joints, COMPONENT_UNSIGNED_BYTE, "VEC4");
+            addAttribute("WEIGHTS_0", layout.weights, COMPONENT_FLOAT, "VEC4");
+          }
+          attributes.endObject();
+
+          const auto mesh = document.beginMesh(plan.name + " LOD " + std::to_string(lod));
+          for (const auto& lodMesh : levelOfDetail.meshes) {
+            if (lodMesh.indexCount == 0) {
+              continue;
+            }
+
+            const auto indices = document.addAccessor(
+              indexView,
+              static_cast<size_t>(lodMesh.indexOffset) * plan.indexSize,
+              plan.indexSize == sizeof(uint16_t) ? COMPONENT_UNSIGNED_SHORT : COMPONENT_UNSIGNED_INT,
+              lodMesh.indexCount,
+              "SCALAR"
+            );
+
+            document.meshes.beginObject().key("attributes").raw(attributes.getText()).member("indices", indices);
+            if (const auto material = model.mdl.resolveTexture(0, lodMesh.material)) {
+              document.meshes.member("material", *material);
+            }
+            document.meshes.member("mode", MODE_TRIANGLES).endObject();
+          }
+          document.endMesh();
+
+          document.nodes.beginObject().member("name", "LOD " + std::to_string(lod)).member("mesh", mesh);
+          if (inverseBindMatrices) {
+            document.nodes.member("skin", 0);
+          }
+
+          // Lower levels of detail are only referenced through the extension, so are not part of the scene
+          if (lodNode == 0 && plan.lodNodes.size() > 1) {
+            document.nodes.key("extensions").beginObject().key("MSFT_lod").beginObject().key("ids").beginArray();
+            for (size_t lower = 1; lower < plan.lodNodes.size(); lower++) {
+              document.nodes.value(plan.lodNodes[lower].second);
+            }
+            document.nodes.endArray().endObject().endObject();
+          }
+
+          document.nodes.endObject();
+        }
+      }
+    }
+
+    JsonWriter json;
+    json.beginObject();
+    json.key("asset").beginObject().member("version", "2.0").member("generator", "MDLParser").endObject();
+    if (usesLodExtension) {
+      json.key("extensionsUsed").beginArray().value("MSFT_lod").endArray();
+    }
+
+    json.member("scene", 0);
+    json.key("scenes").beginArray().beginObject().key("nodes").beginArray().value(rootNode).endArray();
+    json.endObject().endArray();
+    json.key("nodes").raw(document.nodes.endArray().getText());
+    json.key("meshes").raw(document.meshes.endArray().getText());
+
+    if (!model.mdl.getTextures().empty()) {
+      json.key("materials").beginArray();
+      for (const auto& texture : model.mdl.getTextures()) {
+        json.beginObject().member("name", texture.name).endObject();
+      }
+      json.endArray();
+    }
+
+    if (inverseBindMatrices) {
+      json.key("skins").beginArray().beginObject().member("inverseBindMatrices", *inverseBindMatrices);
+      json.key("joints").beginArray();
+      for (size_t bone = 0; bone < bones.size(); bone++) {
+        json.value(static_cast<uint32_t>(1 + bone));
+      }
+      json.endArray().endObject().endArray();
+    }
+
+    json.key("accessors").raw(document.accessors.endArray().getText());
+    json.key("bufferViews").raw(document.bufferViews.endArray().getText());
+    if (binaryLength > 0) {
+      json.key("buffers").beginArray().beginObject().member("byteLength", binaryLength).endObject().endArray();
+    }
+    json.endObject();
+
+    // Stream the file
+    const auto& jsonText = json.getText();
+    const auto jsonChunkLength = static_cast<uint32_t>(alignTo4(jsonText.size()));
+    const auto binaryChunkLength = static_cast<uint32_t>(alignTo4(binaryLength));
+    const auto fileLength = 12 + 8 + jsonChunkLength + (binaryLength > 0 ? 8 + binaryChunkLength : 0);
+
+    BatchWriter writer(sink);
+    writer.write(std::array<uint32_t, 3>{GLB_MAGIC, GLB_VERSION, static_cast<uint32_t>(fileLength)});
+    writer.write(std::array<uint32_t, 2>{jsonChunkLength, CHUNK_TYPE_JSON});
+    writer.write(jsonText.data(), jsonText.size());
+    writer.pad(jsonChunkLength - jsonText.size(), std::byte{' '});
+
+    if (binaryLength > 0) {
+      writer.write(std::array<uint32_t, 2>{binaryChunkLength, CHUNK_TYPE_BIN});
+
+      for (const auto& bodyPartPlan : bodyPartPlans) {
+        for (const auto& plan : bodyPartPlan.models) {
+          if (plan.lodNodes.empty()) {
+            continue;
+          }
+
+          // Building the geometry is deterministic, so it matches the sizes and offsets planned above
+          const auto geometry = buildLodGeometry(*plan.mdlModel, *plan.vtxModel);
+          writeVertices(model, layout, plan, geometry, bones.size(), writer);
+          writeIndices(plan, geometry, writer);
+        }
+      }
+
+      writeInverseBindMatrices(model.mdl, writer);
+      writer.pad(binaryChunkLength - binaryLength, std::byte{0});
+    }
+
+    writer.flush();
+  }
+
+  void exportGlb(const ModelTriple& model, std::ostream& stream) {
+    exportGlb(model, [&](const std::span<const std::byte> data) {
+      stream.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+    });
+  }
+}
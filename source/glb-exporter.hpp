@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <ostream>
+#include <span>
+#include "model-triple.hpp"
+
+namespace MdlParser {
+  /**
+   * Receives an exported file in order, one chunk at a time. The data is only valid for the duration of the call.
+   */
+  using GlbSink = std::function<void(std::span<const std::byte> data)>;
+
+  /**
+   * Exports a model as a binary glTF 2.0 (GLB) file.
+   *
+   * The export contains the skeleton (as a skin with one joint per bone), a node for each body part and each of its
+   * models, and a mesh for each level of detail of every model. Levels of detail after the first are linked with the
+   * MSFT_lod extension, so viewers without it only show the highest detail. Vertices carry positions, normals,
+   * tangents, texture coordinates, joints and weights, and every level of detail of a model shares one vertex buffer.
+   * The skin lookup table's first skin family is used for materials, which are named after the model's textures.
+   *
+   * The JSON (whose size depends on the number of meshes and bones, not vertices) is built in memory, but vertex and
+   * index data is only held for one model at a time: each model's geometry is built once to plan the file and again
+   * while writing it. Vertex, index and matrix data is converted in small batches and passed straight to the sink.
+   * @remarks Source models are Z-up, so the scene's root node rotates the model to glTF's Y-up.
+   * @param model The model to export.
+   * @param sink Called with each chunk of the file in order.
+   * @throws Errors::OutOfBoundsAccess if the MDL and VTX meshes do not match, or refer to vertices outside the VVD.
+   */
+  void exportGlb(const ModelTriple& model, const GlbSink& sink);
+
+  /**
+   * Exports a model as a binary glTF 2.0 (GLB) file, writing it to a stream.
+   * @param model The model to export.
+   * @param stream Stream to write to, which should be opened in binary mode.
+   * @throws Errors::OutOfBoundsAccess if the MDL and VTX meshes do not match, or refer to vertices outside the VVD.
+   */
+  void exportGlb(const ModelTriple& model, std::ostream& stream);
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstddef>
+#include <new>
+
+namespace MdlParser {
+  /**
+   * Allocator for standard containers whose storage must start on a boundary stricter than the element type's own,
+   * e.g. so SIMD code can use aligned loads.
+   */
+  template <typename T, size_t Alignment>
+  struct AlignedAllocator {
+    using value_type = T;
+
+    template <typename U>
+    struct rebind {
+      using other = AlignedAllocator<U, Alignment>;
+    };
+
+    AlignedAllocator() = default;
+
+    template <typename U>
+    AlignedAllocator(const AlignedAllocator<U, Alignment>&) noexcept {}
+
+    [[nodiscard]] T* allocate(const size_t count) {
+      return static_cast<T*>(::operator new(count * sizeof(T), std::align_val_t(Alignment)));
+    }
+
+    void deallocate(T* pointer, size_t) noexcept {
+      ::operator delete(pointer, std::align_val_t(Alignment));
+    }
+
+    template <typename U>
+    bool operator==(const AlignedAllocator<U, Alignment>&) const noexcept {
+      return true;
+    }
+  };
+}
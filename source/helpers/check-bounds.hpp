@@ -6,9 +6,31 @@
 namespace MdlParser {
   using namespace Errors;
 
-  inline void checkBounds(size_t offset, size_t count, size_t rangeSize, const char* errorMessage) {
-    if (offset >= rangeSize || offset + count > rangeSize) {
-      throw OutOfBoundsAccess(errorMessage);
+  [[nodiscard]] inline Expected<void> checkBounds(
+    const size_t offset, const size_t count, const size_t rangeSize, const char* errorMessage
+  ) {
+    // Compared against the space remaining, so huge counts (such as negative counts converted to size_t) cannot wrap
+    if (offset >= rangeSize || count > rangeSize - offset) {
+      return makeError(Reason::OutOfBoundsAccess, offset, errorMessage);
     }
+
+    return {};
+  }
+
+  /**
+   * Checks that count elements of elementSize bytes starting at offset lie within a range, without multiplying the
+   * untrusted count. Empty arrays are always in bounds, whatever their offset.
+   */
+  [[nodiscard]] inline Expected<void> checkArrayBounds(
+    const size_t offset, const size_t count, const size_t elementSize, const size_t rangeSize, const char* errorMessage
+  ) {
+    if (count == 0) {
+      return {};
+    }
+    if (offset >= rangeSize || count > (rangeSize - offset) / elementSize) {
+      return makeError(Reason::OutOfBoundsAccess, offset, errorMessage);
+    }
+
+    return {};
   }
 }
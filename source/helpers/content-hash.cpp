@@ -0,0 +1,82 @@
+#include "content-hash.hpp"
+#include <array>
+#include <bit>
+#include <cstring>
+
+namespace MdlParser {
+  namespace {
+    constexpr uint64_t PRIME_1 = 0x9e3779b185ebca87;
+    constexpr uint64_t PRIME_2 = 0xc2b2ae3d27d4eb4f;
+    constexpr uint64_t PRIME_3 = 0x165667b19e3779f9;
+    constexpr uint64_t PRIME_4 = 0x85ebca77c2b2ae63;
+    constexpr uint64_t PRIME_5 = 0x27d4eb2f165667c5;
+
+    template <typename T>
+    T read(const std::byte* data) {
+      T value;
+      std::memcpy(&value, data, sizeof(T));
+      return value;
+    }
+
+    uint64_t round(uint64_t accumulator, const uint64_t input) {
+      accumulator += input * PRIME_2;
+      accumulator = std::rotl(accumulator, 31);
+      return accumulator * PRIME_1;
+    }
+
+    uint64_t mergeRound(uint64_t accumulator, const uint64_t value) {
+      accumulator ^= round(0, value);
+      return accumulator * PRIME_1 + PRIME_4;
+    }
+  }
+
+  uint64_t getContentHash(const std::span<const std::byte> data, const uint64_t seed) {
+    const auto* cursor = data.data();
+    const auto* const end = cursor + data.size();
+    uint64_t hash;
+
+    if (data.size() >= 32) {
+      std::array<uint64_t, 4> lanes{seed + PRIME_1 + PRIME_2, seed + PRIME_2, seed, seed - PRIME_1};
+
+      do {
+        for (auto& lane : lanes) {
+          lane = round(lane, read<uint64_t>(cursor));
+          cursor += sizeof(uint64_t);
+        }
+      } while (end - cursor >= 32);
+
+      hash = std::rotl(lanes[0], 1) + std::rotl(lanes[1], 7) + std::rotl(lanes[2], 12) + std::rotl(lanes[3], 18);
+      for (const auto lane : lanes) {
+        hash = mergeRound(hash, lane);
+      }
+    } else {
+      hash = seed + PRIME_5;
+    }
+
+    hash += data.size();
+
+    for (; end - cursor >= 8; cursor += 8) {
+      hash ^= round(0, read<uint64_t>(cursor));
+      hash = std::rotl(hash, 27) * PRIME_1 + PRIME_4;
+    }
+
+    if (end - cursor >= 4) {
+      hash ^= static_cast<uint64_t>(read<uint32_t>(cursor)) * PRIME_1;
+      hash = std::rotl(hash, 23) * PRIME_2 + PRIME_3;
+      cursor += 4;
+    }
+
+    for (; cursor < end; cursor++) {
+      hash ^= static_cast<uint64_t>(*cursor) * PRIME_5;
+      hash = std::rotl(hash, 11) * PRIME_1;
+    }
+
+    hash ^= hash >> 33;
+    hash *= PRIME_2;
+    hash ^= hash >> 29;
+    hash *= PRIME_3;
+    hash ^= hash >> 32;
+
+    return hash;
+  }
+}
@@ -0,0 +1,13 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+namespace MdlParser {
+  /**
+   * Hashes a block of memory with XXH64, a fast non-cryptographic 64-bit hash.
+   * @remarks Collisions are possible, so equal hashes must still be confirmed by comparing the contents.
+   */
+  [[nodiscard]] uint64_t getContentHash(std::span<const std::byte> data, uint64_t seed = 0);
+}
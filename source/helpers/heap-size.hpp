@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace MdlParser {
+  /**
+   * Gets the number of bytes a string has allocated on the heap.
+   */
+  [[nodiscard]] inline size_t getHeapSize(const std::string& value) {
+    // Short strings are stored inline and never touch the heap
+    return value.capacity() > std::string().capacity() ? value.capacity() + 1 : 0;
+  }
+
+  /**
+   * Gets the number of bytes a vector of elements which own no memory themselves has allocated on the heap.
+   */
+  template <typename T, typename Allocator>
+  [[nodiscard]] size_t getHeapSize(const std::vector<T, Allocator>& values) {
+    return values.capacity() * sizeof(T);
+  }
+
+  /**
+   * Gets the number of bytes a vector and its elements have allocated on the heap.
+   * @param values
+   * @param getElementHeapSize Returns the number of bytes a single element has allocated on the heap.
+   */
+  template <typename T, typename GetElementHeapSize>
+  [[nodiscard]] size_t getHeapSize(const std::vector<T>& values, const GetElementHeapSize& getElementHeapSize) {
+    auto size = getHeapSize(values);
+    for (const auto& value : values) {
+      size += getElementHeapSize(value);
+    }
+
+    return size;
+  }
+}
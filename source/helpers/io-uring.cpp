@@ -0,0 +1,186 @@
+#include "io-uring.hpp"
+
+#ifdef MDLPARSER_HAS_IO_URING
+
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <linux/io_uring.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <system_error>
+#include <unistd.h>
+
+namespace MdlParser {
+  namespace {
+    uint32_t loadAcquire(uint32_t* value) {
+      return std::atomic_ref(*value).load(std::memory_order_acquire);
+    }
+
+    void storeRelease(uint32_t* value, const uint32_t newValue) {
+      std::atomic_ref(*value).store(newValue, std::memory_order_release);
+    }
+
+    template <typename T>
+    T* atOffset(void* base, const uint32_t offset) {
+      return reinterpret_cast<T*>(static_cast<std::byte*>(base) + offset);
+    }
+
+    void* mapRing(const int fd, const size_t size, const off_t offset) {
+      void* mapped = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, offset);
+      if (mapped == MAP_FAILED) {
+        throw std::system_error(errno, std::system_category(), "Failed to map io_uring ring");
+      }
+
+      return mapped;
+    }
+  }
+
+  IoUring::IoUring(const uint32_t entries) {
+    io_uring_params params{};
+
+    ringFd = static_cast<int>(syscall(__NR_io_uring_setup, entries, &params));
+    if (ringFd < 0) {
+      throw std::system_error(errno, std::system_category(), "Failed to create io_uring");
+    }
+
+    try {
+      submissionRingSize = params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+      completionRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+
+      if (params.features & IORING_FEAT_SINGLE_MMAP) {
+        submissionRingSize = std::max(submissionRingSize, completionRingSize);
+        submissionRing = mapRing(ringFd, submissionRingSize, IORING_OFF_SQ_RING);
+        completionRing = submissionRing;
+        completionRingSize = 0;
+      } else {
+        submissionRing = mapRing(ringFd, submissionRingSize, IORING_OFF_SQ_RING);
+        completionRing = mapRing(ringFd, completionRingSize, IORING_OFF_CQ_RING);
+      }
+
+      submissionEntriesSize = params.sq_entries * sizeof(io_uring_sqe);
+      submissionEntries = static_cast<io_uring_sqe*>(mapRing(ringFd, submissionEntriesSize, IORING_OFF_SQES));
+    } catch (...) {
+      release();
+      throw;
+    }
+
+    submissionHead = atOffset<uint32_t>(submissionRing, params.sq_off.head);
+    submissionTail = atOffset<uint32_t>(submissionRing, params.sq_off.tail);
+    submissionMask = *atOffset<uint32_t>(submissionRing, params.sq_off.ring_mask);
+    submissionArray = atOffset<uint32_t>(submissionRing, params.sq_off.array);
+    submissionCapacity = params.sq_entries;
+
+    completionHead = atOffset<uint32_t>(completionRing, params.cq_off.head);
+    completionTail = atOffset<uint32_t>(completionRing, params.cq_off.tail);
+    completionMask = *atOffset<uint32_t>(completionRing, params.cq_off.ring_mask);
+    completionEntries = atOffset<io_uring_cqe>(completionRing, params.cq_off.cqes);
+  }
+
+  IoUring::~IoUring() {
+    release();
+  }
+
+  void IoUring::release() {
+    if (submissionEntries != nullptr) {
+      munmap(submissionEntries, submissionEntriesSize);
+    }
+    if (completionRing != nullptr && completionRing != submissionRing) {
+      munmap(completionRing, completionRingSize);
+    }
+    if (submissionRing != nullptr) {
+      munmap(submissionRing, submissionRingSize);
+    }
+    if (ringFd >= 0) {
+      close(ringFd);
+    }
+
+    submissionEntries = nullptr;
+    completionRing = nullptr;
+    submissionRing = nullptr;
+    ringFd = -1;
+  }
+
+  io_uring_sqe* IoUring::acquireEntry() {
+    const auto tail = *submissionTail;
+    if (tail - loadAcquire(submissionHead) >= submissionCapacity) {
+      return nullptr;
+    }
+
+    const auto index = tail & submissionMask;
+    auto* entry = &submissionEntries[index];
+    std::memset(entry, 0, sizeof(io_uring_sqe));
+
+    submissionArray[index] = index;
+    return entry;
+  }
+
+  bool IoUring::queueRead(const int fd, const iovec* buffer, const uint64_t offset, const uint64_t userData) {
+    auto* entry = acquireEntry();
+    if (entry == nullptr) {
+      return false;
+    }
+
+    entry->opcode = IORING_OP_READV;
+    entry->fd = fd;
+    entry->addr = reinterpret_cast<uint64_t>(buffer);
+    entry->len = 1;
+    entry->off = offset;
+    entry->user_data = userData;
+
+    storeRelease(submissionTail, *submissionTail + 1);
+    unsubmitted++;
+    return true;
+  }
+
+  bool IoUring::queuePoll(const int fd, const uint64_t userData) {
+    auto* entry = acquireEntry();
+    if (entry == nullptr) {
+      return false;
+    }
+
+    entry->opcode = IORING_OP_POLL_ADD;
+    entry->fd = fd;
+    entry->poll_events = POLLIN;
+    entry->user_data = userData;
+
+    storeRelease(submissionTail, *submissionTail + 1);
+    unsubmitted++;
+    return true;
+  }
+
+  void IoUring::submitAndWait(const uint32_t minComplete) {
+    while (true) {
+      const auto flags = minComplete > 0 ? IORING_ENTER_GETEVENTS : 0u;
+      const auto submitted = syscall(__NR_io_uring_enter, ringFd, unsubmitted, minComplete, flags, nullptr, 0);
+
+      if (submitted >= 0) {
+        unsubmitted -= static_cast<uint32_t>(submitted);
+        return;
+      }
+      if (errno != EINTR && errno != EAGAIN && errno != EBUSY) {
+        throw std::system_error(errno, std::system_category(), "Failed to submit to io_uring");
+      }
+    }
+  }
+
+  bool IoUring::popCompletion(Completion& completion) {
+    const auto head = *completionHead;
+    if (head == loadAcquire(completionTail)) {
+      return false;
+    }
+
+    const auto& entry = completionEntries[head & completionMask];
+    completion = {.userData = entry.user_data, .result = entry.res};
+
+    storeRelease(completionHead, head + 1);
+    return true;
+  }
+
+  uint32_t IoUring::getCapacity() const {
+    return submissionCapacity;
+  }
+}
+
+#endif
@@ -0,0 +1,94 @@
+#pragma once
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#define MDLPARSER_HAS_IO_URING 1
+#endif
+
+#ifdef MDLPARSER_HAS_IO_URING
+
+#include <cstddef>
+#include <cstdint>
+#include <sys/uio.h>
+
+struct io_uring_sqe;
+struct io_uring_cqe;
+
+namespace MdlParser {
+  /**
+   * Thin wrapper around a Linux io_uring instance driven directly through the raw syscalls.
+   * Only supports the handful of operations needed by the asynchronous loader, and is not thread-safe -
+   * a single thread is expected to own submission and completion.
+   */
+  class IoUring {
+  public:
+    struct Completion {
+      uint64_t userData;
+      int32_t result;
+    };
+
+    /**
+     * Creates the ring.
+     * @param entries Requested submission queue size (rounded up to a power of two by the kernel).
+     * @throws std::system_error if io_uring is unavailable (old kernel, seccomp filter, etc.).
+     */
+    explicit IoUring(uint32_t entries);
+
+    ~IoUring();
+    IoUring(const IoUring&) = delete;
+    IoUring& operator=(const IoUring&) = delete;
+    IoUring(IoUring&&) = delete;
+    IoUring& operator=(IoUring&&) = delete;
+
+    /**
+     * Queues a vectored read of a single iovec. The iovec must remain valid until the read completes.
+     * @return False if the submission queue is full.
+     */
+    bool queueRead(int fd, const iovec* buffer, uint64_t offset, uint64_t userData);
+
+    /**
+     * Queues a one-shot poll for readability on fd.
+     * @return False if the submission queue is full.
+     */
+    bool queuePoll(int fd, uint64_t userData);
+
+    /**
+     * Submits all queued entries and blocks until at least minComplete completions are available.
+     */
+    void submitAndWait(uint32_t minComplete);
+
+    /**
+     * Pops a single completion off the completion queue.
+     * @return False if the completion queue is empty.
+     */
+    bool popCompletion(Completion& completion);
+
+    [[nodiscard]] uint32_t getCapacity() const;
+
+  private:
+    int ringFd = -1;
+
+    void* submissionRing = nullptr;
+    size_t submissionRingSize = 0;
+    void* completionRing = nullptr;
+    size_t completionRingSize = 0;
+    io_uring_sqe* submissionEntries = nullptr;
+    size_t submissionEntriesSize = 0;
+
+    uint32_t* submissionHead = nullptr;
+    uint32_t* submissionTail = nullptr;
+    uint32_t submissionMask = 0;
+    uint32_t* submissionArray = nullptr;
+    uint32_t submissionCapacity = 0;
+    uint32_t unsubmitted = 0;
+
+    uint32_t* completionHead = nullptr;
+    uint32_t* completionTail = nullptr;
+    uint32_t completionMask = 0;
+    io_uring_cqe* completionEntries = nullptr;
+
+    io_uring_sqe* acquireEntry();
+    void release();
+  };
+}
+
+#endif
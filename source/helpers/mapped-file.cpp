@@ -0,0 +1,114 @@
+#include "mapped-file.hpp"
+#include <system_error>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace MdlParser {
+#ifdef _WIN32
+  MappedFile::MappedFile(const std::filesystem::path& path) {
+    const auto fail = [&](const char* message) {
+      const auto error = static_cast<int>(GetLastError());
+      release();
+      throw std::system_error(error, std::system_category(), message + path.string());
+    };
+
+    fileHandle = CreateFileW(
+      path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr
+    );
+    if (fileHandle == INVALID_HANDLE_VALUE) {
+      fileHandle = nullptr;
+      fail("Failed to open ");
+    }
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(fileHandle, &fileSize)) {
+      fail("Failed to get size of ");
+    }
+
+    size = static_cast<size_t>(fileSize.QuadPart);
+    if (size == 0) {
+      return;
+    }
+
+    mappingHandle = CreateFileMappingW(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mappingHandle == nullptr) {
+      fail("Failed to create mapping of ");
+    }
+
+    data = static_cast<const std::byte*>(MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0));
+    if (data == nullptr) {
+      fail("Failed to map ");
+    }
+  }
+
+  MappedFile::~MappedFile() {
+    release();
+  }
+
+  void MappedFile::release() {
+    if (data != nullptr) {
+      UnmapViewOfFile(data);
+    }
+    if (mappingHandle != nullptr) {
+      CloseHandle(mappingHandle);
+    }
+    if (fileHandle != nullptr) {
+      CloseHandle(fileHandle);
+    }
+
+    data = nullptr;
+    mappingHandle = nullptr;
+    fileHandle = nullptr;
+  }
+#else
+  MappedFile::MappedFile(const std::filesystem::path& path) {
+    const auto fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+      throw std::system_error(errno, std::system_category(), "Failed to open " + path.string());
+    }
+
+    struct stat fileStats {};
+    if (fstat(fd, &fileStats) != 0) {
+      const auto error = errno;
+      close(fd);
+      throw std::system_error(error, std::system_category(), "Failed to get size of " + path.string());
+    }
+
+    size = static_cast<size_t>(fileStats.st_size);
+    if (size == 0) {
+      close(fd);
+      return;
+    }
+
+    void* mapped = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    const auto error = errno;
+    close(fd);
+
+    if (mapped == MAP_FAILED) {
+      throw std::system_error(error, std::system_category(), "Failed to map " + path.string());
+    }
+
+    data = static_cast<const std::byte*>(mapped);
+  }
+
+  MappedFile::~MappedFile() {
+    if (data != nullptr) {
+      munmap(const_cast<std::byte*>(data), size);
+    }
+  }
+#endif
+
+  std::span<const std::byte> MappedFile::getData() const {
+    return {data, size};
+  }
+}
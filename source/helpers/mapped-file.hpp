@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+#include <span>
+
+namespace MdlParser {
+  /**
+   * Read-only memory mapping of an entire file, unmapped on destruction.
+   */
+  class MappedFile {
+  public:
+    /**
+     * Maps the file at path into memory.
+     * @throws std::system_error if the file could not be opened or mapped.
+     */
+    explicit MappedFile(const std::filesystem::path& path);
+
+    ~MappedFile();
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile(MappedFile&&) = delete;
+    MappedFile& operator=(MappedFile&&) = delete;
+
+    [[nodiscard]] std::span<const std::byte> getData() const;
+
+  private:
+    const std::byte* data = nullptr;
+    size_t size = 0;
+
+#ifdef _WIN32
+    void* fileHandle = nullptr;
+    void* mappingHandle = nullptr;
+
+    void release();
+#endif
+  };
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <cstdint>
+#include "../errors.hpp"
+#include "../mdl.hpp"
+
+namespace MdlParser {
+  /**
+   * Checks a mesh's vertices lie within its model's. The offsets and counts come straight from the file, so they are
+   * checked for being negative and added in 64 bits rather than risking signed overflow.
+   * @throws Errors::OutOfBoundsAccess if the mesh's vertex range is negative or extends past its model.
+   */
+  inline void checkMeshVertexRange(const Mdl::Model& model, const Mdl::Mesh& mesh) {
+    if (
+      mesh.vertexOffset < 0 || mesh.vertexCount < 0 ||
+      static_cast<int64_t>(mesh.vertexOffset) + mesh.vertexCount > model.vertexCount
+    ) {
+      throw Errors::OutOfBoundsAccess("MDL mesh vertex range is outside its model");
+    }
+  }
+}
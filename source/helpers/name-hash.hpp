@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+
+namespace MdlParser {
+  [[nodiscard]] constexpr char toLowerAscii(const char character) {
+    return character >= 'A' && character <= 'Z' ? static_cast<char>(character - 'A' + 'a') : character;
+  }
+
+  /**
+   * Hashes a name case-insensitively (ASCII only, as names in models are compared with stricmp by the engine).
+   * @remarks This is 32 bit FNV-1a over the lowercased characters, so is cheap for the short names found in models.
+   */
+  [[nodiscard]] constexpr uint32_t getNameHash(const std::string_view name, uint32_t hash = 0x811c9dc5) {
+    for (const auto character : name) {
+      hash ^= static_cast<uint8_t>(toLowerAscii(character));
+      hash *= 0x01000193;
+    }
+
+    return hash;
+  }
+
+  [[nodiscard]] constexpr bool isNameEqual(const std::string_view a, const std::string_view b) {
+    if (a.size() != b.size()) {
+      return false;
+    }
+
+    for (size_t i = 0; i < a.size(); i++) {
+      if (toLowerAscii(a[i]) != toLowerAscii(b[i])) {
+        return false;
+      }
+    }
+
+    return true;
+  }
+}
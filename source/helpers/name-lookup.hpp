@@ -0,0 +1,64 @@
+#pragma once
+
+#include <bit>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+#include <vector>
+#include "name-hash.hpp"
+
+namespace MdlParser {
+  /**
+   * Builds an open addressing hash table (sized to a power of two, at most half full) from names to their indices,
+   * with -1 marking empty slots. Where names are repeated, the first index with that name is kept.
+   * @param count Number of names.
+   * @param getName Returns the name at an index as a std::string_view.
+   */
+  template <typename GetName>
+  [[nodiscard]] std::vector<int32_t> buildNameLookup(const size_t count, const GetName& getName) {
+    if (count == 0) {
+      return {};
+    }
+
+    std::vector<int32_t> lookup(std::bit_ceil(count * 2), -1);
+    const auto mask = lookup.size() - 1;
+
+    for (size_t i = 0; i < count; i++) {
+      const std::string_view name = getName(i);
+      auto slot = getNameHash(name) & mask;
+
+      while (lookup[slot] != -1 && !isNameEqual(getName(lookup[slot]), name)) {
+        slot = (slot + 1) & mask;
+      }
+      if (lookup[slot] == -1) {
+        lookup[slot] = static_cast<int32_t>(i);
+      }
+    }
+
+    return lookup;
+  }
+
+  /**
+   * Finds a name (ignoring case) in a table built by buildNameLookup, without allocating.
+   * @return The index the name was stored with, or nullopt if it is not in the table.
+   */
+  template <typename GetName>
+  [[nodiscard]] std::optional<size_t> findInNameLookup(
+    const std::vector<int32_t>& lookup,
+    const std::string_view name,
+    const GetName& getName
+  ) {
+    if (lookup.empty()) {
+      return std::nullopt;
+    }
+
+    const auto mask = lookup.size() - 1;
+    for (auto slot = getNameHash(name) & mask; lookup[slot] != -1; slot = (slot + 1) & mask) {
+      if (isNameEqual(getName(lookup[slot]), name)) {
+        return lookup[slot];
+      }
+    }
+
+    return std::nullopt;
+  }
+}
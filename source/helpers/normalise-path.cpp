@@ -0,0 +1,23 @@
+#include "normalise-path.hpp"
+
+namespace MdlParser {
+  std::string getNormalisedPath(const std::string_view path) {
+    std::string normalised;
+    normalised.reserve(path.size());
+
+    for (const auto character : path) {
+      if (character == '\\') {
+        normalised.push_back('/');
+      } else if (character >= 'A' && character <= 'Z') {
+        normalised.push_back(static_cast<char>(character - 'A' + 'a'));
+      } else {
+        normalised.push_back(character);
+      }
+    }
+
+    const auto firstNonSlash = normalised.find_first_not_of('/');
+    normalised.erase(0, firstNonSlash == std::string::npos ? normalised.size() : firstNonSlash);
+
+    return normalised;
+  }
+}
@@ -0,0 +1,11 @@
+#pragma once
+#include <string>
+#include <string_view>
+
+namespace MdlParser {
+  /**
+   * Normalises a game path for use as a lookup key, lowercasing it, converting backslashes to forward slashes and
+   * stripping any leading slashes.
+   */
+  [[nodiscard]] std::string getNormalisedPath(std::string_view path);
+}
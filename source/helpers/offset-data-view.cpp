@@ -1,24 +1,62 @@
 #include "offset-data-view.hpp"
 
 namespace MdlParser {
-  OffsetDataView::OffsetDataView(const std::span<const std::byte> data) : data(data), offset(0) {}
+  OffsetDataView::OffsetDataView(const std::span<const std::byte> data, ParseStats* stats, const ParseLimits& limits)
+    : data(data),
+      offset(0),
+      stats(stats),
+      allocationBudget(limits.getAllocationBudget(data.size())),
+      remainingBudget(&allocationBudget) {}
 
   OffsetDataView::OffsetDataView(const OffsetDataView& from, const size_t newOffset)
-    : data(from.data), offset(newOffset) {}
+    : data(from.data),
+      offset(newOffset),
+      stats(from.stats),
+      allocationBudget(0),
+      remainingBudget(from.remainingBudget) {}
 
   OffsetDataView OffsetDataView::withOffset(const size_t newOffset) const {
     return OffsetDataView(*this, newOffset);
   }
 
-  std::string OffsetDataView::parseString(const size_t relativeOffset, const char* errorMessage) const {
+  Expected<void> OffsetDataView::allocate(const size_t bytes) const {
+    if (bytes > *remainingBudget) {
+      return makeError(Reason::AllocationLimitExceeded, offset, "Parse exceeded its allocation budget");
+    }
+
+    *remainingBudget -= bytes;
+    return {};
+  }
+
+  Expected<std::string> OffsetDataView::parseString(const size_t relativeOffset, const char* errorMessage) const {
     const auto absoluteOffset = offset + relativeOffset;
+#if MDLPARSER_PARSE_STATS
+    const auto start = stats ? ParseStats::Clock::now() : ParseStats::Clock::time_point{};
+#endif
 
     for (auto i = absoluteOffset; i < data.size(); i++) {
       if (data[i] == static_cast<std::byte>(0)) {
-        return reinterpret_cast<const char*>(&data[absoluteOffset]);
+        if (auto allocated = allocate(i - absoluteOffset + 1); !allocated) {
+          return std::unexpected(allocated.error());
+        }
+
+        std::string parsed(reinterpret_cast<const char*>(&data[absoluteOffset]), i - absoluteOffset);
+
+#if MDLPARSER_PARSE_STATS
+        if (stats) {
+          stats->addStringScan(parsed.size() + 1, ParseStats::Clock::now() - start);
+
+          // Short strings live inline and never touch the heap
+          if (parsed.size() > std::string().capacity()) {
+            recordAllocation(parsed.size() + 1);
+          }
+        }
+#endif
+
+        return parsed;
       }
     }
 
-    throw OutOfBoundsAccess(errorMessage);
+    return makeError(Reason::OutOfBoundsAccess, absoluteOffset, errorMessage);
   }
 }
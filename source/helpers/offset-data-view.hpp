@@ -1,8 +1,15 @@
 #pragma once
 
+#include <compare>
+#include <cstddef>
+#include <cstring>
+#include <iterator>
 #include <memory>
 #include <span>
+#include <utility>
 #include <vector>
+#include "../parse-limits.hpp"
+#include "../parse-stats.hpp"
 #include "check-bounds.hpp"
 
 namespace MdlParser {
@@ -11,7 +18,18 @@ namespace MdlParser {
     template<typename T>
     using ValueOffsetPair = std::pair<T, size_t>;
 
-    explicit OffsetDataView(std::span<const std::byte> data);
+    /**
+     * Creates a view over the whole of a file's data.
+     * The view owns the allocation budget that every view derived from it draws on.
+     * @param data
+     * @param stats Optional sink for statistics about the parse
+     * @param limits Limits on the memory the parse may allocate, scaled to the size of data
+     */
+    explicit OffsetDataView(
+      std::span<const std::byte> data,
+      ParseStats* stats = nullptr,
+      const ParseLimits& limits = {}
+    );
 
     explicit OffsetDataView(const OffsetDataView& from, const size_t newOffset);
 
@@ -23,51 +41,291 @@ namespace MdlParser {
 
     [[nodiscard]] OffsetDataView withOffset(size_t newOffset) const;
 
+    [[nodiscard]] ParseStats* getStats() const {
+      return stats;
+    }
+
     template<typename T>
-    [[nodiscard]] ValueOffsetPair<T> parseStruct(const size_t relativeOffset, const char* errorMessage) const {
+    [[nodiscard]] Expected<ValueOffsetPair<T>> parseStruct(
+      const size_t relativeOffset,
+      const char* errorMessage
+    ) const {
       const auto absoluteOffset = offset + relativeOffset;
-      checkBounds(absoluteOffset, sizeof(T), data.size(), errorMessage);
+      if (auto inBounds = checkBounds(absoluteOffset, sizeof(T), data.size(), errorMessage); !inBounds) {
+        return std::unexpected(inBounds.error());
+      }
+      recordBytesTouched(sizeof(T));
 
       return std::make_pair(*reinterpret_cast<const T*>(&data[absoluteOffset]), absoluteOffset);
     }
 
+    /**
+     * Lazy random-access range over an array of packed structs in the data, yielding each struct along with its
+     * absolute offset. Nothing is allocated, so the range must not outlive the data it views.
+     *
+     * Elements are copied out as they are dereferenced (as parseStruct does) rather than referenced, as the structs
+     * may be at any offset and references to their members would be misaligned.
+     */
+    template<typename T>
+    class StructRange {
+    public:
+      using Element = ValueOffsetPair<T>;
+
+      /**
+       * Models std::random_access_iterator, but only a Cpp17 input iterator as dereferencing returns a value.
+       */
+      class Iterator {
+      public:
+        using iterator_concept = std::random_access_iterator_tag;
+        using iterator_category = std::input_iterator_tag;
+        using value_type = Element;
+        using difference_type = std::ptrdiff_t;
+        using reference = Element;
+
+        Iterator() = default;
+
+        Iterator(const std::byte* first, const size_t firstOffset, const size_t index)
+          : first(first), firstOffset(firstOffset), index(index) {}
+
+        [[nodiscard]] reference operator*() const {
+          return { *reinterpret_cast<const T*>(first + sizeof(T) * index), firstOffset + sizeof(T) * index };
+        }
+
+        [[nodiscard]] reference operator[](const difference_type n) const {
+          return *(*this + n);
+        }
+
+        Iterator& operator++() {
+          index++;
+          return *this;
+        }
+
+        Iterator operator++(int) {
+          auto previous = *this;
+          index++;
+          return previous;
+        }
+
+        Iterator& operator--() {
+          index--;
+          return *this;
+        }
+
+        Iterator operator--(int) {
+          auto previous = *this;
+          index--;
+          return previous;
+        }
+
+        Iterator& operator+=(const difference_type n) {
+          index += n;
+          return *this;
+        }
+
+        Iterator& operator-=(const difference_type n) {
+          index -= n;
+          return *this;
+        }
+
+        [[nodiscard]] friend Iterator operator+(Iterator iterator, const difference_type n) {
+          return iterator += n;
+        }
+
+        [[nodiscard]] friend Iterator operator+(const difference_type n, Iterator iterator) {
+          return iterator += n;
+        }
+
+        [[nodiscard]] friend Iterator operator-(Iterator iterator, const difference_type n) {
+          return iterator -= n;
+        }
+
+        [[nodiscard]] friend difference_type operator-(const Iterator& a, const Iterator& b) {
+          return static_cast<difference_type>(a.index) - static_cast<difference_type>(b.index);
+        }
+
+        [[nodiscard]] bool operator==(const Iterator& other) const {
+          return index == other.index;
+        }
+
+        [[nodiscard]] auto operator<=>(const Iterator& other) const {
+          return index <=> other.index;
+        }
+
+      private:
+        const std::byte* first = nullptr;
+        size_t firstOffset = 0;
+        size_t index = 0;
+      };
+
+      StructRange() = default;
+
+      StructRange(const std::byte* first, const size_t firstOffset, const size_t count)
+        : first(first), firstOffset(firstOffset), count(count) {}
+
+      [[nodiscard]] Iterator begin() const {
+        return { first, firstOffset, 0 };
+      }
+
+      [[nodiscard]] Iterator end() const {
+        return { first, firstOffset, count };
+      }
+
+      [[nodiscard]] size_t size() const {
+        return count;
+      }
+
+      [[nodiscard]] bool empty() const {
+        return count == 0;
+      }
+
+      [[nodiscard]] Element operator[](const size_t index) const {
+        return begin()[static_cast<std::ptrdiff_t>(index)];
+      }
+
+    private:
+      const std::byte* first = nullptr;
+      size_t firstOffset = 0;
+      size_t count = 0;
+    };
+
+    /**
+     * Bounds checks an array of count structs without reading it, e.g. to check a whole table before reserving for it.
+     */
+    template<typename T>
+    [[nodiscard]] Expected<void> checkStructArray(
+      const size_t relativeOffset,
+      const size_t count,
+      const char* errorMessage
+    ) const {
+      return checkArrayBounds(offset + relativeOffset, count, sizeof(T), data.size(), errorMessage);
+    }
+
+    /**
+     * Bounds checks an array of count structs once, returning a lazy range over them rather than copying them out.
+     */
     template<typename T>
-    [[nodiscard]] std::vector<ValueOffsetPair<T>> parseStructArray(
+    [[nodiscard]] Expected<StructRange<T>> parseStructArray(
       const size_t relativeOffset,
       const size_t count,
       const char* errorMessage
     ) const {
       const auto absoluteOffset = offset + relativeOffset;
-      checkBounds(absoluteOffset, sizeof(T) * count, data.size(), errorMessage);
-
-      std::vector<ValueOffsetPair<T>> parsed;
-      parsed.reserve(count);
+      if (auto inBounds = checkArrayBounds(absoluteOffset, count, sizeof(T), data.size(), errorMessage); !inBounds) {
+        return std::unexpected(inBounds.error());
+      }
+      recordBytesTouched(sizeof(T) * count);
 
-      for (size_t i = 0; i < count; i++) {
-        const auto currentOffset = absoluteOffset + sizeof(T) * i;
-        parsed.emplace_back(*reinterpret_cast<const T*>(&data[currentOffset]), currentOffset);
+      // Empty arrays may have any offset, which must not be turned into a pointer
+      if (count == 0) {
+        return StructRange<T>();
       }
 
-      return std::move(parsed);
+      return StructRange<T>(&data[absoluteOffset], absoluteOffset, count);
     }
 
     template<typename T>
-    [[nodiscard]] std::vector<T> parseStructArrayWithoutOffsets(
+    [[nodiscard]] Expected<std::vector<T>> parseStructArrayWithoutOffsets(
       const size_t relativeOffset,
       const size_t count,
       const char* errorMessage
     ) const {
       const auto absoluteOffset = offset + relativeOffset;
-      checkBounds(absoluteOffset, sizeof(T) * count, data.size(), errorMessage);
+      if (auto inBounds = checkArrayBounds(absoluteOffset, count, sizeof(T), data.size(), errorMessage); !inBounds) {
+        return std::unexpected(inBounds.error());
+      }
+      recordBytesTouched(sizeof(T) * count);
+
+      if (auto allocated = allocate(sizeof(T) * count); !allocated) {
+        return std::unexpected(allocated.error());
+      }
+      recordAllocation(sizeof(T) * count);
 
       const T* first = reinterpret_cast<const T*>(&data[absoluteOffset]);
       return std::vector(first, first + count);
     }
 
-    std::string parseString(size_t relativeOffset, const char* errorMessage) const;
+    /**
+     * Copies an array of destination.size() elements into destination, for storage the caller has already allocated.
+     */
+    template<typename T>
+    [[nodiscard]] Expected<void> copyStructArray(
+      const size_t relativeOffset,
+      const std::span<T> destination,
+      const char* errorMessage
+    ) const {
+      if (destination.empty()) {
+        return {};
+      }
+
+      const auto absoluteOffset = offset + relativeOffset;
+      const auto count = destination.size();
+      if (auto inBounds = checkArrayBounds(absoluteOffset, count, sizeof(T), data.size(), errorMessage); !inBounds) {
+        return std::unexpected(inBounds.error());
+      }
+      recordBytesTouched(destination.size_bytes());
+
+      std::memcpy(destination.data(), &data[absoluteOffset], destination.size_bytes());
+      return {};
+    }
+
+    [[nodiscard]] Expected<std::string> parseString(size_t relativeOffset, const char* errorMessage) const;
+
+    /**
+     * Reserves space for count elements in a vector being populated from this data, charging the allocation budget.
+     * @remarks count must already have been checked against the data it is read from, this only guards the total.
+     * @return Nothing, or an AllocationLimitExceeded error (leaving the vector untouched) if the budget is exhausted.
+     */
+    template<typename T, typename Allocator>
+    [[nodiscard]] Expected<void> reserve(std::vector<T, Allocator>& vector, const size_t count) const {
+      if (count == 0) {
+        return {};
+      }
+      if (count > *remainingBudget / sizeof(T)) {
+        return makeError(Reason::AllocationLimitExceeded, offset, "Parse exceeded its allocation budget");
+      }
+
+      vector.reserve(count);
+      *remainingBudget -= sizeof(T) * count;
+      recordAllocation(sizeof(T) * count);
+      return {};
+    }
+
+    /**
+     * Charges bytes allocated outside of reserve() (such as strings) to the allocation budget.
+     * @return Nothing, or an AllocationLimitExceeded error if the budget is exhausted.
+     */
+    [[nodiscard]] Expected<void> allocate(size_t bytes) const;
 
   private:
     std::span<const std::byte> data;
     const size_t offset;
+    ParseStats* stats;
+
+    /**
+     * Bytes left in the budget, used when this is the view the parse started from.
+     * Mutable so that parsing through a const root view can still charge it.
+     */
+    mutable size_t allocationBudget;
+
+    /**
+     * The budget shared by every view derived from the same root view.
+     */
+    size_t* remainingBudget;
+
+    void recordBytesTouched([[maybe_unused]] const size_t bytes) const {
+#if MDLPARSER_PARSE_STATS
+      if (stats) {
+        stats->addBytesTouched(bytes);
+      }
+#endif
+    }
+
+    void recordAllocation([[maybe_unused]] const size_t bytes) const {
+#if MDLPARSER_PARSE_STATS
+      if (stats && bytes > 0) {
+        stats->addAllocation(bytes);
+      }
+#endif
+    }
   };
 }
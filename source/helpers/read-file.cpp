@@ -0,0 +1,24 @@
+#include "read-file.hpp"
+#include <fstream>
+#include <system_error>
+
+namespace MdlParser {
+  std::vector<std::byte> readFile(const std::filesystem::path& path) {
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file) {
+      throw std::system_error(
+        std::make_error_code(std::errc::no_such_file_or_directory), "Failed to open " + path.string()
+      );
+    }
+
+    const auto size = static_cast<size_t>(file.tellg());
+    std::vector<std::byte> data(size);
+
+    file.seekg(0);
+    if (!file.read(reinterpret_cast<char*>(data.data()), static_cast<std::streamsize>(size))) {
+      throw std::system_error(std::make_error_code(std::errc::io_error), "Failed to read " + path.string());
+    }
+
+    return data;
+  }
+}
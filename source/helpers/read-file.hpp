@@ -0,0 +1,12 @@
+#pragma once
+#include <cstddef>
+#include <filesystem>
+#include <vector>
+
+namespace MdlParser {
+  /**
+   * Reads the whole of a file into memory.
+   * @throws std::system_error if the file could not be opened or read.
+   */
+  [[nodiscard]] std::vector<std::byte> readFile(const std::filesystem::path& path);
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include "../parse-stats.hpp"
+
+namespace MdlParser {
+  /**
+   * RAII helper which records a section in a ParseStats for the lifetime of the scope.
+   * Does nothing if no stats sink was given, and compiles away entirely when MDLPARSER_PARSE_STATS is 0.
+   */
+  class StatsScope {
+  public:
+#if MDLPARSER_PARSE_STATS
+    StatsScope(ParseStats* stats, const char* name) : stats(stats), index(stats ? stats->beginSection(name) : 0) {}
+
+    ~StatsScope() {
+      if (stats) {
+        stats->endSection(index);
+      }
+    }
+
+    void addElements(const size_t count) const {
+      if (stats) {
+        stats->addElements(count);
+      }
+    }
+#else
+    StatsScope(ParseStats*, const char*) {}
+
+    void addElements(size_t) const {}
+#endif
+
+    StatsScope(const StatsScope&) = delete;
+    StatsScope& operator=(const StatsScope&) = delete;
+    StatsScope(StatsScope&&) = delete;
+    StatsScope& operator=(StatsScope&&) = delete;
+
+  private:
+#if MDLPARSER_PARSE_STATS
+    ParseStats* stats;
+    size_t index;
+#endif
+  };
+}
@@ -0,0 +1,57 @@
+#include "thread-pool.hpp"
+#include <algorithm>
+
+namespace MdlParser {
+  ThreadPool::ThreadPool(const size_t threadCount) {
+    const auto count = std::max<size_t>(threadCount, 1);
+
+    workers.reserve(count);
+    for (size_t i = 0; i < count; i++) {
+      workers.emplace_back([this] { runWorker(); });
+    }
+  }
+
+  ThreadPool::~ThreadPool() {
+    {
+      std::scoped_lock lock(mutex);
+      stopping = true;
+    }
+    jobAvailable.notify_all();
+
+    for (auto& worker : workers) {
+      worker.join();
+    }
+  }
+
+  void ThreadPool::enqueue(std::function<void()> job) {
+    {
+      std::scoped_lock lock(mutex);
+      jobs.push(std::move(job));
+    }
+    jobAvailable.notify_one();
+  }
+
+  size_t ThreadPool::getThreadCount() const {
+    return workers.size();
+  }
+
+  void ThreadPool::runWorker() {
+    while (true) {
+      std::function<void()> job;
+
+      {
+        std::unique_lock lock(mutex);
+        jobAvailable.wait(lock, [this] { return stopping || !jobs.empty(); });
+
+        if (jobs.empty()) {
+          return;
+        }
+
+        job = std::move(jobs.front());
+        jobs.pop();
+      }
+
+      job();
+    }
+  }
+}
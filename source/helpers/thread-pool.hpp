@@ -0,0 +1,39 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+namespace MdlParser {
+  /**
+   * Minimal fixed-size pool of worker threads consuming jobs from a shared FIFO queue.
+   * Jobs still queued when the pool is destroyed are run to completion before the workers are joined.
+   */
+  class ThreadPool {
+  public:
+    explicit ThreadPool(size_t threadCount);
+
+    ~ThreadPool();
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+    ThreadPool(ThreadPool&&) = delete;
+    ThreadPool& operator=(ThreadPool&&) = delete;
+
+    void enqueue(std::function<void()> job);
+
+    [[nodiscard]] size_t getThreadCount() const;
+
+  private:
+    std::vector<std::thread> workers;
+    std::queue<std::function<void()>> jobs;
+    std::mutex mutex;
+    std::condition_variable jobAvailable;
+    bool stopping = false;
+
+    void runWorker();
+  };
+}
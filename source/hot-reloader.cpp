@@ -0,0 +1,288 @@
+#include "hot-reloader.hpp"
+
+#ifdef MDLPARSER_HAS_INOTIFY
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <iterator>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <system_error>
+#include <unistd.h>
+#include "helpers/read-file.hpp"
+
+namespace MdlParser {
+  namespace {
+    constexpr uint32_t WATCH_MASK = IN_MODIFY | IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE;
+
+    struct FileState {
+      std::uintmax_t size;
+      std::filesystem::file_time_type writeTime;
+
+      bool operator==(const FileState&) const = default;
+    };
+
+    std::array<FileState, 3> getFileStates(const ModelPaths& paths) {
+      const auto getState = [](const std::filesystem::path& path) {
+        return FileState{
+          .size = std::filesystem::file_size(path),
+          .writeTime = std::filesystem::last_write_time(path),
+        };
+      };
+
+      return {getState(paths.mdl), getState(paths.vtx), getState(paths.vvd)};
+    }
+  }
+
+  HotReloader::WatchedModel::WatchedModel(ModelPaths paths) : paths(std::move(paths)) {}
+
+  static_assert(std::atomic<const ModelTriple*>::is_always_lock_free, "Reading a watched model must not take a lock");
+
+  const ModelTriple& HotReloader::WatchedModel::get() const {
+    return *model.load(std::memory_order_acquire);
+  }
+
+  uint32_t HotReloader::WatchedModel::getGeneration() const {
+    return generation.load(std::memory_order_relaxed);
+  }
+
+  const ModelPaths& HotReloader::WatchedModel::getPaths() const {
+    return paths;
+  }
+
+  void HotReloader::WatchedModel::publish(ModelTriple&& version) {
+    const std::scoped_lock lock(versionsMutex);
+    const auto& published = versions.emplace_back(std::make_unique<const ModelTriple>(std::move(version)));
+    model.store(published.get(), std::memory_order_release);
+  }
+
+  HotReloader::HotReloader(const std::chrono::milliseconds settleDelay, Callback onReload)
+    : settleDelay(settleDelay), onReload(std::move(onReload)) {
+    inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (inotifyFd < 0) {
+      throw std::system_error(errno, std::system_category(), "Failed to create inotify instance");
+    }
+
+    wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (wakeFd < 0) {
+      const auto error = errno;
+      close(inotifyFd);
+      throw std::system_error(error, std::system_category(), "Failed to create eventfd for hot reloader");
+    }
+
+    thread = std::thread([this] { run(); });
+  }
+
+  HotReloader::~HotReloader() {
+    stopping.store(true);
+
+    const uint64_t value = 1;
+    [[maybe_unused]] const auto written = write(wakeFd, &value, sizeof(value));
+    thread.join();
+
+    close(wakeFd);
+    close(inotifyFd);
+  }
+
+  std::shared_ptr<const HotReloader::WatchedModel> HotReloader::watch(const ModelPaths& paths) {
+    std::shared_ptr<WatchedModel> model(new WatchedModel(paths));
+
+    {
+      std::scoped_lock lock(mutex);
+      for (const auto* path : {&paths.mdl, &paths.vtx, &paths.vvd}) {
+        const auto directory = std::filesystem::absolute(*path).parent_path();
+
+        const auto watch = inotify_add_watch(inotifyFd, directory.c_str(), WATCH_MASK);
+        if (watch < 0) {
+          const auto error = errno;
+          unwatchLocked(*model);
+          throw std::system_error(error, std::system_category(), "Failed to watch " + directory.string());
+        }
+
+        auto& watched = directories[watch];
+        watched.path = directory;
+        watched.files[path->filename().string()].push_back(model);
+      }
+    }
+
+    // Files are watched before the first parse, so a change made while parsing still causes a reload
+    try {
+      const auto mdlData = readFile(paths.mdl);
+      const auto vtxData = readFile(paths.vtx);
+      const auto vvdData = readFile(paths.vvd);
+      model->publish(ModelTriple(mdlData, vtxData, vvdData));
+    } catch (...) {
+      unwatch(*model);
+      throw;
+    }
+
+    return model;
+  }
+
+  void HotReloader::unwatch(const WatchedModel& model) {
+    std::scoped_lock lock(mutex);
+    unwatchLocked(model);
+  }
+
+  void HotReloader::releaseOldVersions(const WatchedModel& model) {
+    const std::scoped_lock lock(model.versionsMutex);
+    if (model.versions.size() > 1) {
+      model.versions.erase(model.versions.begin(), std::prev(model.versions.end()));
+    }
+  }
+
+  void HotReloader::unwatchLocked(const WatchedModel& model) {
+    for (auto directory = directories.begin(); directory != directories.end();) {
+      auto& files = directory->second.files;
+      for (auto file = files.begin(); file != files.end();) {
+        std::erase_if(file->second, [&](const auto& watched) {
+          if (watched.get() != &model) {
+            return false;
+          }
+
+          // The watcher thread drops the model from pending once it sees it is no longer watched
+          watched->isWatched.store(false);
+          return true;
+        });
+        file = file->second.empty() ? files.erase(file) : std::next(file);
+      }
+
+      if (files.empty()) {
+        inotify_rm_watch(inotifyFd, directory->first);
+        directory = directories.erase(directory);
+      } else {
+        ++directory;
+      }
+    }
+  }
+
+  void HotReloader::run() {
+    std::array<pollfd, 2> descriptors{
+      pollfd{ .fd = inotifyFd, .events = POLLIN },
+      pollfd{ .fd = wakeFd, .events = POLLIN },
+    };
+
+    while (!stopping.load()) {
+      const auto now = std::chrono::steady_clock::now();
+
+      std::erase_if(pending, [](const auto& model) { return !model->isWatched.load(); });
+      const auto due = std::partition(pending.begin(), pending.end(), [&](const auto& model) {
+        return *model->reloadAt > now;
+      });
+
+      std::vector ready(std::make_move_iterator(due), std::make_move_iterator(pending.end()));
+      pending.erase(due, pending.end());
+
+      for (const auto& model : ready) {
+        model->reloadAt.reset();
+        reload(model);
+      }
+
+      auto timeout = -1;
+      if (!pending.empty()) {
+        const auto next = std::ranges::min(pending, {}, [](const auto& model) { return *model->reloadAt; })->reloadAt;
+        const auto remaining = std::chrono::ceil<std::chrono::milliseconds>(*next - std::chrono::steady_clock::now());
+        timeout = static_cast<int>(std::max<std::chrono::milliseconds::rep>(remaining.count(), 0));
+      }
+
+      if (poll(descriptors.data(), descriptors.size(), timeout) < 0) {
+        continue;
+      }
+
+      if (descriptors[0].revents & POLLIN) {
+        readEvents();
+      }
+    }
+  }
+
+  void HotReloader::readEvents() {
+    alignas(inotify_event) std::array<char, 4096> buffer{};
+    const auto reloadAt = std::chrono::steady_clock::now() + settleDelay;
+
+    const auto schedule = [&](const std::shared_ptr<WatchedModel>& model) {
+      if (!model->reloadAt) {
+        pending.push_back(model);
+      }
+
+      // Every change pushes the reload back, so files still being written are not read until they settle
+      model->reloadAt = reloadAt;
+    };
+
+    std::scoped_lock lock(mutex);
+    while (true) {
+      const auto bytesRead = read(inotifyFd, buffer.data(), buffer.size());
+      if (bytesRead <= 0) {
+        return;
+      }
+
+      for (auto offset = 0; offset < bytesRead;) {
+        const auto* event = reinterpret_cast<const inotify_event*>(buffer.data() + offset);
+        offset += static_cast<int>(sizeof(inotify_event) + event->len);
+
+        if (event->mask & IN_Q_OVERFLOW) {
+          // Events were lost, so any model could have changed
+          for (const auto& [watch, directory] : directories) {
+            for (const auto& [name, models] : directory.files) {
+              std::ranges::for_each(models, schedule);
+            }
+          }
+
+          continue;
+        }
+
+        const auto directory = directories.find(event->wd);
+        if (event->len == 0 || directory == directories.end()) {
+          continue;
+        }
+
+        const auto file = directory->second.files.find(event->name);
+        if (file != directory->second.files.end()) {
+          std::ranges::for_each(file->second, schedule);
+        }
+      }
+    }
+  }
+
+  void HotReloader::reload(const std::shared_ptr<WatchedModel>& watched) {
+    auto& model = *watched;
+
+    try {
+      const auto before = getFileStates(model.paths);
+      const auto mdlData = readFile(model.paths.mdl);
+      const auto vtxData = readFile(model.paths.vtx);
+      const auto vvdData = readFile(model.paths.vvd);
+
+      if (getFileStates(model.paths) != before) {
+        // Written to while being read, so wait for the change to settle and try again
+        model.reloadAt = std::chrono::steady_clock::now() + settleDelay;
+        pending.push_back(watched);
+        return;
+      }
+
+      auto parsed = ModelTriple::tryParse(mdlData, vtxData, vvdData);
+      if (!parsed) {
+        if (parsed.error().reason == Errors::Reason::InvalidChecksum) {
+          // Some of the files have not been rewritten yet, and will trigger another reload once they are
+          return;
+        }
+
+        Errors::throwError(parsed.error());
+      }
+
+      model.publish(std::move(*parsed));
+      model.generation.fetch_add(1, std::memory_order_relaxed);
+
+      if (onReload) {
+        onReload(model, nullptr);
+      }
+    } catch (...) {
+      if (onReload) {
+        onReload(model, std::current_exception());
+      }
+    }
+  }
+}
+
+#endif
@@ -0,0 +1,161 @@
+#pragma once
+
+#if defined(__linux__) && __has_include(<sys/inotify.h>)
+#define MDLPARSER_HAS_INOTIFY 1
+#endif
+
+#ifdef MDLPARSER_HAS_INOTIFY
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "model-triple.hpp"
+
+namespace MdlParser {
+  /**
+   * Watches the files of models with Linux inotify, re-parsing a model on a background thread whenever any of its three
+   * files change.
+   *
+   * A reload waits until none of the model's files have changed for a short settle delay, and is only published once
+   * the VTX and VVD checksums match the MDL's, so a model being written out one file at a time is never seen half
+   * updated. Readers get the latest version of a model with a single lock-free atomic load. Every version published is
+   * owned by its WatchedModel rather than reference counted by readers, so versions already read stay valid until the
+   * WatchedModel is destroyed or releaseOldVersions() is called.
+   */
+  class HotReloader {
+  public:
+    /**
+     * A model kept up to date with its files.
+     */
+    class WatchedModel {
+    public:
+      /**
+       * Gets the latest successfully parsed version of the model.
+       * @remarks The model stays valid until this WatchedModel is destroyed, or releaseOldVersions() is called after
+       * a newer version has been published.
+       */
+      [[nodiscard]] const ModelTriple& get() const;
+
+      /**
+       * Gets the number of times the model has been reloaded since it was first watched.
+       */
+      [[nodiscard]] uint32_t getGeneration() const;
+
+      [[nodiscard]] const ModelPaths& getPaths() const;
+
+    private:
+      friend class HotReloader;
+
+      explicit WatchedModel(ModelPaths paths);
+
+      ModelPaths paths;
+      std::atomic<const ModelTriple*> model = nullptr;
+      std::atomic<uint32_t> generation = 0;
+      std::atomic<bool> isWatched = true;
+
+      /**
+       * Every version of the model published so far, with the latest last, owned here so that get() never has to
+       * take a reference.
+       */
+      mutable std::mutex versionsMutex;
+      mutable std::vector<std::unique_ptr<const ModelTriple>> versions;
+
+      void publish(ModelTriple&& version);
+
+      /**
+       * When the model should next be reloaded, if any of its files have changed. Only used by the watcher thread.
+       */
+      std::optional<std::chrono::steady_clock::time_point> reloadAt;
+    };
+
+    /**
+     * Called on the watcher thread after each attempt to reload a model, with the error which prevented reloading it
+     * (in which case the previous version is kept), or null if the new version was published. Must not throw.
+     */
+    using Callback = std::function<void(const WatchedModel& model, std::exception_ptr error)>;
+
+    /**
+     * Starts the watcher thread.
+     * @param settleDelay How long a model's files must go unchanged before it is reloaded.
+     * @param onReload Optional function called after each reload attempt.
+     * @throws std::system_error if inotify is unavailable.
+     */
+    explicit HotReloader(
+      std::chrono::milliseconds settleDelay = std::chrono::milliseconds(100), Callback onReload = nullptr
+    );
+
+    /**
+     * Stops the watcher thread. Any WatchedModel still held keeps its latest version but is no longer updated.
+     */
+    ~HotReloader();
+
+    HotReloader(const HotReloader&) = delete;
+    HotReloader& operator=(const HotReloader&) = delete;
+    HotReloader(HotReloader&&) = delete;
+    HotReloader& operator=(HotReloader&&) = delete;
+
+    /**
+     * Parses a model and starts watching its files for changes.
+     * @param paths Paths to the model's files.
+     * @return The watched model, holding the version just parsed.
+     * @throws std::system_error if the files could not be read or the directories containing them watched.
+     * @throws Errors::Error if the model is malformed.
+     */
+    [[nodiscard]] std::shared_ptr<const WatchedModel> watch(const ModelPaths& paths);
+
+    /**
+     * Stops updating a watched model.
+     * @param model
+     */
+    void unwatch(const WatchedModel& model);
+
+    /**
+     * Frees every version of a watched model except the latest, which are otherwise kept until the model is destroyed.
+     * @remarks The caller must ensure nothing still uses an earlier version previously returned by WatchedModel::get().
+     * @param model
+     */
+    void releaseOldVersions(const WatchedModel& model);
+
+  private:
+    /**
+     * A watched directory, and the watched models with files in it (keyed by file name).
+     * Directories are watched rather than files so that files replaced by renaming over them are still seen.
+     */
+    struct Directory {
+      std::filesystem::path path;
+      std::unordered_map<std::string, std::vector<std::shared_ptr<WatchedModel>>> files;
+    };
+
+    std::chrono::milliseconds settleDelay;
+    Callback onReload;
+
+    int inotifyFd = -1;
+    int wakeFd = -1;
+    std::thread thread;
+    std::atomic<bool> stopping = false;
+
+    std::mutex mutex;
+    std::unordered_map<int, Directory> directories;
+
+    /**
+     * Models with changed files waiting to be reloaded. Only used by the watcher thread.
+     */
+    std::vector<std::shared_ptr<WatchedModel>> pending;
+
+    void run();
+    void readEvents();
+    void unwatchLocked(const WatchedModel& model);
+    void reload(const std::shared_ptr<WatchedModel>& watched);
+  };
+}
+
+#endif
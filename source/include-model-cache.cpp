@@ -0,0 +1,50 @@
+#include "include-model-cache.hpp"
+#include "helpers/normalise-path.hpp"
+
+namespace MdlParser {
+  IncludeModelCache::IncludeModelCache(Loader loader) : loader(std::move(loader)) {}
+
+  std::shared_ptr<const Mdl> IncludeModelCache::get(const std::string_view path) {
+    auto normalised = getNormalisedPath(path);
+
+    std::promise<std::shared_ptr<const Mdl>> promise;
+    std::shared_future<std::shared_ptr<const Mdl>> model;
+    bool isLoader = false;
+
+    {
+      std::scoped_lock lock(mutex);
+      auto [entry, inserted] = models.try_emplace(normalised);
+      if (inserted) {
+        entry->second = promise.get_future().share();
+        isLoader = true;
+      }
+
+      model = entry->second;
+    }
+
+    if (isLoader) {
+      try {
+        const auto data = loader(normalised);
+        promise.set_value(std::make_shared<const Mdl>(data));
+      } catch (...) {
+        {
+          std::scoped_lock lock(mutex);
+          models.erase(normalised);
+        }
+        promise.set_exception(std::current_exception());
+      }
+    }
+
+    return model.get();
+  }
+
+  size_t IncludeModelCache::getModelCount() const {
+    std::scoped_lock lock(mutex);
+    return models.size();
+  }
+
+  void IncludeModelCache::clear() {
+    std::scoped_lock lock(mutex);
+    models.clear();
+  }
+}
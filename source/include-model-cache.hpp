@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "mdl.hpp"
+
+namespace MdlParser {
+  /**
+   * Thread-safe cache of parsed included models (such as the shared _animations.mdl and _gestures.mdl files).
+   *
+   * Each path is loaded and parsed at most once, with the result shared by reference between every VirtualModel
+   * which includes it. Share a single cache between all models to keep only one copy of each include in memory.
+   */
+  class IncludeModelCache {
+  public:
+    /**
+     * Reads the raw contents of a .mdl file given its normalised path (e.g. models/humans/female_shared.mdl).
+     * Should throw if the file cannot be read.
+     */
+    using Loader = std::function<std::vector<std::byte>(const std::string& path)>;
+
+    /**
+     * Creates an empty cache.
+     * @param loader Function used to read included models which are not yet cached.
+     */
+    explicit IncludeModelCache(Loader loader);
+
+    /**
+     * Gets the parsed model at the given path, loading and parsing it if this is the first request for it.
+     * Concurrent requests for the same uncached path wait for a single load rather than each parsing it.
+     * @remarks Failed loads are not cached, so a later request for the same path will try again.
+     * @param path Path to the .mdl file. Case and slashes are normalised.
+     * @return The shared parsed model.
+     * @throws Errors::Error if the model is malformed, or any exception thrown by the loader.
+     */
+    [[nodiscard]] std::shared_ptr<const Mdl> get(std::string_view path);
+
+    /**
+     * Gets the number of models currently cached (or being loaded).
+     */
+    [[nodiscard]] size_t getModelCount() const;
+
+    /**
+     * Drops the cache's references to all models.
+     * Models still used by a VirtualModel remain alive until it is destroyed.
+     */
+    void clear();
+
+  private:
+    Loader loader;
+
+    mutable std::mutex mutex;
+    std::unordered_map<std::string, std::shared_future<std::shared_ptr<const Mdl>>> models;
+  };
+}
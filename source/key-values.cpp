@@ -0,0 +1,234 @@
+#include "key-values.hpp"
+#include "helpers/name-hash.hpp"
+
+namespace MdlParser {
+  using namespace Errors;
+
+  namespace {
+    enum class TokenType : uint8_t {
+      END,
+      STRING,
+      CONDITIONAL,
+      OPEN_BRACE,
+      CLOSE_BRACE,
+    };
+
+    struct Token {
+      TokenType type;
+      std::string_view text;
+      size_t offset;
+    };
+
+    /**
+     * Splits KeyValues text into tokens without copying it.
+     */
+    class Tokenizer {
+    public:
+      explicit Tokenizer(const std::string_view text) : text(text) {}
+
+      Expected<Token> next() {
+        skipWhitespaceAndComments();
+
+        if (position >= text.size()) {
+          return Token{ .type = TokenType::END, .offset = position };
+        }
+
+        const auto start = position;
+        switch (text[position]) {
+          case '{':
+            position++;
+            return Token{ .type = TokenType::OPEN_BRACE, .text = text.substr(start, 1), .offset = start };
+          case '}':
+            position++;
+            return Token{ .type = TokenType::CLOSE_BRACE, .text = text.substr(start, 1), .offset = start };
+          case '"': {
+            const auto closingQuote = text.find('"', start + 1);
+            if (closingQuote == std::string_view::npos) {
+              return makeError(Reason::InvalidBody, start, "KeyValues string is missing its closing quote");
+            }
+
+            position = closingQuote + 1;
+            return Token{
+              .type = TokenType::STRING,
+              .text = text.substr(start + 1, closingQuote - start - 1),
+              .offset = start,
+            };
+          }
+          default:
+            break;
+        }
+
+        while (position < text.size() && !isDelimiter(text[position])) {
+          position++;
+        }
+
+        const auto token = text.substr(start, position - start);
+        const auto isConditional = token.size() >= 2 && token.front() == '[' && token.back() == ']';
+
+        return Token{
+          .type = isConditional ? TokenType::CONDITIONAL : TokenType::STRING,
+          .text = token,
+          .offset = start,
+        };
+      }
+
+    private:
+      std::string_view text;
+      size_t position = 0;
+
+      static bool isWhitespace(const char character) {
+        return character == ' ' || character == '\t' || character == '\r' || character == '\n';
+      }
+
+      static bool isDelimiter(const char character) {
+        return isWhitespace(character) || character == '"' || character == '{' || character == '}';
+      }
+
+      void skipWhitespaceAndComments() {
+        while (position < text.size()) {
+          if (isWhitespace(text[position])) {
+            position++;
+          } else if (text.substr(position, 2) == "//") {
+            const auto lineEnd = text.find('\n', position);
+            position = lineEnd == std::string_view::npos ? text.size() : lineEnd + 1;
+          } else {
+            return;
+          }
+        }
+      }
+    };
+  }
+
+  KeyValues::KeyValues(const std::string_view text) {
+    valueOrThrow(tryLoad(text));
+  }
+
+  Expected<void> KeyValues::tryLoad(const std::string_view text) {
+    entries.clear();
+    entries.push_back({ .keyHash = getNameHash({}), .isBlock = true });
+
+    // While a block is open, its end holds the index of its parent, so no separate stack is needed
+    uint32_t openBlock = 0;
+    Tokenizer tokenizer(text);
+
+    auto token = tokenizer.next();
+    while (true) {
+      if (!token) {
+        return std::unexpected(token.error());
+      }
+
+      if (token->type == TokenType::END) {
+        if (openBlock != 0) {
+          return makeError(Reason::InvalidBody, token->offset, "KeyValues block is missing its closing brace");
+        }
+
+        break;
+      }
+
+      if (token->type == TokenType::CLOSE_BRACE) {
+        if (openBlock == 0) {
+          return makeError(Reason::InvalidBody, token->offset, "KeyValues has an unmatched closing brace");
+        }
+
+        const auto parent = entries[openBlock].end;
+        entries[openBlock].end = static_cast<uint32_t>(entries.size());
+        openBlock = parent;
+
+        token = tokenizer.next();
+        continue;
+      }
+
+      if (token->type != TokenType::STRING) {
+        return makeError(Reason::InvalidBody, token->offset, "KeyValues expected a key");
+      }
+
+      const auto key = token->text;
+      const auto keyOffset = token->offset;
+
+      auto value = tokenizer.next();
+      if (!value) {
+        return std::unexpected(value.error());
+      }
+
+      const auto index = static_cast<uint32_t>(entries.size());
+      if (value->type == TokenType::OPEN_BRACE) {
+        entries.push_back({ .key = key, .keyHash = getNameHash(key), .end = openBlock, .isBlock = true });
+        openBlock = index;
+      } else if (value->type == TokenType::STRING) {
+        entries.push_back({ .key = key, .value = value->text, .keyHash = getNameHash(key), .end = index + 1 });
+      } else {
+        return makeError(Reason::InvalidBody, keyOffset, "KeyValues key is missing its value");
+      }
+
+      // Conditionals may follow a value or an opening brace, and are treated as always true
+      token = tokenizer.next();
+      if (token && token->type == TokenType::CONDITIONAL) {
+        token = tokenizer.next();
+      }
+    }
+
+    entries.front().end = static_cast<uint32_t>(entries.size());
+    return {};
+  }
+
+  KeyValues::Node KeyValues::getRoot() const {
+    return Node(this, 0);
+  }
+
+  std::string_view KeyValues::Node::getKey() const {
+    return keyValues->entries[index].key;
+  }
+
+  std::string_view KeyValues::Node::getValue() const {
+    return keyValues->entries[index].value;
+  }
+
+  bool KeyValues::Node::isBlock() const {
+    return keyValues->entries[index].isBlock;
+  }
+
+  std::optional<KeyValues::Node> KeyValues::Node::findChild(const std::string_view key) const {
+    const auto& entries = keyValues->entries;
+    const auto keyHash = getNameHash(key);
+
+    for (auto child = index + 1; child < entries[index].end; child = entries[child].end) {
+      if (entries[child].keyHash == keyHash && isNameEqual(entries[child].key, key)) {
+        return Node(keyValues, child);
+      }
+    }
+
+    return std::nullopt;
+  }
+
+  std::optional<std::string_view> KeyValues::Node::findValue(const std::string_view key) const {
+    const auto child = findChild(key);
+    if (!child) {
+      return std::nullopt;
+    }
+
+    return child->getValue();
+  }
+
+  KeyValues::ChildIterator KeyValues::Node::begin() const {
+    return {keyValues, index + 1};
+  }
+
+  KeyValues::ChildIterator KeyValues::Node::end() const {
+    return {keyValues, keyValues->entries[index].end};
+  }
+
+  KeyValues::Node KeyValues::ChildIterator::operator*() const {
+    return {keyValues, index};
+  }
+
+  KeyValues::ChildIterator& KeyValues::ChildIterator::operator++() {
+    index = keyValues->entries[index].end;
+    return *this;
+  }
+
+  KeyValues::ChildIterator KeyValues::ChildIterator::operator++(int) {
+    const auto previous = *this;
+    ++*this;
+    return previous;
+  }
+}
@@ -0,0 +1,128 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <optional>
+#include <string_view>
+#include <vector>
+#include "errors.hpp"
+
+namespace MdlParser {
+  /**
+   * Parses Valve KeyValues text (such as the $keyvalues block embedded in a model) into a tree of keys and values.
+   *
+   * Keys and values are views into the text, which must outlive the KeyValues. The tree is built in a single pass into
+   * one flat array of nodes, so reusing a KeyValues with tryLoad() parses further text without allocating.
+   * As in the engine's default behaviour, escape sequences in quoted strings are not processed and [$CONDITIONALS]
+   * are ignored.
+   */
+  class KeyValues {
+  public:
+    class Node;
+
+    /**
+     * Iterates over the direct children of a node.
+     */
+    class ChildIterator {
+    public:
+      using iterator_category = std::forward_iterator_tag;
+      using value_type = Node;
+      using difference_type = std::ptrdiff_t;
+
+      ChildIterator() = default;
+      ChildIterator(const KeyValues* keyValues, uint32_t index) : keyValues(keyValues), index(index) {}
+
+      [[nodiscard]] Node operator*() const;
+      ChildIterator& operator++();
+      ChildIterator operator++(int);
+      [[nodiscard]] bool operator==(const ChildIterator& other) const = default;
+
+    private:
+      const KeyValues* keyValues = nullptr;
+      uint32_t index = 0;
+    };
+
+    /**
+     * A key with either a value or a block of child keys.
+     */
+    class Node {
+    public:
+      Node(const KeyValues* keyValues, uint32_t index) : keyValues(keyValues), index(index) {}
+
+      [[nodiscard]] std::string_view getKey() const;
+
+      /**
+       * Gets the value of the key, or an empty string if it is a block.
+       */
+      [[nodiscard]] std::string_view getValue() const;
+
+      [[nodiscard]] bool isBlock() const;
+
+      /**
+       * Finds the first child with the given key, ignoring case as the engine does.
+       * @param key
+       * @return The child, or nullopt if this node has no child with that key.
+       */
+      [[nodiscard]] std::optional<Node> findChild(std::string_view key) const;
+
+      /**
+       * Gets the value of the first child with the given key, ignoring case.
+       * @param key
+       * @return The child's value, or nullopt if this node has no child with that key.
+       */
+      [[nodiscard]] std::optional<std::string_view> findValue(std::string_view key) const;
+
+      [[nodiscard]] ChildIterator begin() const;
+      [[nodiscard]] ChildIterator end() const;
+
+    private:
+      const KeyValues* keyValues;
+      uint32_t index;
+    };
+
+    KeyValues() = default;
+
+    /**
+     * Parses KeyValues text.
+     * @param text The text to parse, which must outlive the KeyValues.
+     * @throws Errors::InvalidBody if the text is malformed.
+     */
+    explicit KeyValues(std::string_view text);
+
+    /**
+     * Parses KeyValues text, replacing any previously loaded tree but reusing its storage.
+     * @param text The text to parse, which must outlive the KeyValues.
+     * @return Nothing, or the reason and offset into text that parsing failed at.
+     */
+    [[nodiscard]] Errors::Expected<void> tryLoad(std::string_view text);
+
+    /**
+     * Gets the unnamed root node, whose children are the top level keys (e.g. mdlkeyvalue).
+     */
+    [[nodiscard]] Node getRoot() const;
+
+  private:
+    struct Entry {
+      std::string_view key;
+      std::string_view value;
+
+      /**
+       * Case-insensitive hash of the key, compared before the key itself when searching for a child.
+       */
+      uint32_t keyHash;
+
+      /**
+       * Index one past this entry's last descendant, which is also the index of its next sibling.
+       */
+      uint32_t end;
+
+      bool isBlock;
+    };
+
+    /**
+     * Every node in the tree in depth first order, starting with the root.
+     */
+    std::vector<Entry> entries;
+  };
+}
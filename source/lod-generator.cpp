@@ -0,0 +1,565 @@
+#include "lod-generator.hpp"
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <exception>
+#include <limits>
+#include <numeric>
+#include <optional>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "errors.hpp"
+#include "helpers/thread-pool.hpp"
+
+namespace MdlParser {
+  namespace {
+    /**
+     * Total number of triangles to simplify (across all meshes and targets) below which threads are not worth starting.
+     */
+    constexpr size_t PARALLEL_TRIANGLE_THRESHOLD = 64 * 1024;
+
+    /**
+     * Upper bound on the number of collapse passes, in case constraints only allow a trickle of collapses per pass.
+     */
+    constexpr size_t MAX_PASSES = 256;
+
+    /**
+     * Collapses are rejected if they turn any triangle by more than about 75 degrees, which as well as flipped
+     * triangles catches those folded onto their side.
+     */
+    constexpr double MIN_NORMAL_COSINE = 0.25;
+
+    using Vector3 = std::array<double, 3>;
+
+    Vector3 toVector3(const Structs::Vector& vector) {
+      return {vector.x, vector.y, vector.z};
+    }
+
+    Vector3 subtract(const Vector3& a, const Vector3& b) {
+      return {a[0] - b[0], a[1] - b[1], a[2] - b[2]};
+    }
+
+    Vector3 cross(const Vector3& a, const Vector3& b) {
+      return {a[1] * b[2] - a[2] * b[1], a[2] * b[0] - a[0] * b[2], a[0] * b[1] - a[1] * b[0]};
+    }
+
+    double dot(const Vector3& a, const Vector3& b) {
+      return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+    }
+
+    /**
+     * Symmetric 4x4 matrix giving the sum of squared distances from a point to a set of planes.
+     */
+    struct Quadric {
+      double xx = 0, xy = 0, xz = 0, xw = 0;
+      double yy = 0, yz = 0, yw = 0;
+      double zz = 0, zw = 0;
+      double ww = 0;
+
+      static Quadric fromPlane(const Vector3& normal, const double distance, const double weight) {
+        const auto [a, b, c] = normal;
+        const auto d = distance;
+
+        return {
+          .xx = a * a * weight, .xy = a * b * weight, .xz = a * c * weight, .xw = a * d * weight,
+          .yy = b * b * weight, .yz = b * c * weight, .yw = b * d * weight,
+          .zz = c * c * weight, .zw = c * d * weight,
+          .ww = d * d * weight,
+        };
+      }
+
+      Quadric& operator+=(const Quadric& other) {
+        xx += other.xx, xy += other.xy, xz += other.xz, xw += other.xw;
+        yy += other.yy, yz += other.yz, yw += other.yw;
+        zz += other.zz, zw += other.zw;
+        ww += other.ww;
+        return *this;
+      }
+
+      [[nodiscard]] double evaluate(const Vector3& point) const {
+        const auto [x, y, z] = point;
+        return xx * x * x + 2 * xy * x * y + 2 * xz * x * z + 2 * xw * x + yy * y * y + 2 * yz * y * z + 2 * yw * y +
+          zz * z * z + 2 * zw * z + ww;
+      }
+    };
+
+    struct Collapse {
+      double cost;
+      uint32_t from;
+      uint32_t to;
+    };
+
+    /**
+     * Simplifies the triangles of a welded mesh by collapsing vertices onto their neighbours.
+     *
+     * Topology is tracked on vertices welded by position (positions), so that the separate vertices either side of a UV
+     * or normal seam are seen as one and the mesh is seen as connected across the seam. Each vertex of a position must
+     * move to a vertex it shares a triangle with, which keeps the seam intact.
+     */
+    class MeshSimplifier {
+    public:
+      MeshSimplifier(const WeldedMesh& mesh, const std::span<const Structs::Vvd::Vertex> meshVertices) {
+        const auto vertexCount = mesh.vertices.size();
+        positionOf.resize(vertexCount);
+        dominantBone.resize(vertexCount);
+
+        std::unordered_map<uint64_t, std::vector<uint32_t>> positionsByHash;
+        for (size_t vertex = 0; vertex < vertexCount; vertex++) {
+          const auto& vvdVertex = meshVertices[mesh.vertices[vertex]];
+          const Structs::Vector position = vvdVertex.pos;
+          const Structs::Vvd::BoneWeight boneWeights = vvdVertex.boneWeights;
+
+          // Adding zero folds -0 into +0 so the two weld together
+          const auto x = std::bit_cast<uint32_t>(position.x + 0.0F);
+          const auto y = std::bit_cast<uint32_t>(position.y + 0.0F);
+          const auto z = std::bit_cast<uint32_t>(position.z + 0.0F);
+          const auto hash = (static_cast<uint64_t>(x) * 73856093) ^ (static_cast<uint64_t>(y) * 19349663) ^
+            (static_cast<uint64_t>(z) * 83492791);
+
+          auto& candidates = positionsByHash[hash];
+          const auto existing = std::ranges::find_if(candidates, [&](const uint32_t candidate) {
+            const auto& other = positions[candidate];
+            return other[0] == position.x && other[1] == position.y && other[2] == position.z;
+          });
+
+          if (existing != candidates.end()) {
+            positionOf[vertex] = *existing;
+          } else {
+            positionOf[vertex] = static_cast<uint32_t>(positions.size());
+            candidates.push_back(positionOf[vertex]);
+            positions.push_back(toVector3(position));
+          }
+
+          dominantBone[vertex] = -1;
+          auto dominantWeight = 0.0F;
+          for (size_t influence = 0; influence < std::min<size_t>(boneWeights.numBones, boneWeights.bone.size());
+               influence++) {
+            if (boneWeights.weight[influence] > dominantWeight) {
+              dominantWeight = boneWeights.weight[influence];
+              dominantBone[vertex] = boneWeights.bone[influence];
+            }
+          }
+        }
+
+        // Triangles which are degenerate once welded by position have no area to preserve and are dropped up front
+        for (size_t index = 0; index + 2 < mesh.indices.size(); index += 3) {
+          const std::array<uint32_t, 3> corners{mesh.indices[index], mesh.indices[index + 1], mesh.indices[index + 2]};
+          const auto a = positionOf[corners[0]];
+          const auto b = positionOf[corners[1]];
+          const auto c = positionOf[corners[2]];
+
+          if (a != b && b != c && a != c) {
+            indices.insert(indices.end(), corners.begin(), corners.end());
+          }
+        }
+
+        quadrics.resize(positions.size());
+        for (size_t index = 0; index < indices.size(); index += 3) {
+          const auto& p0 = positions[positionOf[indices[index]]];
+          const auto& p1 = positions[positionOf[indices[index + 1]]];
+          const auto& p2 = positions[positionOf[indices[index + 2]]];
+          const auto normal = cross(subtract(p1, p0), subtract(p2, p0));
+
+          const auto length = std::sqrt(dot(normal, normal));
+          if (length == 0.0) {
+            continue;
+          }
+
+          const Vector3 unitNormal{normal[0] / length, normal[1] / length, normal[2] / length};
+          const auto plane = Quadric::fromPlane(unitNormal, -dot(unitNormal, p0), length * 0.5);
+
+          for (size_t corner = 0; corner < 3; corner++) {
+            quadrics[positionOf[indices[index + corner]]] += plane;
+          }
+        }
+      }
+
+      [[nodiscard]] size_t getTriangleCount() const {
+        return indices.size() / 3;
+      }
+
+      /**
+       * Simplifies the mesh until it has at most targetTriangleCount triangles, or no more collapses are possible.
+       * @return The remaining triangles, indexing into the welded mesh's vertices.
+       */
+      [[nodiscard]] std::vector<uint32_t> simplify(const size_t targetTriangleCount) const {
+        auto state = State{ .indices = indices, .quadrics = quadrics };
+        std::vector<uint32_t> remap(positionOf.size());
+
+        for (size_t pass = 0; pass < MAX_PASSES && state.indices.size() / 3 > targetTriangleCount; pass++) {
+          buildAdjacency(state);
+
+          // Positions on an open border or a non-manifold edge are kept, so the silhouette of open meshes survives
+          std::vector<Collapse> collapses;
+          for (const auto& [edge, uses] : state.edgeUses) {
+            const auto a = static_cast<uint32_t>(edge >> 32);
+            const auto b = static_cast<uint32_t>(edge);
+            if (uses != 2) {
+              state.locked[a] = true;
+              state.locked[b] = true;
+            }
+          }
+
+          for (const auto& [edge, uses] : state.edgeUses) {
+            const auto a = static_cast<uint32_t>(edge >> 32);
+            const auto b = static_cast<uint32_t>(edge);
+            if (!state.locked[a]) {
+              collapses.push_back({ .cost = state.quadrics[a].evaluate(positions[b]), .from = a, .to = b });
+            }
+            if (!state.locked[b]) {
+              collapses.push_back({ .cost = state.quadrics[b].evaluate(positions[a]), .from = b, .to = a });
+            }
+          }
+
+          std::ranges::sort(collapses, {}, &Collapse::cost);
+
+          // Collapses within a pass never touch the same triangles, so each can be checked against the current indices
+          std::iota(remap.begin(), remap.end(), 0);
+          std::vector<bool> touched(positions.size());
+          auto triangleCount = state.indices.size() / 3;
+          auto collapsed = false;
+
+          for (const auto& collapse : collapses) {
+            if (triangleCount <= targetTriangleCount) {
+              break;
+            }
+
+            if (touched[collapse.from] || touched[collapse.to] || !tryCollapse(state, collapse, remap)) {
+              continue;
+            }
+
+            collapsed = true;
+            state.quadrics[collapse.to] += state.quadrics[collapse.from];
+            touched[collapse.from] = true;
+            touched[collapse.to] = true;
+
+            for (const auto triangle : getTriangles(state, collapse.from)) {
+              auto containsTo = false;
+              for (size_t corner = 0; corner < 3; corner++) {
+                const auto position = positionOf[state.indices[triangle * 3 + corner]];
+                touched[position] = true;
+                containsTo = containsTo || position == collapse.to;
+              }
+
+              if (containsTo) {
+                triangleCount--;
+              }
+            }
+          }
+
+          if (!collapsed) {
+            break;
+          }
+
+          std::vector<uint32_t> remaining;
+          remaining.reserve(triangleCount * 3);
+          for (size_t index = 0; index < state.indices.size(); index += 3) {
+            const std::array<uint32_t, 3> corners{
+              remap[state.indices[index]], remap[state.indices[index + 1]], remap[state.indices[index + 2]]
+            };
+            const auto a = positionOf[corners[0]];
+            const auto b = positionOf[corners[1]];
+            const auto c = positionOf[corners[2]];
+
+            if (a != b && b != c && a != c) {
+              remaining.insert(remaining.end(), corners.begin(), corners.end());
+            }
+          }
+
+          state.indices = std::move(remaining);
+        }
+
+        return std::move(state.indices);
+      }
+
+    private:
+      /**
+       * Per simplification state, kept separate so that one simplifier can produce several levels of detail at once.
+       */
+      struct State {
+        std::vector<uint32_t> indices;
+        std::vector<Quadric> quadrics;
+
+        /**
+         * Triangles using each position, with the range for a position given by triangleOffsets.
+         */
+        std::vector<uint32_t> triangleOffsets;
+        std::vector<uint32_t> triangles;
+
+        /**
+         * Number of triangles using each edge between positions, keyed by the positions (lowest in the upper bits).
+         */
+        std::unordered_map<uint64_t, uint32_t> edgeUses;
+
+        std::vector<bool> locked;
+      };
+
+      /**
+       * The welded position of each vertex.
+       */
+      std::vector<uint32_t> positionOf;
+      std::vector<Vector3> positions;
+
+      /**
+       * The bone with the highest weight for each vertex, or -1 if it has no weights.
+       */
+      std::vector<int16_t> dominantBone;
+
+      /**
+       * The mesh's non-degenerate triangles.
+       */
+      std::vector<uint32_t> indices;
+
+      /**
+       * The error quadric of each position.
+       */
+      std::vector<Quadric> quadrics;
+
+      void buildAdjacency(State& state) const {
+        state.triangleOffsets.assign(positions.size() + 1, 0);
+        for (const auto vertex : state.indices) {
+          state.triangleOffsets[positionOf[vertex] + 1]++;
+        }
+        for (size_t position = 0; position < positions.size(); position++) {
+          state.triangleOffsets[position + 1] += state.triangleOffsets[position];
+        }
+
+        state.triangles.resize(state.indices.size());
+        auto cursors = state.triangleOffsets;
+        for (size_t index = 0; index < state.indices.size(); index++) {
+          state.triangles[cursors[positionOf[state.indices[index]]]++] = static_cast<uint32_t>(index / 3);
+        }
+
+        state.edgeUses.clear();
+        state.edgeUses.reserve(state.indices.size());
+        for (size_t index = 0; index < state.indices.size(); index += 3) {
+          for (size_t corner = 0; corner < 3; corner++) {
+            const auto a = positionOf[state.indices[index + corner]];
+            const auto b = positionOf[state.indices[index + (corner + 1) % 3]];
+            state.edgeUses[static_cast<uint64_t>(std::min(a, b)) << 32 | std::max(a, b)]++;
+          }
+        }
+
+        state.locked.assign(positions.size(), false);
+      }
+
+      [[nodiscard]] static std::span<const uint32_t> getTriangles(const State& state, const uint32_t position) {
+        const auto begin = state.triangleOffsets[position];
+        return std::span(state.triangles).subspan(begin, state.triangleOffsets[position + 1] - begin);
+      }
+
+      [[nodiscard]] std::vector<uint32_t> getNeighbours(const State& state, const uint32_t position) const {
+        std::vector<uint32_t> neighbours;
+        for (const auto triangle : getTriangles(state, position)) {
+          for (size_t corner = 0; corner < 3; corner++) {
+            const auto neighbour = positionOf[state.indices[triangle * 3 + corner]];
+            if (neighbour != position) {
+              neighbours.push_back(neighbour);
+            }
+          }
+        }
+
+        std::ranges::sort(neighbours);
+        neighbours.erase(std::ranges::unique(neighbours).begin(), neighbours.end());
+        return neighbours;
+      }
+
+      /**
+       * Checks whether a collapse keeps seams, bone boundaries and the mesh's topology intact without flipping any
+       * triangles, and if so records where each vertex of the collapsed position moves to in remap.
+       */
+      bool tryCollapse(const State& state, const Collapse& collapse, std::vector<uint32_t>& remap) const {
+        const auto triangles = getTriangles(state, collapse.from);
+
+        std::vector<std::pair<uint32_t, uint32_t>> moves;
+        for (const auto triangle : triangles) {
+          for (size_t corner = 0; corner < 3; corner++) {
+            const auto vertex = state.indices[triangle * 3 + corner];
+            const auto isMoved = std::ranges::any_of(moves, [&](const auto& move) { return move.first == vertex; });
+            if (positionOf[vertex] != collapse.from || isMoved) {
+              continue;
+            }
+
+            const auto target = findNeighbourAt(state, triangles, vertex, collapse.to);
+            if (!target || dominantBone[vertex] != dominantBone[*target]) {
+              return false;
+            }
+
+            moves.emplace_back(vertex, *target);
+          }
+        }
+
+        // Two positions sharing an interior edge must have exactly the two opposite corners as common neighbours,
+        // otherwise the collapse would fold the surface onto itself
+        const auto fromNeighbours = getNeighbours(state, collapse.from);
+        const auto toNeighbours = getNeighbours(state, collapse.to);
+        std::vector<uint32_t> commonNeighbours;
+        std::ranges::set_intersection(fromNeighbours, toNeighbours, std::back_inserter(commonNeighbours));
+        if (commonNeighbours.size() != 2) {
+          return false;
+        }
+
+        for (const auto triangle : triangles) {
+          std::array<Vector3, 3> before{};
+          std::array<Vector3, 3> after{};
+          auto containsTo = false;
+
+          for (size_t corner = 0; corner < 3; corner++) {
+            const auto position = positionOf[state.indices[triangle * 3 + corner]];
+            containsTo = containsTo || position == collapse.to;
+            before[corner] = positions[position];
+            after[corner] = positions[position == collapse.from ? collapse.to : position];
+          }
+
+          // Triangles along the collapsed edge disappear, so only the others can flip
+          if (containsTo) {
+            continue;
+          }
+
+          const auto normalBefore = cross(subtract(before[1], before[0]), subtract(before[2], before[0]));
+          const auto normalAfter = cross(subtract(after[1], after[0]), subtract(after[2], after[0]));
+          const auto lengths = std::sqrt(dot(normalBefore, normalBefore) * dot(normalAfter, normalAfter));
+          if (dot(normalBefore, normalAfter) <= MIN_NORMAL_COSINE * lengths) {
+            return false;
+          }
+        }
+
+        for (const auto& [vertex, target] : moves) {
+          remap[vertex] = target;
+        }
+
+        return true;
+      }
+
+      /**
+       * Finds a vertex at the given position which shares one of the triangles with vertex.
+       */
+      [[nodiscard]] std::optional<uint32_t> findNeighbourAt(
+        const State& state, const std::span<const uint32_t> triangles, const uint32_t vertex, const uint32_t position
+      ) const {
+        for (const auto triangle : triangles) {
+          const auto* corners = &state.indices[triangle * 3];
+          if (corners[0] != vertex && corners[1] != vertex && corners[2] != vertex) {
+            continue;
+          }
+
+          for (size_t corner = 0; corner < 3; corner++) {
+            if (positionOf[corners[corner]] == position) {
+              return corners[corner];
+            }
+          }
+        }
+
+        return std::nullopt;
+      }
+    };
+
+    WeldedMesh toWeldedMesh(
+      const WeldedMesh& source, const std::vector<uint32_t>& indices, const Enums::Vtx::StripGroupFlags flags
+    ) {
+      constexpr auto unassigned = std::numeric_limits<uint16_t>::max();
+      std::vector<uint16_t> newIndices(source.vertices.size(), unassigned);
+
+      WeldedMesh welded;
+      welded.indices.reserve(indices.size());
+      for (const auto index : indices) {
+        auto& newIndex = newIndices[index];
+        if (newIndex == unassigned) {
+          newIndex = static_cast<uint16_t>(welded.vertices.size());
+          welded.vertices.push_back(source.vertices[index]);
+        }
+
+        welded.indices.push_back(newIndex);
+      }
+
+      if (!welded.indices.empty()) {
+        welded.stripGroups.push_back(
+          { .indexOffset = 0, .indexCount = static_cast<uint32_t>(welded.indices.size()), .flags = flags }
+        );
+      }
+
+      return welded;
+    }
+  }
+
+  LodGeometry generateLods(
+    const Mdl::Model& mdlModel, const Vtx::Model& vtxModel, const Vvd& vvd, const std::span<const LodTarget> targets
+  ) {
+    if (vtxModel.levelOfDetails.empty()) {
+      throw Errors::OutOfBoundsAccess("VTX model has no levels of detail");
+    }
+
+    const auto& vtxMeshes = vtxModel.levelOfDetails.front().meshes;
+    if (vtxMeshes.size() != mdlModel.meshes.size()) {
+      throw Errors::OutOfBoundsAccess("VTX mesh count does not match MDL");
+    }
+
+    const auto& vertices = vvd.getVertices();
+    std::vector<std::vector<WeldedMesh>> weldedLods(1 + targets.size(), std::vector<WeldedMesh>(vtxMeshes.size()));
+    std::vector<MeshSimplifier> simplifiers;
+    size_t totalWork = 0;
+
+    for (size_t mesh = 0; mesh < vtxMeshes.size(); mesh++) {
+      const auto& mdlMesh = mdlModel.meshes[mesh];
+      const auto meshVertexOffset = static_cast<int64_t>(mdlModel.vertexOffset) + mdlMesh.vertexOffset;
+      if (mdlModel.vertexOffset < 0 || mdlMesh.vertexOffset < 0 || mdlMesh.vertexCount < 0 ||
+          static_cast<size_t>(meshVertexOffset + mdlMesh.vertexCount) > vertices.size()) {
+        throw Errors::OutOfBoundsAccess("MDL mesh vertex range is outside the VVD");
+      }
+
+      weldedLods[0][mesh] = weldMesh(mdlMesh, vtxMeshes[mesh]);
+      const auto meshVertices = std::span(vertices).subspan(meshVertexOffset, mdlMesh.vertexCount);
+
+      totalWork += simplifiers.emplace_back(weldedLods[0][mesh], meshVertices).getTriangleCount() * targets.size();
+    }
+
+    std::vector<std::exception_ptr> errors(simplifiers.size() * targets.size());
+    const auto simplify = [&](const size_t mesh, const size_t target) {
+      try {
+        const auto& source = weldedLods[0][mesh];
+        const auto& simplifier = simplifiers[mesh];
+        const auto ratio = std::clamp(targets[target].triangleRatio, 0.0F, 1.0F);
+        const auto triangleCount = static_cast<double>(simplifier.getTriangleCount());
+        const auto targetTriangleCount = static_cast<size_t>(triangleCount * ratio);
+        const auto flags =
+          source.stripGroups.empty() ? Enums::Vtx::StripGroupFlags::NONE : source.stripGroups.front().flags;
+
+        weldedLods[1 + target][mesh] = toWeldedMesh(source, simplifier.simplify(targetTriangleCount), flags);
+      } catch (...) {
+        errors[mesh * targets.size() + target] = std::current_exception();
+      }
+    };
+
+    const auto threadCount = std::min<size_t>(std::thread::hardware_concurrency(), errors.size());
+    if (totalWork >= PARALLEL_TRIANGLE_THRESHOLD && threadCount > 1) {
+      // The pool finishes every queued job before its destructor returns
+      ThreadPool pool(threadCount);
+      for (size_t mesh = 0; mesh < simplifiers.size(); mesh++) {
+        for (size_t target = 0; target < targets.size(); target++) {
+          pool.enqueue([&simplify, mesh, target] { simplify(mesh, target); });
+        }
+      }
+    } else {
+      for (size_t mesh = 0; mesh < simplifiers.size(); mesh++) {
+        for (size_t target = 0; target < targets.size(); target++) {
+          simplify(mesh, target);
+        }
+      }
+    }
+
+    for (const auto& error : errors) {
+      if (error) {
+        std::rethrow_exception(error);
+      }
+    }
+
+    std::vector<float> switchPoints{vtxModel.levelOfDetails.front().switchPoint};
+    for (const auto& target : targets) {
+      switchPoints.push_back(target.switchPoint);
+    }
+
+    return buildLodGeometry(mdlModel, weldedLods, switchPoints);
+  }
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <span>
+#include "lod-geometry.hpp"
+#include "mdl.hpp"
+#include "vtx.hpp"
+#include "vvd.hpp"
+
+namespace MdlParser {
+  /**
+   * Describes a level of detail to generate.
+   */
+  struct LodTarget {
+    /**
+     * Fraction of the highest level of detail's triangles to keep in each mesh, between 0 and 1.
+     */
+    float triangleRatio;
+
+    /**
+     * Distance at which to switch to this level of detail, as in Vtx::ModelLod.
+     */
+    float switchPoint;
+  };
+
+  /**
+   * Generates coarser levels of detail for a model by simplifying its highest level of detail with quadric error
+   * metrics, for models which ship with only one level of detail.
+   *
+   * Simplification collapses vertices onto their neighbours, so every generated level of detail only references
+   * vertices which already exist in the VVD and is returned in the same form as the model's real levels of detail.
+   * Vertices at a UV or normal seam only move along the seam together with their counterparts, vertices on open
+   * borders are kept, vertices are never collapsed onto a vertex with a different dominant bone, and collapses which
+   * would flip or fold over a triangle are rejected. A mesh may keep more triangles than requested if no more can be
+   * removed under these constraints. Large models are simplified on several threads, one mesh and target at a time.
+   * @param mdlModel Model in the MDL data.
+   * @param vtxModel The corresponding model in the VTX data, whose first level of detail is simplified.
+   * @param vvd The VVD the model's vertices are read from.
+   * @param targets The levels of detail to generate, from highest detail to lowest.
+   * @return Geometry with the model's first level of detail followed by one generated level per target.
+   * @throws Errors::OutOfBoundsAccess if the MDL and VTX meshes do not match, or refer to vertices outside the VVD.
+   */
+  [[nodiscard]] LodGeometry generateLods(
+    const Mdl::Model& mdlModel, const Vtx::Model& vtxModel, const Vvd& vvd, std::span<const LodTarget> targets
+  );
+}
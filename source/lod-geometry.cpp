@@ -0,0 +1,128 @@
+#include "lod-geometry.hpp"
+#include <algorithm>
+#include <limits>
+#include "errors.hpp"
+#include "helpers/mesh-vertex-range.hpp"
+
+namespace MdlParser {
+  LodGeometry buildLodGeometry(const Mdl::Model& mdlModel, const Vtx::Model& vtxModel) {
+    const auto lodCount = vtxModel.levelOfDetails.size();
+
+    std::vector<std::vector<WeldedMesh>> weldedLods(lodCount);
+    std::vector<float> switchPoints(lodCount);
+
+    for (size_t lod = 0; lod < lodCount; lod++) {
+      const auto& vtxMeshes = vtxModel.levelOfDetails[lod].meshes;
+      if (vtxMeshes.size() != mdlModel.meshes.size()) {
+        throw Errors::OutOfBoundsAccess("VTX mesh count does not match MDL");
+      }
+
+      for (size_t mesh = 0; mesh < vtxMeshes.size(); mesh++) {
+        weldedLods[lod].push_back(weldMesh(mdlModel.meshes[mesh], vtxMeshes[mesh]));
+      }
+
+      switchPoints[lod] = vtxModel.levelOfDetails[lod].switchPoint;
+    }
+
+    return buildLodGeometry(mdlModel, weldedLods, switchPoints);
+  }
+
+  LodGeometry buildLodGeometry(
+    const Mdl::Model& mdlModel,
+    const std::span<const std::vector<WeldedMesh>> weldedLods,
+    const std::span<const float> switchPoints
+  ) {
+    constexpr auto unassigned = std::numeric_limits<uint32_t>::max();
+    const auto lodCount = weldedLods.size();
+    if (switchPoints.size() != lodCount) {
+      throw Errors::OutOfBoundsAccess("Switch point count does not match level of detail count");
+    }
+
+    size_t modelVertexCount = 0;
+    for (const auto& weldedMeshes : weldedLods) {
+      if (weldedMeshes.size() != mdlModel.meshes.size()) {
+        throw Errors::OutOfBoundsAccess("Welded mesh count does not match MDL");
+      }
+
+      for (size_t mesh = 0; mesh < weldedMeshes.size(); mesh++) {
+        const auto& mdlMesh = mdlModel.meshes[mesh];
+        checkMeshVertexRange(mdlModel, mdlMesh);
+
+        const auto meshVertexCount = static_cast<size_t>(mdlMesh.vertexCount);
+        for (const auto vertex : weldedMeshes[mesh].vertices) {
+          if (vertex >= meshVertexCount) {
+            throw Errors::OutOfBoundsAccess("Welded vertex is outside its MDL mesh");
+          }
+        }
+
+        for (const auto index : weldedMeshes[mesh].indices) {
+          if (index >= weldedMeshes[mesh].vertices.size()) {
+            throw Errors::OutOfBoundsAccess("Welded index is outside its mesh");
+          }
+        }
+
+        if (!weldedMeshes[mesh].vertices.empty()) {
+          modelVertexCount = std::max(modelVertexCount, static_cast<size_t>(mdlMesh.vertexOffset) + meshVertexCount);
+        }
+      }
+    }
+
+    // Assign vertex buffer slots from the coarsest level of detail to the finest, so coarser levels use a prefix
+    std::vector<uint32_t> slots(modelVertexCount, unassigned);
+    LodGeometry geometry;
+    std::vector<uint32_t> lodVertexCounts(lodCount, 0);
+
+    for (auto lod = lodCount; lod-- > 0;) {
+      for (size_t mesh = 0; mesh < mdlModel.meshes.size(); mesh++) {
+        const auto meshVertexOffset = static_cast<uint32_t>(mdlModel.meshes[mesh].vertexOffset);
+
+        for (const auto meshVertex : weldedLods[lod][mesh].vertices) {
+          auto& slot = slots[meshVertexOffset + meshVertex];
+          if (slot == unassigned) {
+            slot = static_cast<uint32_t>(geometry.vertices.size());
+            geometry.vertices.push_back(meshVertexOffset + meshVertex);
+          }
+
+          lodVertexCounts[lod] = std::max(lodVertexCounts[lod], slot + 1);
+        }
+      }
+    }
+
+    for (size_t lod = 0; lod < lodCount; lod++) {
+      auto& geometryLod = geometry.levelOfDetails.emplace_back(
+        LodGeometry::Lod{
+          .indexOffset = static_cast<uint32_t>(geometry.indices.size()),
+          .vertexCount = lodVertexCounts[lod],
+          .switchPoint = switchPoints[lod],
+        }
+      );
+
+      for (size_t mesh = 0; mesh < mdlModel.meshes.size(); mesh++) {
+        const auto& welded = weldedLods[lod][mesh];
+        const auto meshVertexOffset = static_cast<uint32_t>(mdlModel.meshes[mesh].vertexOffset);
+        const auto meshIndexOffset = static_cast<uint32_t>(geometry.indices.size());
+
+        auto& geometryMesh = geometryLod.meshes.emplace_back(
+          LodGeometry::Mesh{
+            .indexOffset = meshIndexOffset,
+            .indexCount = static_cast<uint32_t>(welded.indices.size()),
+            .material = mdlModel.meshes[mesh].material,
+          }
+        );
+
+        for (auto stripGroup : welded.stripGroups) {
+          stripGroup.indexOffset += meshIndexOffset;
+          geometryMesh.stripGroups.push_back(stripGroup);
+        }
+
+        for (const auto index : welded.indices) {
+          geometry.indices.push_back(slots[meshVertexOffset + welded.vertices[index]]);
+        }
+      }
+
+      geometryLod.indexCount = static_cast<uint32_t>(geometry.indices.size()) - geometryLod.indexOffset;
+    }
+
+    return geometry;
+  }
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <vector>
+#include "mdl.hpp"
+#include "vtx.hpp"
+#include "welded-mesh.hpp"
+
+namespace MdlParser {
+  /**
+   * The geometry of every level of detail of a model, sharing a single vertex buffer.
+   *
+   * Vertices are ordered from the coarsest level of detail to the finest, so each level only needs a prefix of the
+   * vertex buffer (given by its vertexCount). When streaming, only that prefix has to be resident for the current level.
+   */
+  struct LodGeometry {
+    struct Mesh {
+      /**
+       * Offset of the mesh's first index in indices.
+       */
+      uint32_t indexOffset;
+
+      uint32_t indexCount;
+
+      /**
+       * Column of the skin lookup table to use for this mesh, as in Mdl::Mesh.
+       */
+      int32_t material;
+
+      /**
+       * The range of indices drawn by each of the mesh's strip groups, with offsets into indices.
+       */
+      std::vector<WeldedMesh::StripGroupRange> stripGroups;
+    };
+
+    struct Lod {
+      /**
+       * Offset of the level of detail's first index in indices.
+       */
+      uint32_t indexOffset;
+
+      uint32_t indexCount;
+
+      /**
+       * Number of vertices from the start of the vertex buffer which this level of detail references.
+       */
+      uint32_t vertexCount;
+
+      float switchPoint;
+
+      std::vector<Mesh> meshes;
+    };
+
+    /**
+     * Offsets into the model's vertices in the VVD (relative to Mdl::Model::vertexOffset) making up the vertex buffer.
+     */
+    std::vector<uint32_t> vertices;
+
+    /**
+     * The indices of every level of detail, indexing into vertices.
+     */
+    std::vector<uint32_t> indices;
+
+    std::vector<Lod> levelOfDetails;
+  };
+
+  /**
+   * Builds a single vertex buffer covering every level of detail of a model, with an index range for each level.
+   * @param mdlModel Model in the MDL data.
+   * @param vtxModel The corresponding model in the VTX data.
+   * @return The combined geometry.
+   * @throws Errors::OutOfBoundsAccess if the MDL and VTX meshes do not match, or refer to vertices outside the model.
+   */
+  [[nodiscard]] LodGeometry buildLodGeometry(const Mdl::Model& mdlModel, const Vtx::Model& vtxModel);
+
+  /**
+   * Builds a single vertex buffer covering every level of detail of a model from already welded meshes,
+   * such as simplified meshes.
+   * @param mdlModel Model in the MDL data.
+   * @param weldedLods The welded meshes of each level of detail, one per mesh in mdlModel.
+   * @param switchPoints The switch point of each level of detail.
+   * @return The combined geometry.
+   * @throws Errors::OutOfBoundsAccess if the mesh or switch point counts do not match, or the welded meshes refer to
+   * vertices outside the model.
+   */
+  [[nodiscard]] LodGeometry buildLodGeometry(
+    const Mdl::Model& mdlModel,
+    std::span<const std::vector<WeldedMesh>> weldedLods,
+    std::span<const float> switchPoints
+  );
+}
@@ -1,6 +1,15 @@
 #include "mdl.hpp"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+#include "helpers/heap-size.hpp"
+#include "helpers/name-hash.hpp"
+#include "helpers/name-lookup.hpp"
 #include "helpers/normalise-directory.hpp"
 #include "helpers/offset-data-view.hpp"
+#include "helpers/stats-scope.hpp"
 #include "structs/vvd.hpp"
 
 namespace MdlParser {
@@ -8,8 +17,6 @@ namespace MdlParser {
   using Structs::Mdl::Header2;
 
   namespace {
-    constexpr auto FILE_ID = u'I' + (u'D' << 8u) + (u'S' << 16u) + (u'T' << 24u);
-
     Mdl::Mesh parseMesh(const Structs::Mdl::Mesh& mesh) {
       return {
         .material = mesh.material,
@@ -18,19 +25,26 @@ namespace MdlParser {
       };
     }
 
-    Mdl::Model parseModel(const OffsetDataView& data, const Structs::Mdl::Model& model) {
+    Expected<Mdl::Model> parseModel(const OffsetDataView& data, const Structs::Mdl::Model& model) {
+      const auto parsedMeshes = data.parseStructArrayWithoutOffsets<Structs::Mdl::Mesh>(
+        model.meshesOffset,
+        model.meshesCount,
+        "Failed to parse MDL mesh array"
+      );
+      if (!parsedMeshes) {
+        return std::unexpected(parsedMeshes.error());
+      }
+
       std::vector<Mdl::Mesh> meshes;
-      meshes.reserve(model.meshesCount);
+      if (auto reserved = data.reserve(meshes, model.meshesCount); !reserved) {
+        return std::unexpected(reserved.error());
+      }
 
-      for (const auto& mesh : data.parseStructArrayWithoutOffsets<Structs::Mdl::Mesh>(
-             model.meshesOffset,
-             model.meshesCount,
-             "Failed to parse MDL mesh array"
-           )) {
+      for (const auto& mesh : *parsedMeshes) {
         meshes.push_back(parseMesh(mesh));
       }
 
-      return {
+      return Mdl::Model{
         .meshes = std::move(meshes),
         .vertexOffset = model.vertsOffset / static_cast<int32_t>(sizeof(Structs::Vvd::Vertex)),
         .tangentsOffset = model.tangentsOffset / static_cast<int32_t>(sizeof(Structs::Vector4D)),
@@ -38,52 +52,99 @@ namespace MdlParser {
       };
     }
 
-    Mdl::BodyPart parseBodyPart(const OffsetDataView& data, const Structs::Mdl::BodyPart& bodyPart) {
+    Expected<Mdl::BodyPart> parseBodyPart(const OffsetDataView& data, const Structs::Mdl::BodyPart& bodyPart) {
+      const auto parsedModels = data.parseStructArray<Structs::Mdl::Model>(
+        bodyPart.modelsOffset,
+        bodyPart.modelsCount,
+        "Failed to parse MDL model array"
+      );
+      if (!parsedModels) {
+        return std::unexpected(parsedModels.error());
+      }
+
       std::vector<Mdl::Model> models;
-      models.reserve(bodyPart.modelsCount);
+      if (auto reserved = data.reserve(models, bodyPart.modelsCount); !reserved) {
+        return std::unexpected(reserved.error());
+      }
+
+      for (const auto& [model, offset] : *parsedModels) {
+        auto parsedModel = parseModel(data.withOffset(offset), model);
+        if (!parsedModel) {
+          return std::unexpected(parsedModel.error());
+        }
 
-      for (const auto& [model, offset] : data.parseStructArray<Structs::Mdl::Model>(
-             bodyPart.modelsOffset,
-             bodyPart.modelsCount,
-             "Failed to parse MDL model array"
-           )) {
-        models.push_back(parseModel(data.withOffset(offset), model));
+        models.push_back(std::move(*parsedModel));
       }
 
-      return {
-        .name = data.parseString(bodyPart.szNameIndex, "Failed to parse MDL body part name"),
+      auto name = data.parseString(bodyPart.szNameIndex, "Failed to parse MDL body part name");
+      if (!name) {
+        return std::unexpected(name.error());
+      }
+
+      return Mdl::BodyPart{
+        .name = std::move(*name),
         .models = std::move(models),
+        .base = bodyPart.base,
       };
     }
 
-    std::vector<std::string> parseTextureDirectories(const OffsetDataView& data, const Header& header) {
+    Expected<std::vector<std::string>> parseTextureDirectories(const OffsetDataView& data, const Header& header) {
+      const StatsScope scope(data.getStats(), "mdl.textureDirectories");
+      scope.addElements(header.textureDirCount);
+
+      const auto textureDirectoryOffsets = data.parseStructArrayWithoutOffsets<int32_t>(
+        header.textureDirOffset,
+        header.textureDirCount,
+        "Failed to parse MDL texture directory list"
+      );
+      if (!textureDirectoryOffsets) {
+        return std::unexpected(textureDirectoryOffsets.error());
+      }
+
       std::vector<std::string> textureDirectories;
-      textureDirectories.reserve(header.textureDirCount);
+      if (auto reserved = data.reserve(textureDirectories, header.textureDirCount); !reserved) {
+        return std::unexpected(reserved.error());
+      }
 
-      for (const auto textureDirectoryOffset : data.parseStructArrayWithoutOffsets<int32_t>(
-             header.textureDirOffset,
-             header.textureDirCount,
-             "Failed to parse MDL texture directory list"
-           )) {
+      for (const auto textureDirectoryOffset : *textureDirectoryOffsets) {
         const auto rawDirectory = data.parseString(textureDirectoryOffset, "Failed to parse MDL texture directory");
-        textureDirectories.push_back(getNormalisedDirectory(rawDirectory));
+        if (!rawDirectory) {
+          return std::unexpected(rawDirectory.error());
+        }
+
+        textureDirectories.push_back(getNormalisedDirectory(*rawDirectory));
       }
 
       return std::move(textureDirectories);
     }
 
-    std::vector<Mdl::Texture> parseTextures(const OffsetDataView& data, const Header& header) {
+    Expected<std::vector<Mdl::Texture>> parseTextures(const OffsetDataView& data, const Header& header) {
+      const StatsScope scope(data.getStats(), "mdl.textures");
+      scope.addElements(header.textureCount);
+
+      const auto parsedTextures = data.parseStructArray<Structs::Mdl::Texture>(
+        header.textureOffset,
+        header.textureCount,
+        "Failed to parse MDL texture array"
+      );
+      if (!parsedTextures) {
+        return std::unexpected(parsedTextures.error());
+      }
+
       std::vector<Mdl::Texture> textures;
-      textures.reserve(header.textureCount);
+      if (auto reserved = data.reserve(textures, header.textureCount); !reserved) {
+        return std::unexpected(reserved.error());
+      }
+
+      for (const auto& [texture, offset] : *parsedTextures) {
+        auto name = data.withOffset(offset).parseString(texture.szNameIndex, "Failed to parse MDL texture name");
+        if (!name) {
+          return std::unexpected(name.error());
+        }
 
-      for (const auto& [texture, offset] : data.parseStructArray<Structs::Mdl::Texture>(
-             header.textureOffset,
-             header.textureCount,
-             "Failed to parse MDL texture array"
-           )) {
         textures.push_back(
           {
-            .name = data.withOffset(offset).parseString(texture.szNameIndex, "Failed to parse MDL texture name"),
+            .name = std::move(*name),
             .flags = texture.flags,
           }
         );
@@ -92,36 +153,75 @@ namespace MdlParser {
       return std::move(textures);
     }
 
-    std::vector<std::vector<int16_t>> parseSkinTable(const OffsetDataView& data, const Header& header) {
+    Expected<std::vector<std::vector<int16_t>>> parseSkinTable(const OffsetDataView& data, const Header& header) {
+      const StatsScope scope(data.getStats(), "mdl.skins");
+      scope.addElements(header.skinFamilyCount);
+
+      // The whole table is checked before reserving a row for each family. Negative counts become huge, so must
+      // not be multiplied without checking for overflow
+      const auto familyCount = static_cast<size_t>(header.skinFamilyCount);
+      const auto refCount = static_cast<size_t>(header.skinRefCount);
+      if (refCount != 0 && familyCount > std::numeric_limits<size_t>::max() / refCount) {
+        return makeError(Reason::OutOfBoundsAccess, header.skinRefOffset, "MDL skin table size overflows");
+      }
+      if (
+        auto inBounds = data.checkStructArray<int16_t>(
+          header.skinRefOffset, familyCount * refCount, "Failed to parse MDL skin table"
+        );
+        !inBounds
+      ) {
+        return std::unexpected(inBounds.error());
+      }
+
       std::vector<std::vector<int16_t>> skins;
-      skins.reserve(header.skinFamilyCount);
+      if (auto reserved = data.reserve(skins, header.skinFamilyCount); !reserved) {
+        return std::unexpected(reserved.error());
+      }
 
-      for (size_t family = 0; family < header.skinFamilyCount; family++) {
-        skins.push_back(
-          data.withOffset(header.skinRefOffset)
+      for (size_t family = 0; family < familyCount; family++) {
+        auto row = data.withOffset(header.skinRefOffset)
           .parseStructArrayWithoutOffsets<int16_t>(
             family * header.skinRefCount * sizeof(int16_t),
             header.skinRefCount,
             "Failed to parse MDL skin table row"
-          )
-        );
+          );
+        if (!row) {
+          return std::unexpected(row.error());
+        }
+
+        skins.push_back(std::move(*row));
       }
 
       return std::move(skins);
     }
 
-    std::vector<Mdl::Bone> parseBones(const OffsetDataView& data, const Header& header) {
+    Expected<std::vector<Mdl::Bone>> parseBones(const OffsetDataView& data, const Header& header) {
+      const StatsScope scope(data.getStats(), "mdl.bones");
+      scope.addElements(header.boneCount);
+
+      const auto parsedBones = data.parseStructArray<Structs::Mdl::Bone>(
+        header.boneOffset,
+        header.boneCount,
+        "Failed to parse MDL bone array"
+      );
+      if (!parsedBones) {
+        return std::unexpected(parsedBones.error());
+      }
+
       std::vector<Mdl::Bone> bones;
-      bones.reserve(header.boneCount);
+      if (auto reserved = data.reserve(bones, header.boneCount); !reserved) {
+        return std::unexpected(reserved.error());
+      }
+
+      for (const auto& [bone, offset] : *parsedBones) {
+        auto name = data.withOffset(offset).parseString(bone.szNameIndex, "Failed to parse MDL bone name");
+        if (!name) {
+          return std::unexpected(name.error());
+        }
 
-      for (const auto& [bone, offset] : data.parseStructArray<Structs::Mdl::Bone>(
-             header.boneOffset,
-             header.boneCount,
-             "Failed to parse MDL bone array"
-           )) {
         bones.push_back(
           {
-            .name = data.withOffset(offset).parseString(bone.szNameIndex, "Failed to parse MDL bone name"),
+            .name = std::move(*name),
             .parent = bone.parent,
             .position = bone.pos,
             .orientation = bone.quat,
@@ -129,6 +229,7 @@ namespace MdlParser {
             .positionScale = bone.posScale,
             .orientationScale = bone.rotScale,
             .poseToBone = bone.poseToBone,
+            .alignment = bone.qAlignment,
             .flags = bone.flags,
           }
         );
@@ -136,39 +237,604 @@ namespace MdlParser {
 
       return std::move(bones);
     }
+
+    /**
+     * Offsets of each array of Mdl::LinearBones in the Mdl's linear bone storage.
+     */
+    struct LinearBoneLayout {
+      size_t flags;
+      size_t parents;
+      size_t positions;
+      size_t orientations;
+      size_t orientationEulers;
+      size_t poseToBones;
+      size_t positionScales;
+      size_t orientationScales;
+      size_t alignments;
+
+      /**
+       * Total size of the storage in bytes.
+       */
+      size_t size;
+    };
+
+    LinearBoneLayout getLinearBoneLayout(const size_t boneCount) {
+      constexpr auto alignment = Mdl::LINEAR_BONE_ALIGNMENT;
+
+      size_t size = 0;
+      const auto place = [&](const size_t elementSize) {
+        const auto offset = size;
+        size = (offset + elementSize * boneCount + alignment - 1) / alignment * alignment;
+        return offset;
+      };
+
+      // Braced initialisers are evaluated in order, so the arrays are placed one after another
+      return {
+        .flags = place(sizeof(int32_t)),
+        .parents = place(sizeof(int32_t)),
+        .positions = place(sizeof(Structs::Vector)),
+        .orientations = place(sizeof(Structs::Quaternion)),
+        .orientationEulers = place(sizeof(Structs::RadianEuler)),
+        .poseToBones = place(sizeof(Structs::Matrix3x4)),
+        .positionScales = place(sizeof(Structs::Vector)),
+        .orientationScales = place(sizeof(Structs::Vector)),
+        .alignments = place(sizeof(Structs::Quaternion)),
+        .size = size,
+      };
+    }
+
+    template<typename T, typename Byte>
+    std::span<T> getLinearBoneArray(Byte* storage, const size_t offset, const size_t boneCount) {
+      return {reinterpret_cast<T*>(storage + offset), boneCount};
+    }
+
+    Expected<void> parseLinearBones(
+      const OffsetDataView& data,
+      const size_t offset,
+      const size_t boneCount,
+      const LinearBoneLayout& layout,
+      std::byte* storage
+    ) {
+      const StatsScope scope(data.getStats(), "mdl.linearBones");
+      scope.addElements(boneCount);
+
+      const auto parsedLinearBone = data.parseStruct<Structs::Mdl::LinearBone>(
+        offset,
+        "Failed to parse MDL linear bone table"
+      );
+      if (!parsedLinearBone) {
+        return std::unexpected(parsedLinearBone.error());
+      }
+
+      const auto linearBone = parsedLinearBone->first;
+      if (linearBone.boneCount < 0 || static_cast<size_t>(linearBone.boneCount) != boneCount) {
+        return makeError(Reason::InvalidBody, offset, "MDL linear bone count does not match bone count");
+      }
+
+      const auto tableData = data.withOffset(offset);
+      const auto copy = [&](const int32_t arrayOffset, const auto destination) -> Expected<void> {
+        constexpr auto message = "Failed to parse MDL linear bone array";
+        if (arrayOffset < 0) {
+          return makeError(Reason::OutOfBoundsAccess, offset, message);
+        }
+
+        return tableData.copyStructArray(arrayOffset, destination, message);
+      };
+
+      const std::array results{
+        copy(linearBone.flagsOffset, getLinearBoneArray<int32_t>(storage, layout.flags, boneCount)),
+        copy(linearBone.parentOffset, getLinearBoneArray<int32_t>(storage, layout.parents, boneCount)),
+        copy(linearBone.posOffset, getLinearBoneArray<Structs::Vector>(storage, layout.positions, boneCount)),
+        copy(linearBone.quatOffset, getLinearBoneArray<Structs::Quaternion>(storage, layout.orientations, boneCount)),
+        copy(
+          linearBone.rotOffset,
+          getLinearBoneArray<Structs::RadianEuler>(storage, layout.orientationEulers, boneCount)
+        ),
+        copy(
+          linearBone.poseToBoneOffset,
+          getLinearBoneArray<Structs::Matrix3x4>(storage, layout.poseToBones, boneCount)
+        ),
+        copy(linearBone.posScaleOffset, getLinearBoneArray<Structs::Vector>(storage, layout.positionScales, boneCount)),
+        copy(
+          linearBone.rotScaleOffset,
+          getLinearBoneArray<Structs::Vector>(storage, layout.orientationScales, boneCount)
+        ),
+        copy(
+          linearBone.qAlignmentOffset,
+          getLinearBoneArray<Structs::Quaternion>(storage, layout.alignments, boneCount)
+        ),
+      };
+
+      for (const auto& result : results) {
+        if (!result) {
+          return std::unexpected(result.error());
+        }
+      }
+
+      return {};
+    }
+
+    void synthesizeLinearBones(
+      const std::span<const Mdl::Bone> bones,
+      const LinearBoneLayout& layout,
+      std::byte* storage
+    ) {
+      const auto count = bones.size();
+      const auto flags = getLinearBoneArray<int32_t>(storage, layout.flags, count);
+      const auto parents = getLinearBoneArray<int32_t>(storage, layout.parents, count);
+      const auto positions = getLinearBoneArray<Structs::Vector>(storage, layout.positions, count);
+      const auto orientations = getLinearBoneArray<Structs::Quaternion>(storage, layout.orientations, count);
+      const auto orientationEulers = getLinearBoneArray<Structs::RadianEuler>(storage, layout.orientationEulers, count);
+      const auto poseToBones = getLinearBoneArray<Structs::Matrix3x4>(storage, layout.poseToBones, count);
+      const auto positionScales = getLinearBoneArray<Structs::Vector>(storage, layout.positionScales, count);
+      const auto orientationScales = getLinearBoneArray<Structs::Vector>(storage, layout.orientationScales, count);
+      const auto alignments = getLinearBoneArray<Structs::Quaternion>(storage, layout.alignments, count);
+
+      for (size_t bone = 0; bone < count; bone++) {
+        flags[bone] = bones[bone].flags;
+        parents[bone] = bones[bone].parent;
+        positions[bone] = bones[bone].position;
+        orientations[bone] = bones[bone].orientation;
+        orientationEulers[bone] = bones[bone].orientationEuler;
+        poseToBones[bone] = bones[bone].poseToBone;
+        positionScales[bone] = bones[bone].positionScale;
+        orientationScales[bone] = bones[bone].orientationScale;
+        alignments[bone] = bones[bone].alignment;
+      }
+    }
+
+    Expected<std::vector<Mdl::Animation>> parseAnimations(const OffsetDataView& data, const Header& header) {
+      const StatsScope scope(data.getStats(), "mdl.animations");
+      scope.addElements(header.localAnimCount);
+
+      const auto parsedAnimations = data.parseStructArray<Structs::Mdl::AnimDesc>(
+        header.localAnimOffset,
+        header.localAnimCount,
+        "Failed to parse MDL animation array"
+      );
+      if (!parsedAnimations) {
+        return std::unexpected(parsedAnimations.error());
+      }
+
+      std::vector<Mdl::Animation> animations;
+      if (auto reserved = data.reserve(animations, header.localAnimCount); !reserved) {
+        return std::unexpected(reserved.error());
+      }
+
+      for (const auto& [animation, offset] : *parsedAnimations) {
+        auto name = data.withOffset(offset).parseString(animation.szNameIndex, "Failed to parse MDL animation name");
+        if (!name) {
+          return std::unexpected(name.error());
+        }
+
+        animations.push_back(
+          {
+            .name = std::move(*name),
+            .fps = animation.fps,
+            .flags = animation.flags,
+            .frameCount = animation.framesCount,
+          }
+        );
+      }
+
+      return std::move(animations);
+    }
+
+    Expected<std::vector<Mdl::Event>> parseEvents(
+      const OffsetDataView& data,
+      const Structs::Mdl::SequenceDesc& sequence
+    ) {
+      const auto parsedEvents = data.parseStructArray<Structs::Mdl::Event>(
+        sequence.eventsOffset,
+        sequence.eventsCount,
+        "Failed to parse MDL sequence event array"
+      );
+      if (!parsedEvents) {
+        return std::unexpected(parsedEvents.error());
+      }
+
+      std::vector<Mdl::Event> events;
+      if (auto reserved = data.reserve(events, sequence.eventsCount); !reserved) {
+        return std::unexpected(reserved.error());
+      }
+
+      for (const auto& [event, offset] : *parsedEvents) {
+        // Old style events are identified by number alone and have no name
+        std::string name;
+        if (event.szEventIndex != 0) {
+          auto parsedName = data.withOffset(offset).parseString(event.szEventIndex, "Failed to parse MDL event name");
+          if (!parsedName) {
+            return std::unexpected(parsedName.error());
+          }
+
+          name = std::move(*parsedName);
+        }
+
+        const auto optionsLength = std::ranges::find(event.options, '\0') - event.options.begin();
+
+        events.push_back(
+          {
+            .cycle = event.cycle,
+            .event = event.event,
+            .type = event.type,
+            .options = std::string(event.options.data(), optionsLength),
+            .name = std::move(name),
+          }
+        );
+      }
+
+      return std::move(events);
+    }
+
+    Expected<std::vector<Mdl::Sequence>> parseSequences(
+      const OffsetDataView& data,
+      const Header& header,
+      const std::vector<Mdl::Animation>& animations
+    ) {
+      const StatsScope scope(data.getStats(), "mdl.sequences");
+      scope.addElements(header.localSequenceCount);
+
+      const auto parsedSequences = data.parseStructArray<Structs::Mdl::SequenceDesc>(
+        header.localSequenceOffset,
+        header.localSequenceCount,
+        "Failed to parse MDL sequence array"
+      );
+      if (!parsedSequences) {
+        return std::unexpected(parsedSequences.error());
+      }
+
+      std::vector<Mdl::Sequence> sequences;
+      if (auto reserved = data.reserve(sequences, header.localSequenceCount); !reserved) {
+        return std::unexpected(reserved.error());
+      }
+
+      for (const auto& [sequence, offset] : *parsedSequences) {
+        const auto sequenceData = data.withOffset(offset);
+
+        auto name = sequenceData.parseString(sequence.szLabelIndex, "Failed to parse MDL sequence name");
+        if (!name) {
+          return std::unexpected(name.error());
+        }
+
+        auto activityName =
+          sequenceData.parseString(sequence.szActivityNameIndex, "Failed to parse MDL sequence activity name");
+        if (!activityName) {
+          return std::unexpected(activityName.error());
+        }
+
+        if (sequence.groupSize[0] < 0 || sequence.groupSize[1] < 0) {
+          return makeError(Reason::InvalidBody, offset, "MDL sequence blend grid size is negative");
+        }
+
+        auto blendAnimations = sequenceData.parseStructArrayWithoutOffsets<int16_t>(
+          sequence.animIndexOffset,
+          static_cast<size_t>(sequence.groupSize[0]) * sequence.groupSize[1],
+          "Failed to parse MDL sequence animation indices"
+        );
+        if (!blendAnimations) {
+          return std::unexpected(blendAnimations.error());
+        }
+
+        auto events = parseEvents(sequenceData, sequence);
+        if (!events) {
+          return std::unexpected(events.error());
+        }
+
+        // As in the engine, the sequence's timing comes from the first animation in its blend grid
+        const Mdl::Animation* firstAnimation = nullptr;
+        if (!blendAnimations->empty() && blendAnimations->front() >= 0) {
+          const auto animation = static_cast<size_t>(blendAnimations->front());
+          firstAnimation = animation < animations.size() ? &animations[animation] : nullptr;
+        }
+
+        sequences.push_back(
+          {
+            .name = std::move(*name),
+            .activityName = std::move(*activityName),
+            .activity = sequence.activity,
+            .flags = sequence.flags,
+            .activityWeight = sequence.activityWeight,
+            .fps = firstAnimation ? firstAnimation->fps : 0.0f,
+            .frameCount = firstAnimation ? firstAnimation->frameCount : 0,
+            .events = std::move(*events),
+            .animations = std::move(*blendAnimations),
+          }
+        );
+      }
+
+      return std::move(sequences);
+    }
+
+    Expected<std::vector<Mdl::IncludeModel>> parseIncludeModels(const OffsetDataView& data, const Header& header) {
+      const StatsScope scope(data.getStats(), "mdl.includeModels");
+      scope.addElements(header.includeModelCount);
+
+      const auto parsedIncludeModels = data.parseStructArray<Structs::Mdl::IncludeModel>(
+        header.includeModelOffset,
+        header.includeModelCount,
+        "Failed to parse MDL include model array"
+      );
+      if (!parsedIncludeModels) {
+        return std::unexpected(parsedIncludeModels.error());
+      }
+
+      std::vector<Mdl::IncludeModel> includeModels;
+      if (auto reserved = data.reserve(includeModels, header.includeModelCount); !reserved) {
+        return std::unexpected(reserved.error());
+      }
+
+      for (const auto& [includeModel, offset] : *parsedIncludeModels) {
+        const auto includeModelData = data.withOffset(offset);
+
+        auto label = includeModelData.parseString(includeModel.szLabelIndex, "Failed to parse MDL include model label");
+        if (!label) {
+          return std::unexpected(label.error());
+        }
+
+        auto name = includeModelData.parseString(includeModel.szNameIndex, "Failed to parse MDL include model name");
+        if (!name) {
+          return std::unexpected(name.error());
+        }
+
+        includeModels.push_back({.label = std::move(*label), .name = std::move(*name)});
+      }
+
+      return std::move(includeModels);
+    }
+
+    Expected<std::string> parseKeyValues(const OffsetDataView& data, const Header& header) {
+      const StatsScope scope(data.getStats(), "mdl.keyValues");
+      if (header.keyvalueCount <= 0) {
+        return std::string();
+      }
+
+      auto text = data.parseStructArrayWithoutOffsets<char>(
+        header.keyvalueOffset,
+        header.keyvalueCount,
+        "Failed to parse MDL key values"
+      );
+      if (!text) {
+        return std::unexpected(text.error());
+      }
+
+      // The count may include the null terminator
+      const auto length = std::ranges::find(*text, '\0') - text->begin();
+      return std::string(text->data(), length);
+    }
+
+    Expected<std::vector<Mdl::Attachment>> parseAttachments(const OffsetDataView& data, const Header& header) {
+      const StatsScope scope(data.getStats(), "mdl.attachments");
+      scope.addElements(header.attachmentCount);
+
+      const auto parsedAttachments = data.parseStructArray<Structs::Mdl::Attachment>(
+        header.attachmentOffset,
+        header.attachmentCount,
+        "Failed to parse MDL attachment array"
+      );
+      if (!parsedAttachments) {
+        return std::unexpected(parsedAttachments.error());
+      }
+
+      std::vector<Mdl::Attachment> attachments;
+      if (auto reserved = data.reserve(attachments, header.attachmentCount); !reserved) {
+        return std::unexpected(reserved.error());
+      }
+
+      for (const auto& [attachment, offset] : *parsedAttachments) {
+        auto name = data.withOffset(offset).parseString(attachment.szNameIndex, "Failed to parse MDL attachment name");
+        if (!name) {
+          return std::unexpected(name.error());
+        }
+
+        attachments.push_back(
+          {
+            .name = std::move(*name),
+            .flags = attachment.flags,
+            .bone = attachment.localBone,
+            .local = attachment.local,
+          }
+        );
+      }
+
+      return std::move(attachments);
+    }
+
+    /**
+     * Loads a serialized bone name index, checking it finds every bone by name so an index saved for another model
+     * is never used.
+     * @return The index, or nullopt if there is no serialized index or it does not match the bones.
+     */
+    std::optional<BoneNameIndex> loadBoneNameIndex(
+      const std::span<const std::byte> data,
+      const std::span<const std::string_view> boneNames
+    ) {
+      if (data.empty()) {
+        return std::nullopt;
+      }
+
+      auto index = BoneNameIndex::tryDeserialize(data, boneNames.size());
+      if (!index) {
+        return std::nullopt;
+      }
+
+      for (const auto name : boneNames) {
+        const auto candidate = index->findCandidate(name);
+        if (!candidate || !isNameEqual(boneNames[*candidate], name)) {
+          return std::nullopt;
+        }
+      }
+
+      return std::move(*index);
+    }
   }
 
-  Mdl::Mdl(const std::span<const std::byte> data, const std::optional<int32_t>& checksum) {
-    const OffsetDataView dataView(data);
-    header = dataView.parseStruct<Header>(0, "Failed to parse MDL header").first;
+  Mdl::Mdl(
+    const std::span<const std::byte> data,
+    const std::optional<int32_t>& checksum,
+    ParseStats* stats,
+    const ParseLimits& limits,
+    const std::span<const std::byte> boneNameIndex
+  )
+    : Mdl(valueOrThrow(tryParse(data, checksum, stats, limits, boneNameIndex))) {}
 
-    if (header.id != FILE_ID) {
-      throw InvalidHeader("MDL header file ID does not match packed IDST");
+  Expected<Mdl> Mdl::tryParse(
+    const std::span<const std::byte> data,
+    const std::optional<int32_t>& checksum,
+    ParseStats* stats,
+    const ParseLimits& limits,
+    const std::span<const std::byte> boneNameIndex
+  ) {
+    const StatsScope scope(stats, "mdl");
+    const OffsetDataView dataView(data, stats, limits);
+    Mdl mdl;
+
+    const auto parsedHeader = dataView.parseStruct<Header>(0, "Failed to parse MDL header");
+    if (!parsedHeader) {
+      return std::unexpected(parsedHeader.error());
+    }
+    const auto& header = mdl.header = parsedHeader->first;
+
+    if (header.id != Header::FILE_ID) {
+      return makeError(Reason::InvalidHeader, 0, "MDL header file ID does not match packed IDST");
     }
     if (header.version > Header::MAX_SUPPORTED_VERSION) {
-      throw InvalidHeader("MDL version is unsupported (greater than 48)");
+      return makeError(Reason::InvalidHeader, 0, "MDL version is unsupported (greater than 48)");
     }
     if (checksum.has_value() && header.checksum != checksum.value()) {
-      throw InvalidChecksum("MDL checksum does not match");
+      return makeError(Reason::InvalidChecksum, 0, "MDL checksum does not match");
+    }
+
+    if (header.header2Offset > 0 && static_cast<size_t>(header.header2Offset) >= sizeof(Header)) {
+      const auto header2 = dataView.parseStruct<Header2>(header.header2Offset, "Failed to parse second MDL header");
+      if (!header2) {
+        return std::unexpected(header2.error());
+      }
+
+      mdl.header2 = header2->first;
     }
 
-    header2 = header.header2Offset >= sizeof(Header)
-      ? std::optional(dataView.parseStruct<Header2>(header.header2Offset, "Failed to parse second MDL header").first)
-      : std::nullopt;
+    {
+      const StatsScope bodyPartsScope(stats, "mdl.bodyParts");
+      bodyPartsScope.addElements(header.bodypartCount);
+
+      const auto bodyParts = dataView.parseStructArray<Structs::Mdl::BodyPart>(
+        header.bodypartOffset,
+        header.bodypartCount,
+        "Failed to parse MDL body part array"
+      );
+      if (!bodyParts) {
+        return std::unexpected(bodyParts.error());
+      }
+
+      if (auto reserved = dataView.reserve(mdl.bodyParts, header.bodypartCount); !reserved) {
+        return std::unexpected(reserved.error());
+      }
+      for (const auto& [bodyPart, offset] : *bodyParts) {
+        auto parsedBodyPart = parseBodyPart(dataView.withOffset(offset), bodyPart);
+        if (!parsedBodyPart) {
+          return std::unexpected(parsedBodyPart.error());
+        }
 
-    bodyParts.reserve(header.bodypartCount);
-    for (const auto& [bodyPart, offset] : dataView.parseStructArray<Structs::Mdl::BodyPart>(
-           header.bodypartOffset,
-           header.bodypartCount,
-           "Failed to parse MDL body part array"
-         )) {
-      bodyParts.push_back(parseBodyPart(dataView.withOffset(offset), bodyPart));
+        mdl.bodyParts.push_back(std::move(*parsedBodyPart));
+      }
     }
 
-    textureDirectories = parseTextureDirectories(dataView, header);
-    textures = parseTextures(dataView, header);
-    skins = parseSkinTable(dataView, header);
-    bones = parseBones(dataView, header);
+    auto textureDirectories = parseTextureDirectories(dataView, header);
+    if (!textureDirectories) {
+      return std::unexpected(textureDirectories.error());
+    }
+    mdl.textureDirectories = std::move(*textureDirectories);
+
+    auto textures = parseTextures(dataView, header);
+    if (!textures) {
+      return std::unexpected(textures.error());
+    }
+    mdl.textures = std::move(*textures);
+
+    auto skins = parseSkinTable(dataView, header);
+    if (!skins) {
+      return std::unexpected(skins.error());
+    }
+    mdl.skins = std::move(*skins);
+
+    auto bones = parseBones(dataView, header);
+    if (!bones) {
+      return std::unexpected(bones.error());
+    }
+    mdl.bones = std::move(*bones);
+
+    std::vector<std::string_view> boneNames;
+    boneNames.reserve(mdl.bones.size());
+    for (const auto& bone : mdl.bones) {
+      boneNames.emplace_back(bone.name);
+    }
+
+    // A serialized index is only trusted once every bone's name is found through it. Failing to find a perfect hash is
+    // no reason to reject the model, so building one falls back to an ordinary hash table
+    if (auto loaded = loadBoneNameIndex(boneNameIndex, boneNames)) {
+      mdl.boneNameIndex = std::move(*loaded);
+    } else if (auto built = BoneNameIndex::build(boneNames)) {
+      mdl.boneNameIndex = std::move(*built);
+    } else {
+      mdl.boneNameLookup = buildNameLookup(boneNames.size(), [&](const size_t bone) { return boneNames[bone]; });
+    }
+
+    const auto linearBoneLayout = getLinearBoneLayout(mdl.bones.size());
+    if (auto reserved = dataView.reserve(mdl.linearBones, linearBoneLayout.size); !reserved) {
+      return std::unexpected(reserved.error());
+    }
+    mdl.linearBones.resize(linearBoneLayout.size);
+    if (mdl.header2 && mdl.header2->linearBoneOffset > 0 && !mdl.bones.empty()) {
+      const auto linearBoneOffset = static_cast<size_t>(header.header2Offset) + mdl.header2->linearBoneOffset;
+      auto linearBones = parseLinearBones(
+        dataView,
+        linearBoneOffset,
+        mdl.bones.size(),
+        linearBoneLayout,
+        mdl.linearBones.data()
+      );
+      if (!linearBones) {
+        return std::unexpected(linearBones.error());
+      }
+    } else {
+      synthesizeLinearBones(mdl.bones, linearBoneLayout, mdl.linearBones.data());
+    }
+
+    auto animations = parseAnimations(dataView, header);
+    if (!animations) {
+      return std::unexpected(animations.error());
+    }
+    mdl.animations = std::move(*animations);
+
+    auto sequences = parseSequences(dataView, header, mdl.animations);
+    if (!sequences) {
+      return std::unexpected(sequences.error());
+    }
+    mdl.sequences = std::move(*sequences);
+    mdl.buildSequenceIndices();
+
+    auto includeModels = parseIncludeModels(dataView, header);
+    if (!includeModels) {
+      return std::unexpected(includeModels.error());
+    }
+    mdl.includeModels = std::move(*includeModels);
+
+    auto keyValues = parseKeyValues(dataView, header);
+    if (!keyValues) {
+      return std::unexpected(keyValues.error());
+    }
+    mdl.keyValues = std::move(*keyValues);
+
+    auto attachments = parseAttachments(dataView, header);
+    if (!attachments) {
+      return std::unexpected(attachments.error());
+    }
+    mdl.attachments = std::move(*attachments);
+    mdl.attachmentLookup = buildNameLookup(mdl.attachments.size(), [&](const size_t i) {
+      return std::string_view(mdl.attachments[i].name);
+    });
+
+    return std::move(mdl);
   }
 
   int32_t Mdl::getChecksum() const {
@@ -191,7 +857,220 @@ namespace MdlParser {
     return skins;
   }
 
+  std::optional<size_t> Mdl::resolveTexture(const size_t skinFamily, const int32_t material) const {
+    auto texture = material;
+
+    if (!skins.empty()) {
+      if (skinFamily >= skins.size() || material < 0 || static_cast<size_t>(material) >= skins[skinFamily].size()) {
+        return std::nullopt;
+      }
+
+      texture = skins[skinFamily][material];
+    }
+
+    if (texture < 0 || static_cast<size_t>(texture) >= textures.size()) {
+      return std::nullopt;
+    }
+
+    return static_cast<size_t>(texture);
+  }
+
   const std::vector<Mdl::Bone>& Mdl::getBones() const {
     return bones;
   }
+
+  Mdl::LinearBones Mdl::getLinearBones() const {
+    const auto layout = getLinearBoneLayout(bones.size());
+    const auto* storage = linearBones.data();
+    const auto count = bones.size();
+
+    return {
+      .flags = getLinearBoneArray<const int32_t>(storage, layout.flags, count),
+      .parents = getLinearBoneArray<const int32_t>(storage, layout.parents, count),
+      .positions = getLinearBoneArray<const Structs::Vector>(storage, layout.positions, count),
+      .orientations = getLinearBoneArray<const Structs::Quaternion>(storage, layout.orientations, count),
+      .orientationEulers = getLinearBoneArray<const Structs::RadianEuler>(storage, layout.orientationEulers, count),
+      .poseToBones = getLinearBoneArray<const Structs::Matrix3x4>(storage, layout.poseToBones, count),
+      .positionScales = getLinearBoneArray<const Structs::Vector>(storage, layout.positionScales, count),
+      .orientationScales = getLinearBoneArray<const Structs::Vector>(storage, layout.orientationScales, count),
+      .alignments = getLinearBoneArray<const Structs::Quaternion>(storage, layout.alignments, count),
+    };
+  }
+
+  std::optional<size_t> Mdl::findBone(const std::string_view name) const {
+    if (!boneNameLookup.empty()) {
+      return findInNameLookup(boneNameLookup, name, [&](const size_t bone) -> std::string_view {
+        return bones[bone].name;
+      });
+    }
+
+    const auto candidate = boneNameIndex.findCandidate(name);
+    if (!candidate || !isNameEqual(bones[*candidate].name, name)) {
+      return std::nullopt;
+    }
+
+    return candidate;
+  }
+
+  const BoneNameIndex& Mdl::getBoneNameIndex() const {
+    return boneNameIndex;
+  }
+
+  const std::vector<Mdl::Animation>& Mdl::getAnimations() const {
+    return animations;
+  }
+
+  const std::vector<Mdl::Sequence>& Mdl::getSequences() const {
+    return sequences;
+  }
+
+  std::string_view Mdl::getKeyValues() const {
+    return keyValues;
+  }
+
+  const std::vector<Mdl::IncludeModel>& Mdl::getIncludeModels() const {
+    return includeModels;
+  }
+
+  const std::vector<Mdl::Attachment>& Mdl::getAttachments() const {
+    return attachments;
+  }
+
+  std::optional<size_t> Mdl::findAttachment(const std::string_view name) const {
+    return findInNameLookup(attachmentLookup, name, [&](const size_t i) {
+      return std::string_view(attachments[i].name);
+    });
+  }
+
+  size_t Mdl::getMemoryUsage() const {
+    const auto getBodyPartSize = [](const BodyPart& bodyPart) {
+      return getHeapSize(bodyPart.name) + getHeapSize(bodyPart.models, [](const Model& model) {
+        return getHeapSize(model.meshes);
+      });
+    };
+    const auto getSequenceSize = [](const Sequence& sequence) {
+      const auto getEventSize = [](const Event& event) {
+        return getHeapSize(event.options) + getHeapSize(event.name);
+      };
+
+      return getHeapSize(sequence.name) + getHeapSize(sequence.activityName) +
+        getHeapSize(sequence.events, getEventSize) + getHeapSize(sequence.animations);
+    };
+
+    return sizeof(Mdl) + getHeapSize(bodyParts, getBodyPartSize) +
+      getHeapSize(textureDirectories, [](const std::string& directory) { return getHeapSize(directory); }) +
+      getHeapSize(textures, [](const Texture& texture) { return getHeapSize(texture.name); }) +
+      getHeapSize(skins, [](const std::vector<int16_t>& row) { return getHeapSize(row); }) +
+      getHeapSize(bones, [](const Bone& bone) { return getHeapSize(bone.name); }) + boneNameIndex.getHeapSize() +
+      getHeapSize(boneNameLookup) + getHeapSize(linearBones) +
+      getHeapSize(animations, [](const Animation& animation) { return getHeapSize(animation.name); }) +
+      getHeapSize(sequences, getSequenceSize) + getHeapSize(sequenceLookup) + getHeapSize(activitySequences) +
+      getHeapSize(activityCumulativeWeights) + getHeapSize(activityRanges) + getHeapSize(activityLookup) +
+      getHeapSize(includeModels, [](const IncludeModel& include) {
+        return getHeapSize(include.label) + getHeapSize(include.name);
+      }) +
+      getHeapSize(keyValues) +
+      getHeapSize(attachments, [](const Attachment& attachment) { return getHeapSize(attachment.name); }) +
+      getHeapSize(attachmentLookup);
+  }
+
+  std::optional<size_t> Mdl::findSequence(const std::string_view name) const {
+    return findInNameLookup(sequenceLookup, name, [&](const size_t i) {
+      return std::string_view(sequences[i].name);
+    });
+  }
+
+  std::span<const int32_t> Mdl::getActivitySequences(const std::string_view activityName) const {
+    const auto activity = findActivity(activityName);
+    if (!activity) {
+      return {};
+    }
+
+    const auto [offset, count] = activityRanges[*activity];
+    return std::span(activitySequences).subspan(offset, count);
+  }
+
+  std::optional<size_t> Mdl::selectWeightedSequence(const std::string_view activityName, const float random) const {
+    const auto activity = findActivity(activityName);
+    if (!activity) {
+      return std::nullopt;
+    }
+
+    const auto [offset, count] = activityRanges[*activity];
+    const auto weights = std::span(activityCumulativeWeights).subspan(offset, count);
+
+    const auto totalWeight = weights.back();
+    if (totalWeight == 0) {
+      return std::nullopt;
+    }
+
+    // Scaled in double as weights can exceed a float's precision, and clamped so that a random value of (or rounding up
+    // to) 1 still picks the last weighted sequence
+    const auto clampedRandom = std::isnan(random) ? 0.0 : std::clamp(static_cast<double>(random), 0.0, 1.0);
+    const auto scaled = static_cast<uint64_t>(clampedRandom * static_cast<double>(totalWeight));
+    const auto target = std::min(scaled, totalWeight - 1);
+    const auto chosen = std::ranges::upper_bound(weights, target) - weights.begin();
+
+    return activitySequences[offset + chosen];
+  }
+
+  void Mdl::buildSequenceIndices() {
+    sequenceLookup = buildNameLookup(sequences.size(), [&](const size_t i) {
+      return std::string_view(sequences[i].name);
+    });
+
+    // Group the sequences by activity, keyed by the first sequence with each activity
+    const auto firstWithActivity = buildNameLookup(sequences.size(), [&](const size_t i) {
+      return std::string_view(sequences[i].activityName);
+    });
+
+    std::vector<std::vector<int32_t>> groups;
+    std::vector<int32_t> groupBySequence(sequences.size(), -1);
+
+    for (size_t i = 0; i < sequences.size(); i++) {
+      if (sequences[i].activityName.empty()) {
+        continue;
+      }
+
+      const auto first = *findInNameLookup(firstWithActivity, sequences[i].activityName, [&](const size_t j) {
+        return std::string_view(sequences[j].activityName);
+      });
+
+      if (groupBySequence[first] == -1) {
+        groupBySequence[first] = static_cast<int32_t>(groups.size());
+        groups.emplace_back();
+      }
+
+      groups[groupBySequence[first]].push_back(static_cast<int32_t>(i));
+    }
+
+    activitySequences.clear();
+    activityCumulativeWeights.clear();
+    activityRanges.clear();
+    activitySequences.reserve(sequences.size());
+    activityCumulativeWeights.reserve(sequences.size());
+    activityRanges.reserve(groups.size());
+
+    for (const auto& group : groups) {
+      activityRanges.emplace_back(static_cast<uint32_t>(activitySequences.size()), static_cast<uint32_t>(group.size()));
+
+      // 64 bit, as even two weights near INT32_MIN would overflow 32 bits and leave the totals out of order
+      uint64_t totalWeight = 0;
+      for (const auto sequence : group) {
+        totalWeight += static_cast<uint64_t>(std::abs(static_cast<int64_t>(sequences[sequence].activityWeight)));
+        activitySequences.push_back(sequence);
+        activityCumulativeWeights.push_back(totalWeight);
+      }
+    }
+
+    activityLookup = buildNameLookup(activityRanges.size(), [&](const size_t i) {
+      return std::string_view(sequences[activitySequences[activityRanges[i].first]].activityName);
+    });
+  }
+
+  std::optional<size_t> Mdl::findActivity(const std::string_view activityName) const {
+    return findInNameLookup(activityLookup, activityName, [&](const size_t i) {
+      return std::string_view(sequences[activitySequences[activityRanges[i].first]].activityName);
+    });
+  }
 }
@@ -1,10 +1,18 @@
 #pragma once
 
+#include <cstddef>
 #include <optional>
 #include <span>
 #include <string>
+#include <string_view>
+#include <utility>
 #include <vector>
 #include "./structs/mdl.hpp"
+#include "bone-name-index.hpp"
+#include "errors.hpp"
+#include "helpers/aligned-allocator.hpp"
+#include "parse-limits.hpp"
+#include "parse-stats.hpp"
 
 namespace MdlParser {
   /**
@@ -75,6 +83,12 @@ namespace MdlParser {
        * The models which can be toggled between.
        */
       std::vector<Model> models;
+
+      /**
+       * Multiplier of the selected model's index in a body value, being the product of the model counts of every
+       * earlier body part. See getBodyGroup() and setBodyGroup().
+       */
+      int32_t base;
     };
 
     /**
@@ -102,12 +116,36 @@ namespace MdlParser {
        */
       Structs::Matrix3x4 poseToBone;
 
+      /**
+       * Default alignment of the bone, used by procedural bones.
+       */
+      Structs::Quaternion alignment;
+
       /**
        * Bitflags describing this bone. An enum is not currently provided with the possible values and their meanings.
        */
       int32_t flags;
     };
 
+    /**
+     * The bones of the model as one array per field (structure of arrays), as the engine's linear bone table.
+     * Each array has one element per bone, in the order of getBones(), and starts on a LINEAR_BONE_ALIGNMENT byte
+     * boundary so SIMD pose code can use aligned loads.
+     */
+    struct LinearBones {
+      std::span<const int32_t> flags;
+      std::span<const int32_t> parents;
+      std::span<const Structs::Vector> positions;
+      std::span<const Structs::Quaternion> orientations;
+      std::span<const Structs::RadianEuler> orientationEulers;
+      std::span<const Structs::Matrix3x4> poseToBones;
+      std::span<const Structs::Vector> positionScales;
+      std::span<const Structs::Vector> orientationScales;
+      std::span<const Structs::Quaternion> alignments;
+    };
+
+    static constexpr size_t LINEAR_BONE_ALIGNMENT = 64;
+
     /**
      * A reference to a VTF file used by the model.
      */
@@ -120,16 +158,177 @@ namespace MdlParser {
       int32_t flags;
     };
 
+    /**
+     * Metadata for a single animation. The keyframe data itself is not parsed.
+     */
+    struct Animation {
+      std::string name;
+
+      /**
+       * Playback rate in frames per second.
+       */
+      float fps;
+
+      /**
+       * Bitflags describing this animation. An enum is not currently provided with the possible values and their meanings.
+       */
+      int32_t flags;
+
+      int32_t frameCount;
+    };
+
+    /**
+     * An event fired when a sequence's playback passes a given point, such as a footstep sound.
+     */
+    struct Event {
+      /**
+       * Point in the sequence (from 0 to 1) at which the event fires.
+       */
+      float cycle;
+
+      /**
+       * Numeric identifier of the event, for old style events which are not referred to by name.
+       */
+      int32_t event;
+
+      /**
+       * Bitflags describing the event. An enum is not currently provided with the possible values and their meanings.
+       */
+      int32_t type;
+
+      /**
+       * Event specific parameters, e.g. the name of the sound to play.
+       */
+      std::string options;
+
+      /**
+       * The name of the event (e.g. AE_CL_PLAYSOUND), or empty for old style numeric events.
+       */
+      std::string name;
+    };
+
+    /**
+     * A sequence which can be played on the model, blending between one or more animations.
+     */
+    struct Sequence {
+      /**
+       * The name the sequence is looked up by.
+       */
+      std::string name;
+
+      /**
+       * The name of the activity this sequence can be chosen for (e.g. ACT_WALK), or empty if it has none.
+       */
+      std::string activityName;
+
+      /**
+       * Index of the activity in the model's activity list. Only meaningful to the game, use activityName instead.
+       */
+      int32_t activity;
+
+      /**
+       * Bitflags describing this sequence. An enum is not currently provided with the possible values and their meanings.
+       */
+      int32_t flags;
+
+      /**
+       * Relative weight of this sequence when randomly choosing between sequences with the same activity.
+       * The engine uses the absolute value, so negative weights are as likely to be chosen as positive ones.
+       */
+      int32_t activityWeight;
+
+      /**
+       * Playback rate in frames per second, taken from the sequence's first animation (0 if it has none).
+       */
+      float fps;
+
+      /**
+       * Number of frames, taken from the sequence's first animation (0 if it has none).
+       */
+      int32_t frameCount;
+
+      /**
+       * The events fired while playing this sequence.
+       */
+      std::vector<Event> events;
+
+      /**
+       * Indices into getAnimations() of the same model for each point in the sequence's blend grid, row-major.
+       */
+      std::vector<int16_t> animations;
+    };
+
+    /**
+     * A named point attached to a bone, such as a weapon's muzzle or a character's eyes.
+     */
+    struct Attachment {
+      std::string name;
+
+      /**
+       * Bitflags describing this attachment. An enum is not currently provided with the possible values and their meanings.
+       */
+      uint32_t flags;
+
+      /**
+       * Index of the bone the attachment is attached to.
+       */
+      int32_t bone;
+
+      /**
+       * Transform of the attachment relative to its bone.
+       */
+      Structs::Matrix3x4 local;
+    };
+
+    /**
+     * A reference to another model, usually shared between many models, whose animations and sequences this one uses.
+     * @remarks These are resolved into a single set of sequences using VirtualModel.
+     */
+    struct IncludeModel {
+      std::string label;
+
+      /**
+       * Path to the included .mdl file, relative to the game's root (e.g. models/humans/female_shared.mdl).
+       */
+      std::string name;
+    };
+
     /**
      * Parses a .mdl file contained in the given buffer into an easier to use and more modern structure.
      * No ownership of the data is taken but all contents are copied into new structs, so the Mdl instance may outlive data.
      *
      * @param data
      * @param checksum Optional checksum to validate against the header's
+     * @param stats Optional sink for statistics about the parse
+     * @param limits Limits on the memory the parse may allocate
+     * @param boneNameIndex Optional index previously written by BoneNameIndex::serialize() for this model, used instead
+     * of building one. Ignored (and the index built as usual) if it is invalid or does not match the model's bones.
      */
     explicit Mdl(
       std::span<const std::byte> data,
-      const std::optional<int32_t>& checksum = std::nullopt
+      const std::optional<int32_t>& checksum = std::nullopt,
+      ParseStats* stats = nullptr,
+      const ParseLimits& limits = {},
+      std::span<const std::byte> boneNameIndex = {}
+    );
+
+    /**
+     * Parses a .mdl file in the same way as the constructor, but returns any error instead of throwing it.
+     * Prefer this when parsing untrusted data where failures are expected to be common.
+     *
+     * @param data
+     * @param checksum Optional checksum to validate against the header's
+     * @param stats Optional sink for statistics about the parse
+     * @param limits Limits on the memory the parse may allocate
+     * @param boneNameIndex Optional serialized bone name index, as in the constructor
+     * @return The parsed Mdl, or the reason and offset parsing failed at.
+     */
+    [[nodiscard]] static Errors::Expected<Mdl> tryParse(
+      std::span<const std::byte> data,
+      const std::optional<int32_t>& checksum = std::nullopt,
+      ParseStats* stats = nullptr,
+      const ParseLimits& limits = {},
+      std::span<const std::byte> boneNameIndex = {}
     );
 
     /**
@@ -171,6 +370,16 @@ namespace MdlParser {
      */
     [[nodiscard]] const std::vector<std::vector<int16_t>>& getSkinLookupTable() const;
 
+    /**
+     * Resolves a mesh's material to a texture through a family of the skin lookup table, as the engine does.
+     * @remarks Models without a skin lookup table use the material as the texture index directly.
+     * @param skinFamily Row of the skin lookup table.
+     * @param material Column of the skin lookup table, as in Mesh::material.
+     * @return Index of the texture in getTextures(), or nullopt if the skin family, material or texture is out of
+     * range.
+     */
+    [[nodiscard]] std::optional<size_t> resolveTexture(size_t skinFamily, int32_t material) const;
+
     /**
      * Gets the list of bones in the model.
      * @remarks Models which you wouldn't expect to be rigged may still have a root bone,
@@ -179,7 +388,107 @@ namespace MdlParser {
      */
     [[nodiscard]] const std::vector<Bone>& getBones() const;
 
+    /**
+     * Gets the bones as a structure of arrays, read from the model's linear bone table (in its second header) when it
+     * has one, otherwise built from getBones() when the model is parsed.
+     * @return Spans into storage owned by the Mdl, valid for its lifetime.
+     */
+    [[nodiscard]] LinearBones getLinearBones() const;
+
+    /**
+     * Finds a bone by name, ignoring case as the engine does.
+     * @remarks Uses a minimal perfect hash built when the model is parsed or loaded from a serialized index (or an
+     * ordinary hash table if none could be found), so is O(1) and does not allocate.
+     * @param name
+     * @return Index of the bone in getBones(), or nullopt if there is no bone with that name.
+     */
+    [[nodiscard]] std::optional<size_t> findBone(std::string_view name) const;
+
+    /**
+     * Gets the perfect hash of bone names used by findBone(), e.g. to serialize it alongside a cached model and pass
+     * it back to the constructor or tryParse() the next time the model is parsed.
+     * @return The bone name index, which is empty if no perfect hash could be found for the bone names.
+     */
+    [[nodiscard]] const BoneNameIndex& getBoneNameIndex() const;
+
+    /**
+     * Gets the animations stored in this model.
+     * @remarks Models which include others (see getIncludeModels()) may have few or no animations of their own.
+     * @return List of animations.
+     */
+    [[nodiscard]] const std::vector<Animation>& getAnimations() const;
+
+    /**
+     * Gets the sequences stored in this model, excluding any from included models.
+     * @return List of sequences.
+     */
+    [[nodiscard]] const std::vector<Sequence>& getSequences() const;
+
+    /**
+     * Gets the attachments on this model.
+     * @return List of attachments.
+     */
+    [[nodiscard]] const std::vector<Attachment>& getAttachments() const;
+
+    /**
+     * Finds an attachment by name, ignoring case.
+     * @remarks Uses a hash table built when the model is parsed, so does not allocate and is cheap to call every tick.
+     * @param name
+     * @return Index of the attachment in getAttachments(), or nullopt if there is no attachment with that name.
+     */
+    [[nodiscard]] std::optional<size_t> findAttachment(std::string_view name) const;
+
+    /**
+     * Finds a sequence by name, ignoring case.
+     * @remarks Uses a hash table built when the model is parsed, so does not allocate.
+     * Sequences from included models are not searched, use VirtualModel::findSequence for those.
+     * @param name
+     * @return Index of the sequence in getSequences(), or nullopt if there is no sequence with that name.
+     */
+    [[nodiscard]] std::optional<size_t> findSequence(std::string_view name) const;
+
+    /**
+     * Gets the sequences which can be chosen for an activity (e.g. ACT_WALK), ignoring case.
+     * @param activityName
+     * @return Indices into getSequences(), in order, or an empty span if no sequence has the activity.
+     */
+    [[nodiscard]] std::span<const int32_t> getActivitySequences(std::string_view activityName) const;
+
+    /**
+     * Randomly chooses a sequence for an activity, weighting each by its activityWeight as the engine does.
+     * @remarks Uses a cumulative weight table built when the model is parsed, so is O(log n) and does not allocate.
+     * @param activityName
+     * @param random A uniformly distributed random number in [0, 1). Values outside it are clamped, with NaN treated
+     * as 0.
+     * @return Index of the chosen sequence in getSequences(), or nullopt if no sequence with the activity has weight.
+     */
+    [[nodiscard]] std::optional<size_t> selectWeightedSequence(std::string_view activityName, float random) const;
+
+    /**
+     * Gets the text of the model's $keyvalues block (e.g. prop_data), or an empty string if it has none.
+     * @remarks Parse it with KeyValues, which keeps views into this text rather than copying it.
+     * @return KeyValues text, valid for the lifetime of the Mdl.
+     */
+    [[nodiscard]] std::string_view getKeyValues() const;
+
+    /**
+     * Gets the other models this model pulls animations and sequences from.
+     * @return List of included models.
+     */
+    [[nodiscard]] const std::vector<IncludeModel>& getIncludeModels() const;
+
+    /**
+     * Gets the number of bytes of memory used by this instance, including everything it has allocated on the heap.
+     * @return Memory usage in bytes.
+     */
+    [[nodiscard]] size_t getMemoryUsage() const;
+
   private:
+    Mdl() = default;
+
+    void buildSequenceIndices();
+    [[nodiscard]] std::optional<size_t> findActivity(std::string_view activityName) const;
+
     Structs::Mdl::Header header;
     std::optional<Structs::Mdl::Header2> header2;
 
@@ -190,5 +499,44 @@ namespace MdlParser {
     std::vector<std::vector<int16_t>> skins;
 
     std::vector<Bone> bones;
+    BoneNameIndex boneNameIndex;
+
+    /**
+     * Open addressing table used by findBone() in place of boneNameIndex if no perfect hash could be found for it.
+     */
+    std::vector<int32_t> boneNameLookup;
+
+    /**
+     * Storage for every array of getLinearBones(), each starting on a LINEAR_BONE_ALIGNMENT byte boundary.
+     */
+    std::vector<std::byte, AlignedAllocator<std::byte, LINEAR_BONE_ALIGNMENT>> linearBones;
+
+    std::vector<Animation> animations;
+    std::vector<Sequence> sequences;
+    std::vector<int32_t> sequenceLookup;
+
+    /**
+     * The sequences with an activity, grouped by activity in order of each activity's first sequence.
+     */
+    std::vector<int32_t> activitySequences;
+    /**
+     * Running total of the (absolute) weights of the sequences in activitySequences, restarting for each activity.
+     */
+    std::vector<uint64_t> activityCumulativeWeights;
+    /**
+     * Offset and count in activitySequences of each activity.
+     */
+    std::vector<std::pair<uint32_t, uint32_t>> activityRanges;
+    std::vector<int32_t> activityLookup;
+
+    std::vector<IncludeModel> includeModels;
+
+    std::string keyValues;
+
+    std::vector<Attachment> attachments;
+    /**
+     * Open addressing hash table of indices into attachments (or -1 for empty slots), sized to a power of two.
+     */
+    std::vector<int32_t> attachmentLookup;
   };
 }
@@ -0,0 +1,163 @@
+#include "model-cache.hpp"
+#include "errors.hpp"
+#include "helpers/normalise-path.hpp"
+
+namespace MdlParser {
+  size_t ModelCache::KeyHash::operator()(const Key& key) const {
+    return std::hash<std::string>()(key.path) ^ (std::hash<int32_t>()(key.checksum) * 0x9e3779b97f4a7c15);
+  }
+
+  ModelCache::ModelCache(Loader loader, const size_t byteBudget)
+    : loader(std::move(loader)), shardByteBudget(byteBudget / SHARD_COUNT) {}
+
+  std::shared_ptr<const ModelTriple> ModelCache::get(
+    const std::string_view path,
+    const std::optional<int32_t> checksum
+  ) {
+    auto normalised = getNormalisedPath(path);
+    auto& shard = getShard(normalised);
+
+    std::promise<std::shared_ptr<const ModelTriple>> promise;
+    std::shared_future<std::shared_ptr<const ModelTriple>> model;
+    bool isLoader = false;
+
+    {
+      std::scoped_lock lock(shard.mutex);
+
+      auto wantedChecksum = checksum;
+      if (!wantedChecksum) {
+        const auto latest = shard.latestChecksums.find(normalised);
+        if (latest != shard.latestChecksums.end()) {
+          wantedChecksum = latest->second;
+        }
+      }
+
+      if (wantedChecksum) {
+        const auto entry = shard.entries.find(Key{ .path = normalised, .checksum = *wantedChecksum });
+        if (entry != shard.entries.end()) {
+          shard.lru.splice(shard.lru.begin(), shard.lru, entry->second.lruPosition);
+          return entry->second.model;
+        }
+      }
+
+      auto [loading, inserted] = shard.loading.try_emplace(normalised);
+      if (inserted) {
+        loading->second = promise.get_future().share();
+        isLoader = true;
+      }
+
+      model = loading->second;
+    }
+
+    if (isLoader) {
+      try {
+        const auto files = loader(normalised);
+        auto parsed = std::make_shared<const ModelTriple>(files.mdl, files.vtx, files.vvd);
+
+        {
+          std::scoped_lock lock(shard.mutex);
+          shard.loading.erase(normalised);
+          insertLocked(shard, normalised, parsed);
+        }
+        promise.set_value(std::move(parsed));
+      } catch (...) {
+        {
+          std::scoped_lock lock(shard.mutex);
+          shard.loading.erase(normalised);
+        }
+        promise.set_exception(std::current_exception());
+      }
+    }
+
+    auto loaded = model.get();
+    if (checksum && loaded->mdl.getChecksum() != *checksum) {
+      throw Errors::InvalidChecksum("Loaded model checksum does not match the version requested");
+    }
+
+    return loaded;
+  }
+
+  void ModelCache::insert(const std::string_view path, std::shared_ptr<const ModelTriple> model) {
+    const auto normalised = getNormalisedPath(path);
+    auto& shard = getShard(normalised);
+
+    std::scoped_lock lock(shard.mutex);
+    insertLocked(shard, normalised, std::move(model));
+  }
+
+  size_t ModelCache::getMemoryUsage() const {
+    size_t bytes = 0;
+    for (const auto& shard : shards) {
+      std::scoped_lock lock(shard.mutex);
+      bytes += shard.bytes;
+    }
+
+    return bytes;
+  }
+
+  size_t ModelCache::getModelCount() const {
+    size_t count = 0;
+    for (const auto& shard : shards) {
+      std::scoped_lock lock(shard.mutex);
+      count += shard.entries.size();
+    }
+
+    return count;
+  }
+
+  void ModelCache::clear() {
+    for (auto& shard : shards) {
+      std::scoped_lock lock(shard.mutex);
+      shard.entries.clear();
+      shard.latestChecksums.clear();
+      shard.lru.clear();
+      shard.bytes = 0;
+    }
+  }
+
+  ModelCache::Shard& ModelCache::getShard(const std::string& normalisedPath) {
+    return shards[std::hash<std::string>()(normalisedPath) % SHARD_COUNT];
+  }
+
+  const ModelCache::Shard& ModelCache::getShard(const std::string& normalisedPath) const {
+    return shards[std::hash<std::string>()(normalisedPath) % SHARD_COUNT];
+  }
+
+  void ModelCache::insertLocked(
+    Shard& shard,
+    const std::string& normalisedPath,
+    std::shared_ptr<const ModelTriple> model
+  ) {
+    Key key{ .path = normalisedPath, .checksum = model->mdl.getChecksum() };
+    const auto bytes = model->getMemoryUsage();
+
+    if (const auto existing = shard.entries.find(key); existing != shard.entries.end()) {
+      shard.bytes -= existing->second.bytes;
+      shard.lru.erase(existing->second.lruPosition);
+      shard.entries.erase(existing);
+    }
+
+    shard.lru.push_front(key);
+    shard.latestChecksums.insert_or_assign(normalisedPath, key.checksum);
+    shard.entries.emplace(
+      std::move(key),
+      Entry{ .model = std::move(model), .bytes = bytes, .lruPosition = shard.lru.begin() }
+    );
+    shard.bytes += bytes;
+
+    // The model just inserted is kept even if it alone exceeds the budget, so it is not reloaded on every request
+    while (shard.bytes > shardByteBudget && shard.lru.size() > 1) {
+      const auto& evictedKey = shard.lru.back();
+      const auto evicted = shard.entries.find(evictedKey);
+      shard.bytes -= evicted->second.bytes;
+
+      const auto latest = shard.latestChecksums.find(evictedKey.path);
+      if (latest != shard.latestChecksums.end() && latest->second == evictedKey.checksum) {
+        shard.latestChecksums.erase(latest);
+      }
+
+      shard.entries.erase(evicted);
+      shard.lru.pop_back();
+    }
+  }
+}
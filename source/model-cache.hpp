@@ -0,0 +1,146 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "model-triple.hpp"
+
+namespace MdlParser {
+  /**
+   * Thread-safe cache of parsed models, shared between every subsystem which needs the same model.
+   *
+   * Models are keyed by path and MDL checksum, so a model recompiled on disk is cached separately from the version
+   * already in use. Entries are split into shards by path, each with its own lock and least recently used list, so
+   * lookups of different models rarely contend. Once the memory used by a shard's models exceeds its share of the
+   * budget, its least recently used models are dropped. Dropped models stay alive until their last user releases them.
+   */
+  class ModelCache {
+  public:
+    static constexpr size_t SHARD_COUNT = 16;
+
+    /**
+     * The raw contents of the three files making up a model.
+     */
+    struct Files {
+      std::vector<std::byte> mdl;
+      std::vector<std::byte> vtx;
+      std::vector<std::byte> vvd;
+    };
+
+    /**
+     * Reads the three files of a model given the normalised path of its .mdl file
+     * (e.g. models/props_c17/oildrum001.mdl).
+     * Should throw if the files cannot be read.
+     */
+    using Loader = std::function<Files(const std::string& path)>;
+
+    /**
+     * Creates an empty cache.
+     * @param loader Function used to read models which are not yet cached.
+     * @param byteBudget Total memory (as reported by ModelTriple::getMemoryUsage) the cached models may use,
+     * split evenly between the shards.
+     */
+    ModelCache(Loader loader, size_t byteBudget);
+
+    /**
+     * Gets the parsed model at the given path, loading and parsing it if it is not cached.
+     * Concurrent requests for the same uncached path wait for a single load rather than each parsing it.
+     * @remarks Failed loads are not cached, so a later request for the same path will try again.
+     * @param path Path to the .mdl file. Case and slashes are normalised.
+     * @param checksum The MDL checksum of the version wanted, or nullopt for the most recently loaded version.
+     * @return The shared parsed model.
+     * @throws Errors::InvalidChecksum if the model loaded does not have the checksum requested.
+     * @throws Errors::Error if the model is malformed, or any exception thrown by the loader.
+     */
+    [[nodiscard]] std::shared_ptr<const ModelTriple> get(
+      std::string_view path,
+      std::optional<int32_t> checksum = std::nullopt
+    );
+
+    /**
+     * Adds an already parsed model to the cache (e.g. after reloading it), making it the most recent version of path.
+     * @param path Path to the .mdl file. Case and slashes are normalised.
+     * @param model
+     */
+    void insert(std::string_view path, std::shared_ptr<const ModelTriple> model);
+
+    /**
+     * Gets the total memory used by the cached models, in bytes.
+     */
+    [[nodiscard]] size_t getMemoryUsage() const;
+
+    /**
+     * Gets the number of models currently cached (excluding any being loaded).
+     */
+    [[nodiscard]] size_t getModelCount() const;
+
+    /**
+     * Drops the cache's references to all models.
+     */
+    void clear();
+
+  private:
+    struct Key {
+      std::string path;
+      int32_t checksum;
+
+      bool operator==(const Key&) const = default;
+    };
+
+    struct KeyHash {
+      size_t operator()(const Key& key) const;
+    };
+
+    struct Entry {
+      std::shared_ptr<const ModelTriple> model;
+      size_t bytes;
+
+      /**
+       * Position of the entry's key in the shard's least recently used list.
+       */
+      std::list<Key>::iterator lruPosition;
+    };
+
+    struct Shard {
+      mutable std::mutex mutex;
+
+      std::unordered_map<Key, Entry, KeyHash> entries;
+
+      /**
+       * The checksum of the most recently loaded version of each path.
+       */
+      std::unordered_map<std::string, int32_t> latestChecksums;
+
+      std::unordered_map<std::string, std::shared_future<std::shared_ptr<const ModelTriple>>> loading;
+
+      /**
+       * Keys of the entries, most recently used first.
+       */
+      std::list<Key> lru;
+
+      size_t bytes = 0;
+    };
+
+    Loader loader;
+    size_t shardByteBudget;
+    std::array<Shard, SHARD_COUNT> shards;
+
+    Shard& getShard(const std::string& normalisedPath);
+    const Shard& getShard(const std::string& normalisedPath) const;
+
+    /**
+     * Adds a model to a locked shard, then evicts least recently used models until the shard fits its budget.
+     */
+    void insertLocked(Shard& shard, const std::string& normalisedPath, std::shared_ptr<const ModelTriple> model);
+  };
+}
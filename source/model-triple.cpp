@@ -0,0 +1,53 @@
+#include "model-triple.hpp"
+
+namespace MdlParser {
+  ModelPaths ModelPaths::fromMdl(const std::filesystem::path& mdlPath, const std::filesystem::path& vtxExtension) {
+    return {
+      .mdl = mdlPath,
+      .vtx = std::filesystem::path(mdlPath).replace_extension(vtxExtension),
+      .vvd = std::filesystem::path(mdlPath).replace_extension(".vvd"),
+    };
+  }
+
+  ModelTriple::ModelTriple(
+    const std::span<const std::byte> mdlData,
+    const std::span<const std::byte> vtxData,
+    const std::span<const std::byte> vvdData,
+    ParseStats* stats,
+    const ParseLimits& limits
+  )
+    : ModelTriple(valueOrThrow(tryParse(mdlData, vtxData, vvdData, stats, limits))) {}
+
+  ModelTriple::ModelTriple(Mdl mdl, Vtx vtx, Vvd vvd) : mdl(std::move(mdl)), vtx(std::move(vtx)), vvd(std::move(vvd)) {}
+
+  Errors::Expected<ModelTriple> ModelTriple::tryParse(
+    const std::span<const std::byte> mdlData,
+    const std::span<const std::byte> vtxData,
+    const std::span<const std::byte> vvdData,
+    ParseStats* stats,
+    const ParseLimits& limits
+  ) {
+    auto mdl = Mdl::tryParse(mdlData, std::nullopt, stats, limits);
+    if (!mdl) {
+      return std::unexpected(mdl.error());
+    }
+
+    auto vtx = Vtx::tryParse(vtxData, mdl->getChecksum(), stats, limits);
+    if (!vtx) {
+      return std::unexpected(vtx.error());
+    }
+
+    auto vvd = Vvd::tryParse(vvdData, mdl->getChecksum(), stats, limits);
+    if (!vvd) {
+      return std::unexpected(vvd.error());
+    }
+
+    return ModelTriple(std::move(*mdl), std::move(*vtx), std::move(*vvd));
+  }
+
+  size_t ModelTriple::getMemoryUsage() const {
+    // Any padding between the members is counted along with them
+    return sizeof(ModelTriple) - sizeof(Mdl) - sizeof(Vtx) - sizeof(Vvd) + mdl.getMemoryUsage() + vtx.getMemoryUsage() +
+      vvd.getMemoryUsage();
+  }
+}
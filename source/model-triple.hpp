@@ -0,0 +1,82 @@
+#pragma once
+
+#include <filesystem>
+#include <span>
+#include "mdl.hpp"
+#include "vtx.hpp"
+#include "vvd.hpp"
+
+namespace MdlParser {
+  /**
+   * Paths to the three files which together make up a single model.
+   */
+  struct ModelPaths {
+    std::filesystem::path mdl;
+    std::filesystem::path vtx;
+    std::filesystem::path vvd;
+
+    /**
+     * Derives the VTX and VVD paths from the path of a .mdl file, assuming they sit alongside it.
+     * @param mdlPath Path to the .mdl file.
+     * @param vtxExtension Extension of the VTX variant to use.
+     * @return Paths to all three files.
+     */
+    [[nodiscard]] static ModelPaths fromMdl(
+      const std::filesystem::path& mdlPath, const std::filesystem::path& vtxExtension = ".dx90.vtx"
+    );
+  };
+
+  /**
+   * A parsed MDL along with its VTX and VVD, validated against the MDL's checksum.
+   */
+  struct ModelTriple {
+    /**
+     * Parses all three files, checking the VTX and VVD checksums against the MDL's.
+     * As with the individual parsers, no ownership of the data is taken.
+     * @param mdlData
+     * @param vtxData
+     * @param vvdData
+     * @param stats Optional sink for statistics about the parse, shared between all three files
+     * @param limits Limits on the memory the parse may allocate, applied to each file separately
+     */
+    ModelTriple(
+      std::span<const std::byte> mdlData,
+      std::span<const std::byte> vtxData,
+      std::span<const std::byte> vvdData,
+      ParseStats* stats = nullptr,
+      const ParseLimits& limits = {}
+    );
+
+    /**
+     * Takes ownership of three already parsed files. Their checksums are not checked against each other.
+     */
+    ModelTriple(Mdl mdl, Vtx vtx, Vvd vvd);
+
+    /**
+     * Parses all three files in the same way as the constructor, but returns any error instead of throwing it.
+     * @param mdlData
+     * @param vtxData
+     * @param vvdData
+     * @param stats Optional sink for statistics about the parse, shared between all three files
+     * @param limits Limits on the memory the parse may allocate, applied to each file separately
+     * @return The parsed files, or the reason and offset the first failing file failed at.
+     */
+    [[nodiscard]] static Errors::Expected<ModelTriple> tryParse(
+      std::span<const std::byte> mdlData,
+      std::span<const std::byte> vtxData,
+      std::span<const std::byte> vvdData,
+      ParseStats* stats = nullptr,
+      const ParseLimits& limits = {}
+    );
+
+    /**
+     * Gets the number of bytes of memory used by all three files, including everything they have allocated on the heap.
+     * @return Memory usage in bytes.
+     */
+    [[nodiscard]] size_t getMemoryUsage() const;
+
+    Mdl mdl;
+    Vtx vtx;
+    Vvd vvd;
+  };
+}
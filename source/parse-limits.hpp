@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstddef>
+#include <limits>
+
+namespace MdlParser {
+  /**
+   * Limits on the resources a single parse may use, so that crafted files cannot exhaust memory.
+   *
+   * Counts in the files are always checked against the data remaining before anything is allocated for them, but
+   * structures may be referenced from several places, so a small file can still describe a very large model.
+   * The budget covers the parsed structures (not the input data) and a parse which would exceed it fails with
+   * Errors::Reason::AllocationLimitExceeded.
+   */
+  struct ParseLimits {
+    /**
+     * Bytes a parse may always allocate, however small the file.
+     */
+    size_t baseAllocationBytes = 16 * 1024 * 1024;
+
+    /**
+     * Bytes a parse may allocate for each byte of the file, on top of baseAllocationBytes.
+     */
+    size_t allocationBytesPerInputByte = 32;
+
+    /**
+     * Gets the budget for parsing a file of the given size.
+     */
+    [[nodiscard]] size_t getAllocationBudget(const size_t inputBytes) const {
+      constexpr auto unlimited = std::numeric_limits<size_t>::max();
+      if (allocationBytesPerInputByte != 0 &&
+          inputBytes > (unlimited - baseAllocationBytes) / allocationBytesPerInputByte) {
+        return unlimited;
+      }
+
+      return baseAllocationBytes + inputBytes * allocationBytesPerInputByte;
+    }
+  };
+}
@@ -0,0 +1,181 @@
+#include "parse-stats.hpp"
+#include <algorithm>
+
+namespace MdlParser {
+  namespace {
+    void writeJsonString(std::ostream& output, const std::string_view string) {
+      output << '"';
+
+      for (const auto character : string) {
+        switch (character) {
+          case '"':
+            output << "\\\"";
+            break;
+          case '\\':
+            output << "\\\\";
+            break;
+          case '\n':
+            output << "\\n";
+            break;
+          default:
+            if (static_cast<unsigned char>(character) < 0x20) {
+              output << ' ';
+            } else {
+              output << character;
+            }
+        }
+      }
+
+      output << '"';
+    }
+
+    double toMicroseconds(const ParseStats::Clock::duration duration) {
+      return std::chrono::duration<double, std::micro>(duration).count();
+    }
+  }
+
+  ParseStats::ParseStats(std::string label) : label(std::move(label)) {}
+
+  const std::string& ParseStats::getLabel() const {
+    return label;
+  }
+
+  const std::vector<ParseStats::Section>& ParseStats::getSections() const {
+    return sections;
+  }
+
+  const ParseStats::StringScanning& ParseStats::getStringScanning() const {
+    return stringScanning;
+  }
+
+  ParseStats::Section ParseStats::getTotal() const {
+    Section total{.name = "total", .depth = 0, .start = {}, .duration = {}};
+
+    for (const auto& section : sections) {
+      if (section.depth != 0) {
+        continue;
+      }
+
+      if (total.start == Clock::time_point{} || section.start < total.start) {
+        total.start = section.start;
+      }
+
+      total.duration += section.duration;
+      total.bytesTouched += section.bytesTouched;
+      total.elementCount += section.elementCount;
+      total.allocationCount += section.allocationCount;
+      total.bytesAllocated += section.bytesAllocated;
+    }
+
+    return total;
+  }
+
+  void ParseStats::reset() {
+    sections.clear();
+    openSections.clear();
+    stringScanning = {};
+  }
+
+  void ParseStats::writeChromeTrace(std::ostream& output) const {
+    const ParseStats* batch[] = {this};
+    writeChromeTrace(output, batch);
+  }
+
+  void ParseStats::writeChromeTrace(std::ostream& output, const std::span<const ParseStats* const> batch) {
+    auto epoch = Clock::time_point::max();
+    for (const auto* stats : batch) {
+      for (const auto& section : stats->sections) {
+        epoch = std::min(epoch, section.start);
+      }
+    }
+
+    output << "{\"traceEvents\":[";
+    bool first = true;
+
+    for (size_t track = 0; track < batch.size(); track++) {
+      const auto& stats = *batch[track];
+
+      if (!first) {
+        output << ',';
+      }
+      first = false;
+
+      output << R"({"name":"thread_name","ph":"M","pid":1,"tid":)" << track << R"(,"args":{"name":)";
+      writeJsonString(output, stats.label.empty() ? "parse " + std::to_string(track) : stats.label);
+      output << "}}";
+
+      for (const auto& section : stats.sections) {
+        output << R"(,{"name":)";
+        writeJsonString(output, section.name);
+        output << R"(,"cat":"parse","ph":"X","pid":1,"tid":)" << track;
+        output << R"(,"ts":)" << toMicroseconds(section.start - epoch);
+        output << R"(,"dur":)" << toMicroseconds(section.duration);
+        output << R"(,"args":{"bytesTouched":)" << section.bytesTouched;
+        output << R"(,"elementCount":)" << section.elementCount;
+        output << R"(,"allocationCount":)" << section.allocationCount;
+        output << R"(,"bytesAllocated":)" << section.bytesAllocated << "}}";
+      }
+    }
+
+    output << "],\"displayTimeUnit\":\"ns\"}";
+  }
+
+  size_t ParseStats::beginSection(const char* name) {
+    sections.push_back(
+      {
+        .name = name,
+        .depth = static_cast<uint32_t>(openSections.size()),
+        .start = Clock::now(),
+        .duration = {},
+      }
+    );
+    openSections.push_back(sections.size() - 1);
+
+    return sections.size() - 1;
+  }
+
+  void ParseStats::endSection(const size_t index) {
+    auto& section = sections[index];
+    section.duration = Clock::now() - section.start;
+
+    // Sections always close in reverse order thanks to StatsScope, so this is the top of the stack
+    openSections.pop_back();
+
+    if (auto* parent = getCurrentSection()) {
+      parent->bytesTouched += section.bytesTouched;
+      parent->elementCount += section.elementCount;
+      parent->allocationCount += section.allocationCount;
+      parent->bytesAllocated += section.bytesAllocated;
+    }
+  }
+
+  ParseStats::Section* ParseStats::getCurrentSection() {
+    return openSections.empty() ? nullptr : &sections[openSections.back()];
+  }
+
+  void ParseStats::addBytesTouched(const size_t bytes) {
+    if (auto* section = getCurrentSection()) {
+      section->bytesTouched += bytes;
+    }
+  }
+
+  void ParseStats::addElements(const size_t count) {
+    if (auto* section = getCurrentSection()) {
+      section->elementCount += count;
+    }
+  }
+
+  void ParseStats::addAllocation(const size_t bytes) {
+    if (auto* section = getCurrentSection()) {
+      section->allocationCount++;
+      section->bytesAllocated += bytes;
+    }
+  }
+
+  void ParseStats::addStringScan(const size_t bytes, const Clock::duration duration) {
+    stringScanning.stringCount++;
+    stringScanning.bytesScanned += bytes;
+    stringScanning.duration += duration;
+    addBytesTouched(bytes);
+  }
+}
@@ -0,0 +1,135 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <span>
+#include <string>
+#include <vector>
+
+#ifndef MDLPARSER_PARSE_STATS
+/**
+ * Set to 0 to compile out all parse statistics collection.
+ * ParseStats instances can still be passed to the parsers, but will never be populated.
+ */
+#define MDLPARSER_PARSE_STATS 1
+#endif
+
+namespace MdlParser {
+  class OffsetDataView;
+  class StatsScope;
+
+  /**
+   * Optional sink for timing and memory statistics gathered while parsing.
+   * Pass a pointer to one of these into the Mdl, Vtx or Vvd constructors to find out where time is being spent.
+   * @remarks Not thread-safe - use one instance per parse.
+   */
+  class ParseStats {
+  public:
+    using Clock = std::chrono::steady_clock;
+
+    /**
+     * A timed region of the parse, such as the MDL's bones or the VVD's fixups.
+     * Sections nest, with counters of inner sections also included in the sections enclosing them.
+     */
+    struct Section {
+      /**
+       * Static name of the section, for example "mdl.bones".
+       */
+      const char* name;
+
+      /**
+       * Nesting depth, with 0 being a top level section.
+       */
+      uint32_t depth;
+
+      Clock::time_point start;
+      Clock::duration duration;
+
+      /**
+       * Number of bytes of the source buffer read.
+       */
+      size_t bytesTouched = 0;
+
+      /**
+       * Number of elements (bones, vertices, etc.) parsed.
+       */
+      size_t elementCount = 0;
+
+      /**
+       * Number of heap allocations made for the parsed structure.
+       */
+      size_t allocationCount = 0;
+
+      /**
+       * Total size of the heap allocations made for the parsed structure.
+       */
+      size_t bytesAllocated = 0;
+    };
+
+    /**
+     * Time spent searching for and copying null-terminated strings, which is not attributed to a separate section.
+     */
+    struct StringScanning {
+      size_t stringCount = 0;
+      size_t bytesScanned = 0;
+      Clock::duration duration{};
+    };
+
+    /**
+     * @param label Human readable label for this parse (for example the model's path), used when writing traces.
+     */
+    explicit ParseStats(std::string label = {});
+
+    [[nodiscard]] const std::string& getLabel() const;
+
+    /**
+     * Gets all sections recorded so far, in the order they were started.
+     */
+    [[nodiscard]] const std::vector<Section>& getSections() const;
+
+    [[nodiscard]] const StringScanning& getStringScanning() const;
+
+    /**
+     * Sums the counters and durations of all top level sections.
+     */
+    [[nodiscard]] Section getTotal() const;
+
+    /**
+     * Clears all recorded statistics so the instance can be reused.
+     */
+    void reset();
+
+    /**
+     * Writes the recorded sections in the Chrome trace event JSON format (viewable in chrome://tracing or Perfetto).
+     * @param output
+     */
+    void writeChromeTrace(std::ostream& output) const;
+
+    /**
+     * Writes a batch of parses in the Chrome trace event JSON format, with each parse shown on its own track.
+     * @param output
+     * @param batch
+     */
+    static void writeChromeTrace(std::ostream& output, std::span<const ParseStats* const> batch);
+
+  private:
+    friend class OffsetDataView;
+    friend class StatsScope;
+
+    std::string label;
+    std::vector<Section> sections;
+    std::vector<size_t> openSections;
+    StringScanning stringScanning;
+
+    size_t beginSection(const char* name);
+    void endSection(size_t index);
+
+    Section* getCurrentSection();
+    void addBytesTouched(size_t bytes);
+    void addElements(size_t count);
+    void addAllocation(size_t bytes);
+    void addStringScan(size_t bytes, Clock::duration duration);
+  };
+}
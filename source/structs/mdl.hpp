@@ -144,7 +144,132 @@ namespace MdlParser::Structs::Mdl {
     int32_t modelsOffset;
   };
 
+  struct AnimDesc {
+    int32_t baseOffset;
+    int32_t szNameIndex;
+
+    float fps;
+    int32_t flags;
+
+    int32_t framesCount;
+
+    int32_t movementsCount;
+    int32_t movementsOffset;
+
+    std::array<int32_t, 6> unused0;
+
+    int32_t animBlock;
+    int32_t animOffset;
+
+    int32_t ikRulesCount;
+    int32_t ikRulesOffset;
+    int32_t animBlockIkRulesOffset;
+
+    int32_t localHierarchyCount;
+    int32_t localHierarchyOffset;
+
+    int32_t sectionOffset;
+    int32_t sectionFrames;
+
+    int16_t zeroFrameSpan;
+    int16_t zeroFrameCount;
+    int32_t zeroFrameOffset;
+
+    float zeroFrameStallTime;
+  };
+
+  struct Event {
+    float cycle;
+    int32_t event;
+    int32_t type;
+    std::array<char, 64> options;
+
+    int32_t szEventIndex;
+  };
+
+  struct SequenceDesc {
+    int32_t baseOffset;
+
+    int32_t szLabelIndex;
+    int32_t szActivityNameIndex;
+
+    int32_t flags;
+
+    int32_t activity;
+    int32_t activityWeight;
+
+    int32_t eventsCount;
+    int32_t eventsOffset;
+
+    Vector bbMin;
+    Vector bbMax;
+
+    int32_t blendsCount;
+    int32_t animIndexOffset; // Offset to a groupSize[0] * groupSize[1] array of int16 indices into the animations
+
+    int32_t movementOffset;
+
+    std::array<int32_t, 2> groupSize;
+    std::array<int32_t, 2> paramIndex;
+    std::array<float, 2> paramStart;
+    std::array<float, 2> paramEnd;
+    int32_t paramParent;
+
+    float fadeInTime;
+    float fadeOutTime;
+
+    int32_t localEntryNode;
+    int32_t localExitNode;
+    int32_t nodeFlags;
+
+    float entryPhase;
+    float exitPhase;
+
+    float lastFrame;
+
+    int32_t nextSequence;
+    int32_t pose;
+
+    int32_t ikRulesCount;
+
+    int32_t autoLayersCount;
+    int32_t autoLayersOffset;
+
+    int32_t weightListOffset;
+
+    int32_t poseKeyOffset;
+
+    int32_t ikLocksCount;
+    int32_t ikLocksOffset;
+
+    int32_t keyValueOffset;
+    int32_t keyValueSize;
+
+    int32_t cyclePoseIndex;
+
+    int32_t activityModifiersOffset;
+    int32_t activityModifiersCount;
+
+    std::array<int32_t, 5> unused;
+  };
+
+  struct Attachment {
+    int32_t szNameIndex;
+    uint32_t flags;
+
+    int32_t localBone;
+    Matrix3x4 local;
+
+    std::array<int32_t, 8> unused;
+  };
+
+  struct IncludeModel {
+    int32_t szLabelIndex;
+    int32_t szNameIndex;
+  };
+
   struct Header {
+    static constexpr int32_t FILE_ID = 'I' + ('D' << 8) + ('S' << 16) + ('T' << 24);
     static const int32_t MAX_SUPPORTED_VERSION = 48;
 
     int32_t id; // Model format ID (IDST)
@@ -284,5 +409,25 @@ namespace MdlParser::Structs::Mdl {
     std::array<int32_t, 56> reserved;
   };
 
+  /**
+   * Valve's structure-of-arrays copy of the bone table, pointed to by Header2::linearBoneOffset.
+   * Each offset is relative to the start of this struct.
+   */
+  struct LinearBone {
+    int32_t boneCount;
+
+    int32_t flagsOffset;
+    int32_t parentOffset;
+    int32_t posOffset;
+    int32_t quatOffset;
+    int32_t rotOffset;
+    int32_t poseToBoneOffset;
+    int32_t posScaleOffset;
+    int32_t rotScaleOffset;
+    int32_t qAlignmentOffset;
+
+    std::array<int32_t, 6> unused;
+  };
+
 #pragma pack(pop)
 }
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstdint>
+
+namespace MdlParser::Structs::Vpk {
+#pragma pack(push, 1)
+
+  struct Header {
+    static constexpr uint32_t SIGNATURE = 0x55aa1234;
+    static constexpr uint32_t MIN_SUPPORTED_VERSION = 1;
+    static constexpr uint32_t MAX_SUPPORTED_VERSION = 2;
+
+    uint32_t signature;
+    uint32_t version;
+
+    // Size of the directory tree following the header(s)
+    uint32_t treeSize;
+  };
+
+  // Follows Header when version is 2
+  struct HeaderV2 {
+    uint32_t fileDataSectionSize;
+    uint32_t archiveMd5SectionSize;
+    uint32_t otherMd5SectionSize;
+    uint32_t signatureSectionSize;
+  };
+
+  struct DirectoryEntry {
+    // Archive index used when the entry's data is stored in the directory file itself, after the tree
+    static constexpr uint16_t DIRECTORY_ARCHIVE_INDEX = 0x7fff;
+    static constexpr uint16_t TERMINATOR = 0xffff;
+
+    uint32_t crc;
+    uint16_t preloadBytes;
+
+    uint16_t archiveIndex;
+    uint32_t entryOffset;
+    uint32_t entryLength;
+
+    uint16_t terminator;
+  };
+
+#pragma pack(pop)
+}
@@ -16,6 +16,11 @@ namespace MdlParser::Structs::Vtx {
     std::array<int8_t, 3> boneId;
   };
 
+  struct BoneStateChange {
+    int32_t hardwareId;
+    int32_t newBoneId;
+  };
+
   struct Strip {
     int32_t numIndices;
     int32_t indexOffset;
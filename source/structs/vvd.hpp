@@ -10,6 +10,7 @@ namespace MdlParser::Structs::Vvd {
 #pragma pack(push, 1)
 
   struct Header {
+    static constexpr int32_t FILE_ID = 'I' + ('D' << 8) + ('S' << 16) + ('V' << 24);
     static constexpr int32_t SUPPORTED_VERSION = 4;
 
     int32_t id;
@@ -0,0 +1,940 @@
+#include "validator.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+#include "structs/mdl.hpp"
+#include "structs/vtx.hpp"
+#include "structs/vvd.hpp"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define MDLPARSER_VALIDATOR_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace MdlParser::Validation {
+  namespace MdlFormat = Structs::Mdl;
+  namespace VtxFormat = Structs::Vtx;
+  namespace VvdFormat = Structs::Vvd;
+
+  namespace {
+    constexpr float WEIGHT_SUM_TOLERANCE = 0.01f;
+
+    static_assert(sizeof(VvdFormat::Vertex) == 48, "VVD vertex scan assumes the packed 48 byte layout");
+    static_assert(sizeof(Structs::Vector4D) == 16, "VVD tangent scan assumes the packed 16 byte layout");
+
+    /**
+     * Bounds checked, non-throwing reads from a file which never trust offsets or counts from the data.
+     */
+    class Reader {
+    public:
+      Reader(const std::span<const std::byte> data, const File file, Report& report)
+        : data(data), file(file), report(report) {}
+
+      [[nodiscard]] std::span<const std::byte> getData() const {
+        return data;
+      }
+
+      [[nodiscard]] bool contains(const int64_t offset, const int64_t size) const {
+        return offset >= 0 && size >= 0 && static_cast<uint64_t>(offset) <= data.size()
+          && static_cast<uint64_t>(size) <= data.size() - static_cast<uint64_t>(offset);
+      }
+
+      /**
+       * Checks an array of count elements of type T at offset lies within the file, reporting if not.
+       */
+      template <typename T>
+      bool checkArray(const int64_t offset, const int64_t count, const char* message) const {
+        if (count < 0 || (count > 0 && !contains(offset, count * static_cast<int64_t>(sizeof(T))))) {
+          addIssue(IssueType::OutOfBounds, offset, message);
+          return false;
+        }
+
+        return true;
+      }
+
+      template <typename T>
+      bool read(const int64_t offset, T& value, const char* message) const {
+        if (!contains(offset, sizeof(T))) {
+          addIssue(IssueType::OutOfBounds, offset, message);
+          return false;
+        }
+
+        std::memcpy(&value, &data[offset], sizeof(T));
+        return true;
+      }
+
+      bool checkString(const int64_t offset, const char* message) const {
+        if (!contains(offset, 1) || std::memchr(&data[offset], 0, data.size() - offset) == nullptr) {
+          addIssue(IssueType::OutOfBounds, offset, message);
+          return false;
+        }
+
+        return true;
+      }
+
+      void addIssue(const IssueType type, const int64_t offset, const char* message) const {
+        if (report.issueCount < Report::MAX_RECORDED_ISSUES) {
+          report.issues[report.issueCount] = {
+            .type = type,
+            .file = file,
+            .offset = offset < 0 ? 0 : static_cast<size_t>(offset),
+            .message = message,
+          };
+        }
+
+        report.issueCount++;
+      }
+
+    private:
+      std::span<const std::byte> data;
+      File file;
+      Report& report;
+    };
+
+    template <typename T>
+    int64_t elementOffset(const int64_t arrayOffset, const int64_t index) {
+      return arrayOffset + index * static_cast<int64_t>(sizeof(T));
+    }
+
+    struct VvdSummary {
+      bool valid = false;
+      int64_t vertexCount = 0;
+    };
+
+    /**
+     * Checks an array of structs which each start with the offset of a name relative to themselves.
+     */
+    template <typename T>
+    void validateNamedArray(
+      const Reader& mdl,
+      const int64_t arrayOffset,
+      const int64_t count,
+      const char* arrayMessage,
+      const char* nameMessage
+    ) {
+      if (!mdl.checkArray<T>(arrayOffset, count, arrayMessage)) {
+        return;
+      }
+
+      for (int64_t i = 0; i < count; i++) {
+        const auto offset = elementOffset<T>(arrayOffset, i);
+        T element{};
+        mdl.read(offset, element, arrayMessage);
+        mdl.checkString(offset + element.szNameIndex, nameMessage);
+      }
+    }
+
+    template <typename T>
+    void checkLinearBoneArray(
+      const Reader& mdl, const int64_t tableOffset, const int32_t arrayOffset, const int32_t count
+    ) {
+      if (arrayOffset < 0) {
+        mdl.addIssue(IssueType::OutOfBounds, tableOffset, "MDL linear bone array is outside the file");
+        return;
+      }
+
+      mdl.checkArray<T>(tableOffset + arrayOffset, count, "MDL linear bone array is outside the file");
+    }
+
+    void validateLinearBones(const Reader& mdl, const int64_t offset, const int32_t boneCount) {
+      MdlFormat::LinearBone linearBone{};
+      if (!mdl.read(offset, linearBone, "MDL linear bone table is outside the file")) {
+        return;
+      }
+      if (linearBone.boneCount != boneCount) {
+        mdl.addIssue(IssueType::CountMismatch, offset, "MDL linear bone count does not match bone count");
+        return;
+      }
+
+      checkLinearBoneArray<int32_t>(mdl, offset, linearBone.flagsOffset, boneCount);
+      checkLinearBoneArray<int32_t>(mdl, offset, linearBone.parentOffset, boneCount);
+      checkLinearBoneArray<Structs::Vector>(mdl, offset, linearBone.posOffset, boneCount);
+      checkLinearBoneArray<Structs::Quaternion>(mdl, offset, linearBone.quatOffset, boneCount);
+      checkLinearBoneArray<Structs::RadianEuler>(mdl, offset, linearBone.rotOffset, boneCount);
+      checkLinearBoneArray<Structs::Matrix3x4>(mdl, offset, linearBone.poseToBoneOffset, boneCount);
+      checkLinearBoneArray<Structs::Vector>(mdl, offset, linearBone.posScaleOffset, boneCount);
+      checkLinearBoneArray<Structs::Vector>(mdl, offset, linearBone.rotScaleOffset, boneCount);
+      checkLinearBoneArray<Structs::Quaternion>(mdl, offset, linearBone.qAlignmentOffset, boneCount);
+    }
+
+    void validateSequences(const Reader& mdl, const MdlFormat::Header& header) {
+      using MdlFormat::SequenceDesc;
+
+      if (!mdl.checkArray<SequenceDesc>(
+          header.localSequenceOffset,
+          header.localSequenceCount,
+          "MDL sequence array is outside the file"
+      )) {
+        return;
+      }
+
+      for (int64_t i = 0; i < header.localSequenceCount; i++) {
+        const auto offset = elementOffset<SequenceDesc>(header.localSequenceOffset, i);
+        SequenceDesc sequence{};
+        mdl.read(offset, sequence, "MDL sequence is outside the file");
+        mdl.checkString(offset + sequence.szLabelIndex, "MDL sequence name is outside the file");
+        mdl.checkString(offset + sequence.szActivityNameIndex, "MDL sequence activity name is outside the file");
+
+        if (sequence.groupSize[0] < 0 || sequence.groupSize[1] < 0) {
+          mdl.addIssue(IssueType::OutOfBounds, offset, "MDL sequence blend grid size is negative");
+        } else {
+          mdl.checkArray<int16_t>(
+            offset + sequence.animIndexOffset,
+            static_cast<int64_t>(sequence.groupSize[0]) * sequence.groupSize[1],
+            "MDL sequence animation indices are outside the file"
+          );
+        }
+
+        if (!mdl.checkArray<MdlFormat::Event>(
+            offset + sequence.eventsOffset,
+            sequence.eventsCount,
+            "MDL sequence event array is outside the file"
+        )) {
+          continue;
+        }
+
+        for (int64_t j = 0; j < sequence.eventsCount; j++) {
+          const auto eventOffset = elementOffset<MdlFormat::Event>(offset + sequence.eventsOffset, j);
+          MdlFormat::Event event{};
+          mdl.read(eventOffset, event, "MDL sequence event is outside the file");
+
+          // Old style events have no name
+          if (event.szEventIndex != 0) {
+            mdl.checkString(eventOffset + event.szEventIndex, "MDL event name is outside the file");
+          }
+        }
+      }
+    }
+
+    void validateIncludeModels(const Reader& mdl, const MdlFormat::Header& header) {
+      using MdlFormat::IncludeModel;
+
+      if (!mdl.checkArray<IncludeModel>(
+          header.includeModelOffset,
+          header.includeModelCount,
+          "MDL include model array is outside the file"
+      )) {
+        return;
+      }
+
+      for (int64_t i = 0; i < header.includeModelCount; i++) {
+        const auto offset = elementOffset<IncludeModel>(header.includeModelOffset, i);
+        IncludeModel includeModel{};
+        mdl.read(offset, includeModel, "MDL include model is outside the file");
+        mdl.checkString(offset + includeModel.szLabelIndex, "MDL include model label is outside the file");
+        mdl.checkString(offset + includeModel.szNameIndex, "MDL include model name is outside the file");
+      }
+    }
+
+    bool validateMdlHeader(const Reader& mdl, MdlFormat::Header& header) {
+      using MdlFormat::Header;
+
+      if (!mdl.read(0, header, "MDL is too small to contain a header")) {
+        return false;
+      }
+      if (header.id != Header::FILE_ID) {
+        mdl.addIssue(IssueType::InvalidHeader, 0, "MDL header file ID does not match packed IDST");
+        return false;
+      }
+      if (header.version > Header::MAX_SUPPORTED_VERSION) {
+        mdl.addIssue(IssueType::UnsupportedVersion, 0, "MDL version is unsupported (greater than 48)");
+        return false;
+      }
+
+      MdlFormat::Header2 header2{};
+      const auto hasHeader2 = header.header2Offset >= static_cast<int32_t>(sizeof(Header))
+        && mdl.read(header.header2Offset, header2, "Second MDL header is outside the file");
+
+      if (mdl.checkArray<MdlFormat::Bone>(header.boneOffset, header.boneCount, "MDL bone array is outside the file")) {
+        for (int64_t i = 0; i < header.boneCount; i++) {
+          const auto offset = elementOffset<MdlFormat::Bone>(header.boneOffset, i);
+          MdlFormat::Bone bone{};
+          mdl.read(offset, bone, "MDL bone is outside the file");
+          mdl.checkString(offset + bone.szNameIndex, "MDL bone name is outside the file");
+
+          if (bone.parent < -1 || bone.parent >= header.boneCount) {
+            mdl.addIssue(IssueType::OutOfBounds, offset, "MDL bone parent does not exist");
+          }
+        }
+
+        if (hasHeader2 && header2.linearBoneOffset > 0 && header.boneCount > 0) {
+          validateLinearBones(
+            mdl, static_cast<int64_t>(header.header2Offset) + header2.linearBoneOffset, header.boneCount
+          );
+        }
+      }
+
+      if (mdl.checkArray<MdlFormat::Texture>(
+          header.textureOffset,
+          header.textureCount,
+          "MDL texture array is outside the file"
+      )) {
+        for (int64_t i = 0; i < header.textureCount; i++) {
+          const auto offset = elementOffset<MdlFormat::Texture>(header.textureOffset, i);
+          MdlFormat::Texture texture{};
+          mdl.read(offset, texture, "MDL texture is outside the file");
+          mdl.checkString(offset + texture.szNameIndex, "MDL texture name is outside the file");
+        }
+      }
+
+      if (mdl.checkArray<int32_t>(
+          header.textureDirOffset,
+          header.textureDirCount,
+          "MDL texture directory list is outside the file"
+      )) {
+        for (int64_t i = 0; i < header.textureDirCount; i++) {
+          int32_t directoryOffset = 0;
+          const auto offset = elementOffset<int32_t>(header.textureDirOffset, i);
+          mdl.read(offset, directoryOffset, "MDL texture directory is outside the file");
+          mdl.checkString(directoryOffset, "MDL texture directory is outside the file");
+        }
+      }
+
+      const auto skinTableSize = static_cast<int64_t>(header.skinRefCount) * header.skinFamilyCount;
+      if (header.skinRefCount < 0 || header.skinFamilyCount < 0) {
+        mdl.addIssue(IssueType::OutOfBounds, 0, "MDL skin table dimensions are negative");
+      } else {
+        mdl.checkArray<int16_t>(header.skinRefOffset, skinTableSize, "MDL skin table is outside the file");
+      }
+
+      validateNamedArray<MdlFormat::AnimDesc>(
+        mdl,
+        header.localAnimOffset,
+        header.localAnimCount,
+        "MDL animation array is outside the file",
+        "MDL animation name is outside the file"
+      );
+      validateSequences(mdl, header);
+      validateIncludeModels(mdl, header);
+      validateNamedArray<MdlFormat::Attachment>(
+        mdl,
+        header.attachmentOffset,
+        header.attachmentCount,
+        "MDL attachment array is outside the file",
+        "MDL attachment name is outside the file"
+      );
+
+      if (header.keyvalueCount > 0) {
+        mdl.checkArray<char>(header.keyvalueOffset, header.keyvalueCount, "MDL key values are outside the file");
+      }
+
+      return mdl.checkArray<MdlFormat::BodyPart>(
+          header.bodypartOffset,
+          header.bodypartCount,
+          "MDL body part array is outside the file"
+      );
+    }
+
+    bool validateVtxHeader(const Reader& vtx, const MdlFormat::Header& mdlHeader, VtxFormat::Header& header) {
+      using VtxFormat::Header;
+
+      if (!vtx.read(0, header, "VTX is too small to contain a header")) {
+        return false;
+      }
+      if (header.version != Header::SUPPORTED_VERSION) {
+        vtx.addIssue(IssueType::UnsupportedVersion, 0, "VTX version is unsupported");
+        return false;
+      }
+      if (header.checksum != mdlHeader.checksum) {
+        vtx.addIssue(IssueType::ChecksumMismatch, 0, "VTX checksum does not match MDL");
+      }
+      if (header.numLoDs < 0 || header.numLoDs > Limits::MAX_NUM_LODS) {
+        vtx.addIssue(IssueType::InvalidHeader, 0, "VTX LoD count is outside the supported range");
+        return false;
+      }
+
+      if (vtx.checkArray<VtxFormat::MaterialReplacementList>(
+          header.materialReplacementListOffset,
+          header.numLoDs,
+          "VTX material replacement lists are outside the file"
+      )) {
+        for (int64_t lod = 0; lod < header.numLoDs; lod++) {
+          const auto listOffset =
+            elementOffset<VtxFormat::MaterialReplacementList>(header.materialReplacementListOffset, lod);
+          VtxFormat::MaterialReplacementList list{};
+          vtx.read(listOffset, list, "VTX material replacement list is outside the file");
+
+          if (!vtx.checkArray<VtxFormat::MaterialReplacement>(
+              listOffset + list.replacementOffset,
+              list.replacementCount,
+              "VTX material replacements are outside the file"
+          )) {
+            continue;
+          }
+
+          for (int64_t i = 0; i < list.replacementCount; i++) {
+            const auto offset = elementOffset<VtxFormat::MaterialReplacement>(listOffset + list.replacementOffset, i);
+            VtxFormat::MaterialReplacement replacement{};
+            vtx.read(offset, replacement, "VTX material replacement is outside the file");
+            vtx.checkString(
+              offset + replacement.replacementMaterialNameOffset, "VTX material replacement name is outside the file"
+            );
+          }
+        }
+      }
+
+      if (header.numBodyParts != mdlHeader.bodypartCount) {
+        vtx.addIssue(IssueType::CountMismatch, 0, "VTX body part count does not match MDL");
+      }
+
+      return vtx.checkArray<VtxFormat::BodyPart>(
+          header.bodyPartOffset,
+          header.numBodyParts,
+          "VTX body part array is outside the file"
+      );
+    }
+
+    void validateVvdHeader(
+      const Reader& vvd, const MdlFormat::Header& mdlHeader, VvdFormat::Header& header, VvdSummary& summary
+    ) {
+      using VvdFormat::Header;
+
+      if (!vvd.read(0, header, "VVD is too small to contain a header")) {
+        return;
+      }
+      if (header.id != Header::FILE_ID) {
+        vvd.addIssue(IssueType::InvalidHeader, 0, "VVD header ID does not match IDSV");
+        return;
+      }
+      if (header.version != Header::SUPPORTED_VERSION) {
+        vvd.addIssue(IssueType::UnsupportedVersion, 0, "VVD version is unsupported");
+        return;
+      }
+      if (header.checksum != mdlHeader.checksum) {
+        vvd.addIssue(IssueType::ChecksumMismatch, 0, "VVD checksum does not match MDL");
+      }
+
+      const auto vertexCount = static_cast<int64_t>(header.numLoDVertices[0]);
+      if (vertexCount < 0 || header.numFixups < 0) {
+        vvd.addIssue(IssueType::InvalidHeader, 0, "VVD vertex or fixup count is negative");
+        return;
+      }
+
+      // The parser requires the whole of the data described by the header to fit, wherever the arrays are placed
+      const auto describedSize = static_cast<int64_t>(sizeof(Header))
+        + static_cast<int64_t>(sizeof(VvdFormat::Fixup)) * header.numFixups
+        + static_cast<int64_t>(sizeof(Structs::Vector4D) + sizeof(VvdFormat::Vertex)) * vertexCount;
+      if (describedSize > static_cast<int64_t>(vvd.getData().size())) {
+        vvd.addIssue(IssueType::InvalidHeader, 0, "Size of VVD with given number of vertices exceeds data size");
+        return;
+      }
+
+      const auto verticesValid =
+        vvd.checkArray<VvdFormat::Vertex>(header.vertexDataOffset, vertexCount, "VVD vertex data is outside the file");
+      const auto tangentsValid = vvd.checkArray<Structs::Vector4D>(
+        header.tangentDataOffset, vertexCount, "VVD tangent data is outside the file"
+      );
+      if (!verticesValid || !tangentsValid) {
+        return;
+      }
+
+      summary.valid = true;
+      summary.vertexCount = vertexCount;
+
+      if (header.numFixups > 0
+          && vvd.checkArray<VvdFormat::Fixup>(
+              header.fixupTableOffset,
+              header.numFixups,
+              "VVD fixup table is outside the file"
+          )) {
+        int64_t fixedUpVertexCount = 0;
+        for (int64_t i = 0; i < header.numFixups; i++) {
+          const auto offset = elementOffset<VvdFormat::Fixup>(header.fixupTableOffset, i);
+          VvdFormat::Fixup fixup{};
+          vvd.read(offset, fixup, "VVD fixup is outside the file");
+
+          if (fixup.sourceVertexId < 0 || fixup.numVertices < 0
+              || static_cast<int64_t>(fixup.sourceVertexId) + fixup.numVertices > vertexCount) {
+            vvd.addIssue(IssueType::InvalidVertexReference, offset, "VVD fixup accesses outside vertex data");
+            continue;
+          }
+
+          // Fixups may overlap, but together must not produce more vertices than the root LoD has
+          if (fixup.lod >= 0 && fixup.numVertices > 0) {
+            fixedUpVertexCount += fixup.numVertices;
+            if (fixedUpVertexCount > vertexCount) {
+              vvd.addIssue(
+                IssueType::InvalidVertexReference, offset, "VVD fixups produce more vertices than the level of detail"
+              );
+              break;
+            }
+          }
+        }
+      }
+    }
+
+    void validateStripGroup(
+      const Reader& vtx, const int64_t offset, const VtxFormat::StripGroup& stripGroup, const int32_t meshVertexCount
+    ) {
+      if (vtx.checkArray<VtxFormat::Vertex>(
+          offset + stripGroup.vertOffset,
+          stripGroup.numVerts,
+          "VTX vertex array is outside the file"
+      )) {
+        const auto* vertices = &vtx.getData()[offset + stripGroup.vertOffset];
+
+        for (int64_t i = 0; i < stripGroup.numVerts; i++) {
+          uint16_t origMeshVertId;
+          std::memcpy(
+            &origMeshVertId,
+            vertices + i * sizeof(VtxFormat::Vertex) + offsetof(VtxFormat::Vertex, origMeshVertId),
+            sizeof(origMeshVertId)
+          );
+
+          if (origMeshVertId >= meshVertexCount) {
+            vtx.addIssue(
+              IssueType::InvalidVertexReference,
+              elementOffset<VtxFormat::Vertex>(offset + stripGroup.vertOffset, i),
+              "VTX vertex references a vertex outside its MDL mesh"
+            );
+          }
+        }
+      }
+
+      if (vtx.checkArray<uint16_t>(
+          offset + stripGroup.indexOffset,
+          stripGroup.numIndices,
+          "VTX index array is outside the file"
+      )) {
+        const auto* indices = &vtx.getData()[offset + stripGroup.indexOffset];
+
+        for (int64_t i = 0; i < stripGroup.numIndices; i++) {
+          uint16_t index;
+          std::memcpy(&index, indices + i * sizeof(uint16_t), sizeof(index));
+
+          if (index >= stripGroup.numVerts) {
+            vtx.addIssue(
+              IssueType::InvalidVertexReference,
+              elementOffset<uint16_t>(offset + stripGroup.indexOffset, i),
+              "VTX index references a vertex outside its strip group"
+            );
+          }
+        }
+      }
+
+      if (!vtx.checkArray<VtxFormat::Strip>(
+          offset + stripGroup.stripOffset,
+          stripGroup.numStrips,
+          "VTX strip array is outside the file"
+      )) {
+        return;
+      }
+
+      for (int64_t i = 0; i < stripGroup.numStrips; i++) {
+        const auto stripOffset = elementOffset<VtxFormat::Strip>(offset + stripGroup.stripOffset, i);
+        VtxFormat::Strip strip{};
+        vtx.read(stripOffset, strip, "VTX strip is outside the file");
+
+        if (strip.numVerts < 0 || strip.vertOffset < 0
+            || static_cast<int64_t>(strip.vertOffset) + strip.numVerts > stripGroup.numVerts) {
+          vtx.addIssue(IssueType::OutOfBounds, stripOffset, "VTX strip accesses outside strip group vertex data");
+        }
+        if (strip.numIndices < 0 || strip.indexOffset < 0
+            || static_cast<int64_t>(strip.indexOffset) + strip.numIndices > stripGroup.numIndices) {
+          vtx.addIssue(IssueType::OutOfBounds, stripOffset, "VTX strip accesses outside strip group index data");
+        }
+
+        vtx.checkArray<VtxFormat::BoneStateChange>(
+          stripOffset + strip.boneStateChangeOffset,
+          strip.numBoneStateChanges,
+          "VTX bone state change array is outside the file"
+        );
+      }
+    }
+
+    void validateModel(
+      const Reader& mdl,
+      const Reader& vtx,
+      const Reader& vvd,
+      const int64_t mdlModelOffset,
+      const int64_t vtxModelOffset,
+      const int32_t expectedLods,
+      const VvdSummary& vvdSummary
+    ) {
+      MdlFormat::Model mdlModel{};
+      VtxFormat::Model vtxModel{};
+      if (!mdl.read(mdlModelOffset, mdlModel, "MDL model is outside the file")
+          || !vtx.read(vtxModelOffset, vtxModel, "VTX model is outside the file")) {
+        return;
+      }
+
+      // The model's offsets into the VVD are stored in bytes
+      constexpr auto vertexSize = static_cast<int64_t>(sizeof(VvdFormat::Vertex));
+      constexpr auto tangentSize = static_cast<int64_t>(sizeof(Structs::Vector4D));
+      const auto vertexIndex = static_cast<int64_t>(mdlModel.vertsOffset) / vertexSize;
+      const auto tangentIndex = static_cast<int64_t>(mdlModel.tangentsOffset) / tangentSize;
+      const auto isInVvd = [&](const int64_t index) {
+        return index >= 0 && index + mdlModel.vertsCount <= vvdSummary.vertexCount;
+      };
+
+      if (vvdSummary.valid && (mdlModel.vertsCount < 0 || !isInVvd(vertexIndex) || !isInVvd(tangentIndex))) {
+        vvd.addIssue(IssueType::InvalidVertexReference, 0, "MDL model vertex range is outside the VVD vertex data");
+      }
+
+      if (!mdl.checkArray<MdlFormat::Mesh>(
+          mdlModelOffset + mdlModel.meshesOffset,
+          mdlModel.meshesCount,
+          "MDL mesh array is outside the file"
+      )) {
+        return;
+      }
+
+      const auto readMdlMesh = [&](const int64_t index, MdlFormat::Mesh& mesh) {
+        return mdl.read(
+          elementOffset<MdlFormat::Mesh>(mdlModelOffset + mdlModel.meshesOffset, index),
+          mesh,
+          "MDL mesh is outside the file"
+        );
+      };
+
+      for (int64_t i = 0; i < mdlModel.meshesCount; i++) {
+        MdlFormat::Mesh mesh{};
+        readMdlMesh(i, mesh);
+
+        if (mesh.vertsCount < 0 || mesh.vertsOffset < 0
+            || static_cast<int64_t>(mesh.vertsOffset) + mesh.vertsCount > mdlModel.vertsCount) {
+          mdl.addIssue(
+            IssueType::InvalidVertexReference,
+            elementOffset<MdlFormat::Mesh>(mdlModelOffset + mdlModel.meshesOffset, i),
+            "MDL mesh vertex range is outside its model"
+          );
+        }
+      }
+
+      if (vtxModel.numLoDs != expectedLods) {
+        vtx.addIssue(IssueType::CountMismatch, vtxModelOffset, "VTX model LoD count does not match header");
+      }
+      if (!vtx.checkArray<VtxFormat::ModelLoD>(
+          vtxModelOffset + vtxModel.lodOffset,
+          vtxModel.numLoDs,
+          "VTX model LoD array is outside the file"
+      )) {
+        return;
+      }
+
+      for (int64_t lodIndex = 0; lodIndex < vtxModel.numLoDs; lodIndex++) {
+        const auto lodOffset = elementOffset<VtxFormat::ModelLoD>(vtxModelOffset + vtxModel.lodOffset, lodIndex);
+        VtxFormat::ModelLoD lod{};
+        vtx.read(lodOffset, lod, "VTX model LoD is outside the file");
+
+        if (lod.numMeshes != mdlModel.meshesCount) {
+          vtx.addIssue(IssueType::CountMismatch, lodOffset, "VTX mesh count does not match MDL");
+        }
+        if (!vtx.checkArray<VtxFormat::Mesh>(
+            lodOffset + lod.meshOffset,
+            lod.numMeshes,
+            "VTX mesh array is outside the file"
+        )) {
+          continue;
+        }
+
+        for (int64_t meshIndex = 0; meshIndex < lod.numMeshes && meshIndex < mdlModel.meshesCount; meshIndex++) {
+          const auto meshOffset = elementOffset<VtxFormat::Mesh>(lodOffset + lod.meshOffset, meshIndex);
+          VtxFormat::Mesh vtxMesh{};
+          MdlFormat::Mesh mdlMesh{};
+          vtx.read(meshOffset, vtxMesh, "VTX mesh is outside the file");
+          readMdlMesh(meshIndex, mdlMesh);
+
+          if (!vtx.checkArray<VtxFormat::StripGroup>(
+              meshOffset + vtxMesh.stripGroupHeaderOffset,
+              vtxMesh.numStripGroups,
+              "VTX strip group array is outside the file"
+          )) {
+            continue;
+          }
+
+          for (int64_t groupIndex = 0; groupIndex < vtxMesh.numStripGroups; groupIndex++) {
+            const auto groupOffset =
+              elementOffset<VtxFormat::StripGroup>(meshOffset + vtxMesh.stripGroupHeaderOffset, groupIndex);
+            VtxFormat::StripGroup stripGroup{};
+            vtx.read(groupOffset, stripGroup, "VTX strip group is outside the file");
+
+            validateStripGroup(vtx, groupOffset, stripGroup, mdlMesh.vertsCount);
+          }
+        }
+      }
+    }
+
+    void validateBodyParts(
+      const Reader& mdl,
+      const Reader& vtx,
+      const Reader& vvd,
+      const MdlFormat::Header& mdlHeader,
+      const VtxFormat::Header& vtxHeader,
+      const VvdSummary& vvdSummary
+    ) {
+      const auto count = std::min(mdlHeader.bodypartCount, vtxHeader.numBodyParts);
+
+      for (int64_t i = 0; i < count; i++) {
+        const auto mdlOffset = elementOffset<MdlFormat::BodyPart>(mdlHeader.bodypartOffset, i);
+        const auto vtxOffset = elementOffset<VtxFormat::BodyPart>(vtxHeader.bodyPartOffset, i);
+
+        MdlFormat::BodyPart mdlBodyPart{};
+        VtxFormat::BodyPart vtxBodyPart{};
+        if (!mdl.read(mdlOffset, mdlBodyPart, "MDL body part is outside the file")
+            || !vtx.read(vtxOffset, vtxBodyPart, "VTX body part is outside the file")) {
+          continue;
+        }
+
+        mdl.checkString(mdlOffset + mdlBodyPart.szNameIndex, "MDL body part name is outside the file");
+
+        if (mdlBodyPart.modelsCount != vtxBodyPart.numModels) {
+          vtx.addIssue(IssueType::CountMismatch, vtxOffset, "VTX model count does not match MDL");
+        }
+
+        const auto mdlModelsValid = mdl.checkArray<MdlFormat::Model>(
+          mdlOffset + mdlBodyPart.modelsOffset, mdlBodyPart.modelsCount, "MDL model array is outside the file"
+        );
+        const auto vtxModelsValid = vtx.checkArray<VtxFormat::Model>(
+          vtxOffset + vtxBodyPart.modelOffset, vtxBodyPart.numModels, "VTX model array is outside the file"
+        );
+        if (!mdlModelsValid || !vtxModelsValid) {
+          continue;
+        }
+
+        const auto modelCount = std::min(mdlBodyPart.modelsCount, vtxBodyPart.numModels);
+        for (int64_t model = 0; model < modelCount; model++) {
+          validateModel(
+            mdl,
+            vtx,
+            vvd,
+            elementOffset<MdlFormat::Model>(mdlOffset + mdlBodyPart.modelsOffset, model),
+            elementOffset<VtxFormat::Model>(vtxOffset + vtxBodyPart.modelOffset, model),
+            vtxHeader.numLoDs,
+            vvdSummary
+          );
+        }
+      }
+    }
+
+    /**
+     * Returns a bitmask of which of the 4 floats in the given 16 byte block are NaN or infinity.
+     */
+#ifdef MDLPARSER_VALIDATOR_SSE2
+    int nonFiniteMask(const std::byte* block) {
+      const auto exponentMask = _mm_set1_epi32(0x7f800000);
+      const auto bits = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block));
+      return _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(bits, exponentMask), exponentMask)));
+    }
+#else
+    int nonFiniteMask(const std::byte* block) {
+      int mask = 0;
+
+      for (int lane = 0; lane < 4; lane++) {
+        uint32_t bits;
+        std::memcpy(&bits, block + lane * sizeof(uint32_t), sizeof(bits));
+
+        if ((bits & 0x7f800000u) == 0x7f800000u) {
+          mask |= 1 << lane;
+        }
+      }
+
+      return mask;
+    }
+#endif
+
+    /**
+     * Problems with a vertex's bones, as bits of the result of checkBones().
+     */
+    enum BoneCheck : int {
+      INVALID_BONE_COUNT = 1 << 0,
+      INVALID_BONE_INDEX = 1 << 1,
+      INVALID_WEIGHT_SUM = 1 << 2,
+    };
+
+    constexpr size_t BONE_CHECK_LANES = 4;
+
+    int checkVertexBones(const std::byte* vertex, const int32_t boneCount) {
+      VvdFormat::BoneWeight boneWeights;
+      std::memcpy(&boneWeights, vertex + offsetof(VvdFormat::Vertex, boneWeights), sizeof(boneWeights));
+      if (boneWeights.numBones == 0 || boneWeights.numBones > Limits::MAX_NUM_BONES_PER_VERT) {
+        return INVALID_BONE_COUNT;
+      }
+
+      auto weightSum = 0.0f;
+      auto invalidBone = false;
+      for (size_t bone = 0; bone < boneWeights.numBones; bone++) {
+        invalidBone |= boneWeights.bone[bone] < 0 || boneWeights.bone[bone] >= boneCount;
+        weightSum += boneWeights.weight[bone];
+      }
+
+      return (invalidBone ? INVALID_BONE_INDEX : 0) |
+        (std::abs(weightSum - 1.0f) > WEIGHT_SUM_TOLERANCE ? INVALID_WEIGHT_SUM : 0);
+    }
+
+    /**
+     * Checks the bone count, bone indices and weight sum of up to BONE_CHECK_LANES consecutive vertices.
+     * @return The BoneCheck bits of each vertex.
+     */
+#ifdef MDLPARSER_VALIDATOR_SSE2
+    std::array<int, BONE_CHECK_LANES> checkBones(
+      const std::byte* vertices, const size_t count, const int32_t boneCount
+    ) {
+      std::array<int, BONE_CHECK_LANES> checks{};
+      if (count < BONE_CHECK_LANES) {
+        for (size_t lane = 0; lane < count; lane++) {
+          checks[lane] = checkVertexBones(vertices + lane * sizeof(VvdFormat::Vertex), boneCount);
+        }
+
+        return checks;
+      }
+
+      // Transposes the first 16 bytes of each vertex, so each register holds one field of all 4 vertices
+      const auto load = [&](const size_t lane) {
+        return _mm_castsi128_ps(
+          _mm_loadu_si128(reinterpret_cast<const __m128i*>(vertices + lane * sizeof(VvdFormat::Vertex)))
+        );
+      };
+      auto weight0 = load(0);
+      auto weight1 = load(1);
+      auto weight2 = load(2);
+      auto packedBones = load(3);
+      _MM_TRANSPOSE4_PS(weight0, weight1, weight2, packedBones);
+
+      // Each lane of packedBones holds the three signed bone indices in its low bytes and the bone count in its high
+      const auto bones = _mm_castps_si128(packedBones);
+      const auto numBones = _mm_srli_epi32(bones, 24);
+      const auto invalidCount = _mm_or_si128(
+        _mm_cmpeq_epi32(numBones, _mm_setzero_si128()),
+        _mm_cmpgt_epi32(numBones, _mm_set1_epi32(Limits::MAX_NUM_BONES_PER_VERT))
+      );
+
+      const auto boneCounts = _mm_set1_epi32(boneCount);
+      auto invalidBone = _mm_setzero_si128();
+      for (int bone = 0; bone < Limits::MAX_NUM_BONES_PER_VERT; bone++) {
+        // Shifting the byte to the top and back again sign extends it
+        const auto index = _mm_srai_epi32(_mm_sll_epi32(bones, _mm_cvtsi32_si128(24 - 8 * bone)), 24);
+        const auto inRange = _mm_andnot_si128(
+          _mm_cmplt_epi32(index, _mm_setzero_si128()), _mm_cmpgt_epi32(boneCounts, index)
+        );
+        const auto isUsed = _mm_cmpgt_epi32(numBones, _mm_set1_epi32(bone));
+        invalidBone = _mm_or_si128(invalidBone, _mm_andnot_si128(inRange, isUsed));
+      }
+
+      // Weights after the vertex's bone count are masked out, summing in the same order as checkVertexBones
+      const auto uses1 = _mm_castsi128_ps(_mm_cmpgt_epi32(numBones, _mm_set1_epi32(1)));
+      const auto uses2 = _mm_castsi128_ps(_mm_cmpgt_epi32(numBones, _mm_set1_epi32(2)));
+      const auto weightSum =
+        _mm_add_ps(_mm_add_ps(weight0, _mm_and_ps(weight1, uses1)), _mm_and_ps(weight2, uses2));
+      const auto difference = _mm_and_ps(
+        _mm_sub_ps(weightSum, _mm_set1_ps(1.0f)), _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff))
+      );
+      const auto invalidSum = _mm_cmpgt_ps(difference, _mm_set1_ps(WEIGHT_SUM_TOLERANCE));
+
+      const auto countMask = _mm_movemask_ps(_mm_castsi128_ps(invalidCount));
+      const auto boneMask = _mm_movemask_ps(_mm_castsi128_ps(invalidBone));
+      const auto sumMask = _mm_movemask_ps(invalidSum);
+      for (size_t lane = 0; lane < BONE_CHECK_LANES; lane++) {
+        if ((countMask >> lane & 1) != 0) {
+          checks[lane] = INVALID_BONE_COUNT;
+          continue;
+        }
+
+        checks[lane] = ((boneMask >> lane & 1) != 0 ? INVALID_BONE_INDEX : 0) |
+          ((sumMask >> lane & 1) != 0 ? INVALID_WEIGHT_SUM : 0);
+      }
+
+      return checks;
+    }
+#else
+    std::array<int, BONE_CHECK_LANES> checkBones(
+      const std::byte* vertices, const size_t count, const int32_t boneCount
+    ) {
+      std::array<int, BONE_CHECK_LANES> checks{};
+      for (size_t lane = 0; lane < count; lane++) {
+        checks[lane] = checkVertexBones(vertices + lane * sizeof(VvdFormat::Vertex), boneCount);
+      }
+
+      return checks;
+    }
+#endif
+
+    void scanVertices(const Reader& vvd, const VvdFormat::Header& header, const int32_t boneCount, Report& report) {
+      using VvdFormat::Vertex;
+
+      // The fourth lane of the first block holds the bone indices and count rather than a float
+      constexpr int weightLanes = 0b0111;
+
+      const auto vertexCount = static_cast<size_t>(header.numLoDVertices[0]);
+      const auto* vertices = &vvd.getData()[header.vertexDataOffset];
+      const auto* tangents = &vvd.getData()[header.tangentDataOffset];
+
+      std::array<int, BONE_CHECK_LANES> boneChecks{};
+      for (size_t i = 0; i < vertexCount; i++) {
+        const auto* vertex = vertices + i * sizeof(Vertex);
+        const auto lane = i % BONE_CHECK_LANES;
+        if (lane == 0) {
+          boneChecks = checkBones(vertex, std::min(vertexCount - i, BONE_CHECK_LANES), boneCount);
+        }
+
+        const auto vertexOffset = static_cast<int64_t>(header.vertexDataOffset + i * sizeof(Vertex));
+
+        const auto nonFinite =
+          (nonFiniteMask(vertex) & weightLanes) | nonFiniteMask(vertex + 16) | nonFiniteMask(vertex + 32);
+        if (nonFinite != 0) {
+          report.nonFiniteVertices++;
+          vvd.addIssue(IssueType::NonFiniteVertex, vertexOffset, "VVD vertex contains NaN or infinity");
+        }
+
+        if (nonFiniteMask(tangents + i * sizeof(Structs::Vector4D)) != 0) {
+          report.nonFiniteTangents++;
+          vvd.addIssue(
+            IssueType::NonFiniteVertex,
+            static_cast<int64_t>(header.tangentDataOffset + i * sizeof(Structs::Vector4D)),
+            "VVD tangent contains NaN or infinity"
+          );
+        }
+
+        const auto boneCheck = boneChecks[lane];
+        if ((boneCheck & INVALID_BONE_COUNT) != 0) {
+          report.invalidBoneWeights++;
+          vvd.addIssue(IssueType::InvalidBoneWeights, vertexOffset, "VVD vertex has an invalid number of bones");
+          continue;
+        }
+
+        if ((boneCheck & INVALID_BONE_INDEX) != 0) {
+          report.invalidBoneIndices++;
+          vvd.addIssue(
+            IssueType::InvalidBoneIndex, vertexOffset, "VVD vertex is weighted to a bone which does not exist"
+          );
+        }
+        if (nonFinite == 0 && (boneCheck & INVALID_WEIGHT_SUM) != 0) {
+          report.invalidBoneWeights++;
+          vvd.addIssue(IssueType::InvalidBoneWeights, vertexOffset, "VVD vertex bone weights do not sum to 1");
+        }
+      }
+
+      report.verticesScanned += vertexCount;
+    }
+  }
+
+  Report validate(
+    const std::span<const std::byte> mdl, const std::span<const std::byte> vtx, const std::span<const std::byte> vvd
+  ) noexcept {
+    Report report;
+    const Reader mdlReader(mdl, File::Mdl, report);
+    const Reader vtxReader(vtx, File::Vtx, report);
+    const Reader vvdReader(vvd, File::Vvd, report);
+
+    MdlFormat::Header mdlHeader{};
+    if (!validateMdlHeader(mdlReader, mdlHeader)) {
+      return report;
+    }
+
+    VvdFormat::Header vvdHeader{};
+    VvdSummary vvdSummary;
+    validateVvdHeader(vvdReader, mdlHeader, vvdHeader, vvdSummary);
+
+    VtxFormat::Header vtxHeader{};
+    if (validateVtxHeader(vtxReader, mdlHeader, vtxHeader)) {
+      validateBodyParts(mdlReader, vtxReader, vvdReader, mdlHeader, vtxHeader, vvdSummary);
+    }
+
+    if (vvdSummary.valid) {
+      scanVertices(vvdReader, vvdHeader, mdlHeader.boneCount, report);
+    }
+
+    return report;
+  }
+}
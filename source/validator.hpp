@@ -0,0 +1,152 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+/**
+ * Structural validation of MDL, VTX and VVD data without parsing it.
+ */
+namespace MdlParser::Validation {
+  /**
+   * The file an issue was found in.
+   */
+  enum class File : uint8_t {
+    Mdl,
+    Vtx,
+    Vvd,
+  };
+
+  /**
+   * Category of problem found by validate().
+   */
+  enum class IssueType : uint8_t {
+    /**
+     * A header has the wrong file ID or describes an impossible layout.
+     */
+    InvalidHeader,
+
+    /**
+     * The file's version is not supported by the parsers.
+     */
+    UnsupportedVersion,
+
+    /**
+     * The VTX or VVD checksum does not match the MDL's.
+     */
+    ChecksumMismatch,
+
+    /**
+     * An offset or count points outside the file, or a string is not terminated before the end of the file.
+     */
+    OutOfBounds,
+
+    /**
+     * The number of body parts, models, LoDs or meshes differs between the MDL and VTX, or the MDL's linear bone
+     * table does not have one entry per bone.
+     */
+    CountMismatch,
+
+    /**
+     * A vertex or index refers to a vertex which does not exist.
+     */
+    InvalidVertexReference,
+
+    /**
+     * A vertex or tangent contains NaN or infinity.
+     */
+    NonFiniteVertex,
+
+    /**
+     * A vertex is weighted to a bone which does not exist.
+     */
+    InvalidBoneIndex,
+
+    /**
+     * A vertex's bone weights do not sum to 1.
+     */
+    InvalidBoneWeights,
+  };
+
+  /**
+   * A single problem found by validate().
+   */
+  struct Issue {
+    IssueType type;
+    File file;
+
+    /**
+     * Offset in bytes into the file at which the offending structure (or value) starts.
+     */
+    size_t offset;
+
+    /**
+     * Static description of the problem.
+     */
+    const char* message;
+  };
+
+  /**
+   * Result of validating a model, held entirely inline so producing it never allocates.
+   */
+  struct Report {
+    /**
+     * Maximum number of issues recorded in detail. Further issues are still counted.
+     */
+    static constexpr size_t MAX_RECORDED_ISSUES = 32;
+
+    std::array<Issue, MAX_RECORDED_ISSUES> issues{};
+
+    /**
+     * Total number of issues found, which may exceed the number recorded.
+     */
+    size_t issueCount = 0;
+
+    size_t verticesScanned = 0;
+    size_t nonFiniteVertices = 0;
+    size_t nonFiniteTangents = 0;
+    size_t invalidBoneIndices = 0;
+    size_t invalidBoneWeights = 0;
+
+    /**
+     * Gets whether the model passed validation.
+     */
+    [[nodiscard]] bool isValid() const {
+      return issueCount == 0;
+    }
+
+    /**
+     * Gets the issues recorded in detail (at most MAX_RECORDED_ISSUES).
+     */
+    [[nodiscard]] std::span<const Issue> getIssues() const {
+      return std::span(issues).first(issueCount < MAX_RECORDED_ISSUES ? issueCount : MAX_RECORDED_ISSUES);
+    }
+  };
+
+  /**
+   * Checks that an MDL, VTX and VVD are well-formed and consistent with each other, without parsing them.
+   *
+   * Every offset, count and string used by the parsers is bounds checked: in the MDL the body parts, models, meshes,
+   * textures, skins, bones, linear bone table, animations, sequences (with their events and blend grids), include
+   * models, attachments and key values; in the VTX everything down to strips and their bone state changes, along with
+   * the material replacements; and in the VVD the vertices, tangents and fixups. The body part, model, LoD and mesh
+   * counts are compared between the MDL and VTX, and every VTX vertex and index is checked to land inside the VVD.
+   * All VVD vertices are also scanned for non-finite values, out of range bone indices and weights not summing to 1.
+   * With SSE2 the non-finite scan works on 16 bytes at a time, and the bone index and weight checks on 4 vertices.
+   *
+   * Allocation limits (see ParseLimits) are not checked, so the parsers may still reject a valid model which
+   * would need more memory than they are allowed.
+   *
+   * No heap allocations are made and no exceptions are thrown, so this is suitable for quickly rejecting
+   * malformed or malicious uploads before handing them to the (allocating) parsers.
+   *
+   * @param mdl Raw MDL data.
+   * @param vtx Raw VTX data.
+   * @param vvd Raw VVD data.
+   * @return Report detailing any problems found.
+   */
+  [[nodiscard]] Report validate(
+    std::span<const std::byte> mdl, std::span<const std::byte> vtx, std::span<const std::byte> vvd
+  ) noexcept;
+}
@@ -0,0 +1,123 @@
+#include "virtual-model.hpp"
+#include <algorithm>
+#include "errors.hpp"
+#include "helpers/normalise-path.hpp"
+
+namespace MdlParser {
+  namespace {
+    std::string toLower(const std::string_view value) {
+      std::string lower(value);
+      std::ranges::transform(lower, lower.begin(), [](const char character) {
+        return character >= 'A' && character <= 'Z' ? static_cast<char>(character - 'A' + 'a') : character;
+      });
+
+      return lower;
+    }
+  }
+
+  VirtualModel::VirtualModel(std::shared_ptr<const Mdl> model, IncludeModelCache& includes) {
+    appendGroup(std::move(model), {}, includes);
+  }
+
+  const std::vector<VirtualModel::Group>& VirtualModel::getGroups() const {
+    return groups;
+  }
+
+  const std::vector<VirtualModel::Reference>& VirtualModel::getSequences() const {
+    return sequences;
+  }
+
+  const std::vector<VirtualModel::Reference>& VirtualModel::getAnimations() const {
+    return animations;
+  }
+
+  const Mdl::Sequence& VirtualModel::getSequence(const size_t index) const {
+    if (index >= sequences.size()) {
+      throw Errors::OutOfBoundsAccess("Sequence index is outside range");
+    }
+
+    const auto& [group, groupIndex] = sequences[index];
+    return groups[group].model->getSequences()[groupIndex];
+  }
+
+  const Mdl::Animation& VirtualModel::getAnimation(const size_t index) const {
+    if (index >= animations.size()) {
+      throw Errors::OutOfBoundsAccess("Animation index is outside range");
+    }
+
+    const auto& [group, groupIndex] = animations[index];
+    return groups[group].model->getAnimations()[groupIndex];
+  }
+
+  std::optional<size_t> VirtualModel::findSequence(const std::string_view name) const {
+    const auto found = sequencesByName.find(toLower(name));
+    if (found == sequencesByName.end()) {
+      return std::nullopt;
+    }
+
+    return found->second;
+  }
+
+  void VirtualModel::appendGroup(std::shared_ptr<const Mdl> model, std::string path, IncludeModelCache& includes) {
+    const auto groupIndex = groups.size();
+    const auto& bones = model->getBones();
+    const auto& rootBones = groups.empty() ? bones : groups.front().model->getBones();
+
+    Group group{
+      .path = std::move(path),
+      .boneMap = std::vector<int32_t>(bones.size(), -1),
+      .masterBone = std::vector<int32_t>(rootBones.size(), -1),
+      .animationMap = std::vector<int32_t>(model->getAnimations().size(), -1),
+    };
+
+    // Bones are matched by name, as included models usually share only part of the skeleton
+    std::unordered_map<std::string, int32_t> rootBonesByName;
+    rootBonesByName.reserve(rootBones.size());
+    for (size_t i = 0; i < rootBones.size(); i++) {
+      rootBonesByName.try_emplace(toLower(rootBones[i].name), static_cast<int32_t>(i));
+    }
+
+    for (size_t i = 0; i < bones.size(); i++) {
+      const auto rootBone = rootBonesByName.find(toLower(bones[i].name));
+      if (rootBone != rootBonesByName.end()) {
+        group.boneMap[i] = rootBone->second;
+        group.masterBone[rootBone->second] = static_cast<int32_t>(i);
+      }
+    }
+
+    const auto& modelAnimations = model->getAnimations();
+    for (size_t i = 0; i < modelAnimations.size(); i++) {
+      const auto [existing, inserted] =
+        animationsByName.try_emplace(toLower(modelAnimations[i].name), animations.size());
+      if (inserted) {
+        animations.push_back({.group = groupIndex, .index = i});
+      }
+
+      group.animationMap[i] = static_cast<int32_t>(existing->second);
+    }
+
+    const auto& modelSequences = model->getSequences();
+    for (size_t i = 0; i < modelSequences.size(); i++) {
+      if (sequencesByName.try_emplace(toLower(modelSequences[i].name), sequences.size()).second) {
+        sequences.push_back({.group = groupIndex, .index = i});
+      }
+    }
+
+    // The model itself lives on the heap, so remains valid as groups grows
+    const auto& includeModels = model->getIncludeModels();
+    group.model = std::move(model);
+    groups.push_back(std::move(group));
+
+    for (const auto& includeModel : includeModels) {
+      auto includePath = getNormalisedPath(includeModel.name);
+      const auto alreadyIncluded = std::ranges::any_of(groups, [&](const Group& existing) {
+        return existing.path == includePath;
+      });
+
+      if (!alreadyIncluded) {
+        auto included = includes.get(includePath);
+        appendGroup(std::move(included), std::move(includePath), includes);
+      }
+    }
+  }
+}
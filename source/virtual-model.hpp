@@ -0,0 +1,127 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "include-model-cache.hpp"
+#include "mdl.hpp"
+
+namespace MdlParser {
+  /**
+   * Merges a model with the models it includes (recursively) into a single set of sequences and animations,
+   * mirroring how the engine resolves $includemodel.
+   *
+   * Sequences and animations from the model itself come first, followed by those of each included model in order.
+   * Where several define a sequence or animation with the same name, the first one found is used.
+   */
+  class VirtualModel {
+  public:
+    /**
+     * One of the models making up the virtual model. The first group is always the model itself.
+     */
+    struct Group {
+      /**
+       * The parsed model, shared with the IncludeModelCache and any other virtual models including it.
+       */
+      std::shared_ptr<const Mdl> model;
+
+      /**
+       * Normalised path the model was included by, or empty for the model itself.
+       */
+      std::string path;
+
+      /**
+       * Maps each of this group's bones to the bone with the same name in the root model, or -1 if there is none.
+       */
+      std::vector<int32_t> boneMap;
+
+      /**
+       * Maps each of the root model's bones to the bone with the same name in this group, or -1 if there is none.
+       */
+      std::vector<int32_t> masterBone;
+
+      /**
+       * Maps each of this group's animations to its index in getAnimations().
+       * Animations overridden by an earlier group's animation with the same name map to that animation instead.
+       */
+      std::vector<int32_t> animationMap;
+    };
+
+    /**
+     * Locates a sequence or animation within one of the groups.
+     */
+    struct Reference {
+      /**
+       * Index into getGroups().
+       */
+      size_t group;
+
+      /**
+       * Index into the group model's getSequences() or getAnimations().
+       */
+      size_t index;
+    };
+
+    /**
+     * Resolves the includes of a model and builds its merged sequence and animation tables.
+     * @param model The model to resolve the includes of.
+     * @param includes Cache to load included models through, which should be shared between all virtual models.
+     * @throws Errors::Error if an included model is malformed, or any exception thrown by the cache's loader.
+     */
+    VirtualModel(std::shared_ptr<const Mdl> model, IncludeModelCache& includes);
+
+    /**
+     * Gets the groups making up this virtual model, starting with the model itself.
+     * @return List of groups.
+     */
+    [[nodiscard]] const std::vector<Group>& getGroups() const;
+
+    /**
+     * Gets every sequence available to the model.
+     * @return List of references to sequences in the groups.
+     */
+    [[nodiscard]] const std::vector<Reference>& getSequences() const;
+
+    /**
+     * Gets every animation available to the model.
+     * @return List of references to animations in the groups.
+     */
+    [[nodiscard]] const std::vector<Reference>& getAnimations() const;
+
+    /**
+     * Gets the sequence at the given index into getSequences().
+     * @param index
+     * @return The sequence.
+     */
+    [[nodiscard]] const Mdl::Sequence& getSequence(size_t index) const;
+
+    /**
+     * Gets the animation at the given index into getAnimations().
+     * @param index
+     * @return The animation.
+     */
+    [[nodiscard]] const Mdl::Animation& getAnimation(size_t index) const;
+
+    /**
+     * Finds a sequence by name, ignoring case.
+     * @param name
+     * @return Index into getSequences(), or std::nullopt if there is no sequence with the name.
+     */
+    [[nodiscard]] std::optional<size_t> findSequence(std::string_view name) const;
+
+  private:
+    std::vector<Group> groups;
+    std::vector<Reference> sequences;
+    std::vector<Reference> animations;
+
+    std::unordered_map<std::string, size_t> sequencesByName;
+    std::unordered_map<std::string, size_t> animationsByName;
+
+    void appendGroup(std::shared_ptr<const Mdl> model, std::string path, IncludeModelCache& includes);
+  };
+}
@@ -0,0 +1,210 @@
+#include "vpk.hpp"
+#include <array>
+#include <cstdio>
+#include "helpers/mapped-file.hpp"
+#include "helpers/normalise-path.hpp"
+#include "helpers/offset-data-view.hpp"
+#include "structs/vpk.hpp"
+
+namespace MdlParser {
+  using Structs::Vpk::DirectoryEntry;
+  using Structs::Vpk::Header;
+  using Structs::Vpk::HeaderV2;
+
+  namespace {
+    std::filesystem::path getArchivePath(const std::filesystem::path& directoryPath, const uint16_t index) {
+      constexpr std::string_view directorySuffix = "_dir";
+      auto stem = directoryPath.stem().string();
+
+      if (stem.ends_with(directorySuffix)) {
+        stem.erase(stem.size() - directorySuffix.size());
+      }
+
+      std::array<char, 8> suffix{};
+      std::snprintf(suffix.data(), suffix.size(), "_%03u", static_cast<unsigned>(index));
+
+      return directoryPath.parent_path() / (stem + suffix.data() + directoryPath.extension().string());
+    }
+  }
+
+  Vpk::File::File(const std::span<const std::byte> view) : data(view) {}
+
+  Vpk::File::File(std::vector<std::byte> stitched) : stitched(std::move(stitched)) {
+    data = this->stitched;
+  }
+
+  std::span<const std::byte> Vpk::File::getData() const {
+    return data;
+  }
+
+  bool Vpk::File::isZeroCopy() const {
+    return stitched.empty();
+  }
+
+  Vpk::Vpk(const std::filesystem::path& directoryPath)
+    : directoryPath(directoryPath), directory(std::make_unique<MappedFile>(directoryPath)) {
+    const OffsetDataView dataView(directory->getData());
+    const auto header = valueOrThrow(dataView.parseStruct<Header>(0, "Failed to parse VPK header")).first;
+
+    if (header.signature != Header::SIGNATURE) {
+      throw InvalidHeader("VPK header signature does not match");
+    }
+    if (header.version < Header::MIN_SUPPORTED_VERSION || header.version > Header::MAX_SUPPORTED_VERSION) {
+      throw UnsupportedVersion("VPK version is unsupported");
+    }
+
+    const auto treeOffset = sizeof(Header) + (header.version >= 2 ? sizeof(HeaderV2) : 0);
+    dataSectionOffset = treeOffset + header.treeSize;
+    valueOrThrow(
+      checkBounds(treeOffset, header.treeSize, directory->getData().size(), "VPK directory tree exceeds file size")
+    );
+
+    size_t cursor = treeOffset;
+    const auto readString = [&]() {
+      auto string = valueOrThrow(dataView.parseString(cursor, "Failed to parse VPK directory tree string"));
+      cursor += string.size() + 1;
+      return string;
+    };
+
+    // The tree is three levels deep (extension, directory, filename), each terminated by an empty string
+    while (true) {
+      const auto extension = readString();
+      if (extension.empty()) {
+        break;
+      }
+
+      while (true) {
+        const auto directoryName = readString();
+        if (directoryName.empty()) {
+          break;
+        }
+
+        while (true) {
+          const auto fileName = readString();
+          if (fileName.empty()) {
+            break;
+          }
+
+          const auto entry =
+            valueOrThrow(dataView.parseStruct<DirectoryEntry>(cursor, "Failed to parse VPK directory entry")).first;
+          cursor += sizeof(DirectoryEntry);
+
+          if (entry.terminator != DirectoryEntry::TERMINATOR) {
+            throw InvalidBody("VPK directory entry is not terminated");
+          }
+
+          valueOrThrow(
+            checkBounds(cursor, entry.preloadBytes, dataSectionOffset, "VPK preload data exceeds directory tree")
+          );
+          const auto preload = directory->getData().subspan(cursor, entry.preloadBytes);
+          cursor += entry.preloadBytes;
+
+          // A single space is used in place of an empty directory or extension
+          std::string path;
+          if (directoryName != " ") {
+            path = directoryName + "/";
+          }
+          path += fileName;
+          if (extension != " ") {
+            path += "." + extension;
+          }
+
+          entries.insert_or_assign(
+            getNormalisedPath(path),
+            Entry{
+              .crc = entry.crc,
+              .archiveIndex = entry.archiveIndex,
+              .offset = entry.entryOffset,
+              .length = entry.entryLength,
+              .preload = preload,
+            }
+          );
+        }
+      }
+    }
+  }
+
+  Vpk::~Vpk() = default;
+
+  bool Vpk::contains(const std::string_view path) const {
+    return entries.contains(getNormalisedPath(path));
+  }
+
+  std::optional<Vpk::File> Vpk::open(const std::string_view path) const {
+    const auto found = entries.find(getNormalisedPath(path));
+    if (found == entries.end()) {
+      return std::nullopt;
+    }
+
+    const auto& entry = found->second;
+    if (entry.length == 0) {
+      return File(entry.preload);
+    }
+
+    std::span<const std::byte> archiveData;
+    size_t offset = entry.offset;
+
+    if (entry.archiveIndex == DirectoryEntry::DIRECTORY_ARCHIVE_INDEX) {
+      archiveData = directory->getData();
+      offset += dataSectionOffset;
+    } else {
+      archiveData = getArchive(entry.archiveIndex).getData();
+    }
+
+    valueOrThrow(checkBounds(offset, entry.length, archiveData.size(), "VPK entry accesses outside archive data"));
+    const auto remainder = archiveData.subspan(offset, entry.length);
+
+    if (entry.preload.empty()) {
+      return File(remainder);
+    }
+
+    std::vector<std::byte> stitched;
+    stitched.reserve(entry.preload.size() + remainder.size());
+    stitched.insert(stitched.end(), entry.preload.begin(), entry.preload.end());
+    stitched.insert(stitched.end(), remainder.begin(), remainder.end());
+
+    return File(std::move(stitched));
+  }
+
+  std::optional<Vpk::ModelFiles> Vpk::openModel(const std::string_view mdlPath, const std::string_view vtxExtension)
+    const {
+    const auto basePath = mdlPath.substr(0, mdlPath.rfind('.'));
+
+    auto mdl = open(mdlPath);
+    auto vtx = open(std::string(basePath).append(vtxExtension));
+    auto vvd = open(std::string(basePath).append(".vvd"));
+
+    if (!mdl || !vtx || !vvd) {
+      return std::nullopt;
+    }
+
+    return ModelFiles{.mdl = std::move(*mdl), .vtx = std::move(*vtx), .vvd = std::move(*vvd)};
+  }
+
+  std::optional<ModelTriple> Vpk::loadModel(const std::string_view mdlPath, const std::string_view vtxExtension)
+    const {
+    const auto files = openModel(mdlPath, vtxExtension);
+    if (!files) {
+      return std::nullopt;
+    }
+
+    return std::make_optional<ModelTriple>(files->mdl.getData(), files->vtx.getData(), files->vvd.getData());
+  }
+
+  size_t Vpk::getFileCount() const {
+    return entries.size();
+  }
+
+  const MappedFile& Vpk::getArchive(const uint16_t index) const {
+    std::scoped_lock lock(archivesMutex);
+
+    if (archives.size() <= index) {
+      archives.resize(index + 1);
+    }
+    if (!archives[index]) {
+      archives[index] = std::make_unique<MappedFile>(getArchivePath(directoryPath, index));
+    }
+
+    return *archives[index];
+  }
+}
@@ -0,0 +1,144 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "model-triple.hpp"
+
+namespace MdlParser {
+  class MappedFile;
+
+  /**
+   * Reads files directly out of a Valve pack file (VPK) without extracting them to disk.
+   *
+   * The directory file is memory mapped and its tree indexed by path when constructed,
+   * while the numbered archive chunks are mapped the first time a file inside them is opened.
+   */
+  class Vpk {
+  public:
+    /**
+     * A file read from the VPK.
+     * Where possible this is a view directly into the mapped archive, only holding a copy of the data when it had to be
+     * stitched together from preload bytes in the directory and the remainder in an archive.
+     * @remarks Views into the archive are only valid for as long as the Vpk which opened them.
+     */
+    class File {
+    public:
+      File(File&&) noexcept = default;
+      File& operator=(File&&) noexcept = default;
+      File(const File&) = delete;
+      File& operator=(const File&) = delete;
+      ~File() = default;
+
+      /**
+       * Gets the contents of the file.
+       * @return Contents of the file.
+       */
+      [[nodiscard]] std::span<const std::byte> getData() const;
+
+      /**
+       * Gets whether the data is a direct view into the memory mapped VPK rather than a copy.
+       */
+      [[nodiscard]] bool isZeroCopy() const;
+
+    private:
+      friend class Vpk;
+
+      explicit File(std::span<const std::byte> view);
+      explicit File(std::vector<std::byte> stitched);
+
+      std::span<const std::byte> data;
+      std::vector<std::byte> stitched;
+    };
+
+    /**
+     * The three files which together make up a model.
+     */
+    struct ModelFiles {
+      File mdl;
+      File vtx;
+      File vvd;
+    };
+
+    /**
+     * Opens and indexes a VPK.
+     * @param directoryPath Path to the directory file (usually ending in _dir.vpk), or to a standalone VPK.
+     * @throws std::system_error if the directory file cannot be mapped.
+     * @throws Errors::Error if the directory is malformed.
+     */
+    explicit Vpk(const std::filesystem::path& directoryPath);
+
+    ~Vpk();
+    Vpk(const Vpk&) = delete;
+    Vpk& operator=(const Vpk&) = delete;
+    Vpk(Vpk&&) = delete;
+    Vpk& operator=(Vpk&&) = delete;
+
+    /**
+     * Checks whether a file exists in the VPK.
+     * @param path Virtual path of the file (case-insensitive, either slash direction).
+     */
+    [[nodiscard]] bool contains(std::string_view path) const;
+
+    /**
+     * Opens a file in the VPK.
+     * @param path Virtual path of the file (case-insensitive, either slash direction).
+     * @return The file's data, or std::nullopt if no such file exists.
+     * @throws std::system_error if the archive containing the file cannot be mapped.
+     * @throws Errors::OutOfBoundsAccess if the entry points outside its archive.
+     */
+    [[nodiscard]] std::optional<File> open(std::string_view path) const;
+
+    /**
+     * Opens the MDL, VTX and VVD of a model.
+     * @param mdlPath Virtual path of the .mdl file.
+     * @param vtxExtension Extension of the VTX variant to use.
+     * @return The model's files, or std::nullopt if any of them do not exist.
+     */
+    [[nodiscard]] std::optional<ModelFiles> openModel(
+      std::string_view mdlPath, std::string_view vtxExtension = ".dx90.vtx"
+    ) const;
+
+    /**
+     * Opens and parses a model straight out of the VPK.
+     * @param mdlPath Virtual path of the .mdl file.
+     * @param vtxExtension Extension of the VTX variant to use.
+     * @return The parsed model, or std::nullopt if any of its files do not exist.
+     */
+    [[nodiscard]] std::optional<ModelTriple> loadModel(
+      std::string_view mdlPath, std::string_view vtxExtension = ".dx90.vtx"
+    ) const;
+
+    /**
+     * Gets the number of files in the VPK.
+     */
+    [[nodiscard]] size_t getFileCount() const;
+
+  private:
+    struct Entry {
+      uint32_t crc;
+      uint16_t archiveIndex;
+      uint32_t offset;
+      uint32_t length;
+      std::span<const std::byte> preload;
+    };
+
+    std::filesystem::path directoryPath;
+    std::unique_ptr<MappedFile> directory;
+    size_t dataSectionOffset;
+
+    std::unordered_map<std::string, Entry> entries;
+
+    mutable std::mutex archivesMutex;
+    mutable std::vector<std::unique_ptr<MappedFile>> archives;
+
+    [[nodiscard]] const MappedFile& getArchive(uint16_t index) const;
+  };
+}
@@ -3,190 +3,399 @@
 #include <cstdint>
 #include <optional>
 #include "errors.hpp"
+#include "helpers/heap-size.hpp"
 #include "helpers/offset-data-view.hpp"
+#include "helpers/stats-scope.hpp"
 
 namespace MdlParser {
   using Structs::Vtx::Header;
   using namespace Errors;
 
   namespace {
-    Vtx::Strip parseStrip(const Structs::Vtx::Strip& strip) {
-      return {
+    Expected<Vtx::Strip> parseStrip(const OffsetDataView& data, const Structs::Vtx::Strip& strip) {
+      const auto parsedChanges = data.parseStructArrayWithoutOffsets<Structs::Vtx::BoneStateChange>(
+        strip.boneStateChangeOffset,
+        strip.numBoneStateChanges,
+        "Failed to parse VTX bone state change array"
+      );
+      if (!parsedChanges) {
+        return std::unexpected(parsedChanges.error());
+      }
+
+      std::vector<Vtx::BoneStateChange> boneStateChanges;
+      if (auto reserved = data.reserve(boneStateChanges, parsedChanges->size()); !reserved) {
+        return std::unexpected(reserved.error());
+      }
+
+      for (const auto& change : *parsedChanges) {
+        boneStateChanges.push_back({ .hardwareId = change.hardwareId, .boneId = change.newBoneId });
+      }
+
+      return Vtx::Strip{
         .verticesCount = strip.numVerts,
         .verticesOffset = strip.vertOffset,
         .indicesCount = strip.numIndices,
         .indicesOffset = strip.indexOffset,
         .flags = strip.flags,
+        .bonesCount = strip.numBones,
+        .boneStateChanges = std::move(boneStateChanges),
       };
     }
 
-    Vtx::StripGroup parseStripGroup(const OffsetDataView& data, const Structs::Vtx::StripGroup& stripGroup) {
+    Expected<Vtx::StripGroup> parseStripGroup(const OffsetDataView& data, const Structs::Vtx::StripGroup& stripGroup) {
+      const auto parsedStrips = data.parseStructArray<Structs::Vtx::Strip>(
+        stripGroup.stripOffset,
+        stripGroup.numStrips,
+        "Failed to parse VTX strip array"
+      );
+      if (!parsedStrips) {
+        return std::unexpected(parsedStrips.error());
+      }
+
       std::vector<Vtx::Strip> strips;
-      strips.reserve(stripGroup.numStrips);
-
-      for (const auto& [strip, _] : data.parseStructArray<Structs::Vtx::Strip>(
-             stripGroup.stripOffset,
-             stripGroup.numStrips,
-             "Failed to parse VTX strip array"
-           )) {
-        checkBounds(
+      if (auto reserved = data.reserve(strips, stripGroup.numStrips); !reserved) {
+        return std::unexpected(reserved.error());
+      }
+
+      for (const auto& [strip, offset] : *parsedStrips) {
+        // Reported at the strip's offset, as the bounds being checked are relative to the strip group
+        const auto verticesInBounds = checkBounds(
           strip.vertOffset,
           strip.numVerts,
           stripGroup.numVerts,
           "VTX strip accesses outside strip group vertex data"
         );
-        checkBounds(
+        if (!verticesInBounds) {
+          return makeError(Reason::OutOfBoundsAccess, offset, verticesInBounds.error().message);
+        }
+
+        const auto indicesInBounds = checkBounds(
           strip.indexOffset,
           strip.numIndices,
           stripGroup.numIndices,
           "VTX strip accesses outside strip group index data"
         );
+        if (!indicesInBounds) {
+          return makeError(Reason::OutOfBoundsAccess, offset, indicesInBounds.error().message);
+        }
+
+        auto parsedStrip = parseStrip(data.withOffset(offset), strip);
+        if (!parsedStrip) {
+          return std::unexpected(parsedStrip.error());
+        }
 
-        strips.push_back(parseStrip(strip));
+        strips.push_back(std::move(*parsedStrip));
       }
 
-      return {
-        .vertices = data.parseStructArrayWithoutOffsets<Structs::Vtx::Vertex>(
-          stripGroup.vertOffset,
-          stripGroup.numVerts,
-          "Failed to parse VTX vertex array"
-        ),
-        .indices = data.parseStructArrayWithoutOffsets<uint16_t>(
-          stripGroup.indexOffset,
-          stripGroup.numIndices,
-          "Failed to parse VTX index array"
-        ),
+      auto vertices = data.parseStructArrayWithoutOffsets<Structs::Vtx::Vertex>(
+        stripGroup.vertOffset,
+        stripGroup.numVerts,
+        "Failed to parse VTX vertex array"
+      );
+      if (!vertices) {
+        return std::unexpected(vertices.error());
+      }
+
+      auto indices = data.parseStructArrayWithoutOffsets<uint16_t>(
+        stripGroup.indexOffset,
+        stripGroup.numIndices,
+        "Failed to parse VTX index array"
+      );
+      if (!indices) {
+        return std::unexpected(indices.error());
+      }
+
+      return Vtx::StripGroup{
+        .vertices = std::move(*vertices),
+        .indices = std::move(*indices),
         .strips = std::move(strips),
         .flags = stripGroup.flags,
       };
     }
 
-    Vtx::Mesh parseMesh(const OffsetDataView& data, const Structs::Vtx::Mesh& mesh) {
+    Expected<Vtx::Mesh> parseMesh(const OffsetDataView& data, const Structs::Vtx::Mesh& mesh) {
+      const auto parsedStripGroups = data.parseStructArray<Structs::Vtx::StripGroup>(
+        mesh.stripGroupHeaderOffset,
+        mesh.numStripGroups,
+        "Failed to parse VTX strip group array"
+      );
+      if (!parsedStripGroups) {
+        return std::unexpected(parsedStripGroups.error());
+      }
+
       std::vector<Vtx::StripGroup> stripGroups;
-      stripGroups.reserve(mesh.numStripGroups);
+      if (auto reserved = data.reserve(stripGroups, mesh.numStripGroups); !reserved) {
+        return std::unexpected(reserved.error());
+      }
+
+      for (const auto& [stripGroup, offset] : *parsedStripGroups) {
+        auto parsedStripGroup = parseStripGroup(data.withOffset(offset), stripGroup);
+        if (!parsedStripGroup) {
+          return std::unexpected(parsedStripGroup.error());
+        }
 
-      for (const auto& [stripGroup, offset] : data.parseStructArray<Structs::Vtx::StripGroup>(
-             mesh.stripGroupHeaderOffset,
-             mesh.numStripGroups,
-             "Failed to parse VTX strip group array"
-           )) {
-        stripGroups.push_back(parseStripGroup(data.withOffset(offset), stripGroup));
+        stripGroups.push_back(std::move(*parsedStripGroup));
       }
 
-      return { .stripGroups = stripGroups, .flags = mesh.flags };
+      return Vtx::Mesh{ .stripGroups = std::move(stripGroups), .flags = mesh.flags };
     }
 
-    Vtx::ModelLod parseModelLod(const OffsetDataView& data, const Structs::Vtx::ModelLoD& lod) {
+    Expected<Vtx::ModelLod> parseModelLod(const OffsetDataView& data, const Structs::Vtx::ModelLoD& lod) {
+      const auto parsedMeshes =
+        data.parseStructArray<Structs::Vtx::Mesh>(lod.meshOffset, lod.numMeshes, "Failed to parse VTX mesh array");
+      if (!parsedMeshes) {
+        return std::unexpected(parsedMeshes.error());
+      }
+
       std::vector<Vtx::Mesh> meshes;
-      meshes.reserve(lod.numMeshes);
+      if (auto reserved = data.reserve(meshes, lod.numMeshes); !reserved) {
+        return std::unexpected(reserved.error());
+      }
+
+      for (const auto& [mesh, offset] : *parsedMeshes) {
+        auto parsedMesh = parseMesh(data.withOffset(offset), mesh);
+        if (!parsedMesh) {
+          return std::unexpected(parsedMesh.error());
+        }
 
-      for (const auto& [mesh, offset] :
-           data.parseStructArray<Structs::Vtx::Mesh>(lod.meshOffset, lod.numMeshes, "Failed to parse VTX mesh array")) {
-        meshes.push_back(parseMesh(data.withOffset(offset), mesh));
+        meshes.push_back(std::move(*parsedMesh));
       }
 
-      return { .meshes = std::move(meshes), .switchPoint = lod.switchPoint };
+      return Vtx::ModelLod{ .meshes = std::move(meshes), .switchPoint = lod.switchPoint };
     }
 
-    Vtx::Model parseModel(const OffsetDataView& data, const Structs::Vtx::Model& model) {
+    Expected<Vtx::Model> parseModel(const OffsetDataView& data, const Structs::Vtx::Model& model) {
+      const auto parsedLods = data.parseStructArray<Structs::Vtx::ModelLoD>(
+        model.lodOffset,
+        model.numLoDs,
+        "Failed to parse VTX model LoD array"
+      );
+      if (!parsedLods) {
+        return std::unexpected(parsedLods.error());
+      }
+
       std::vector<Vtx::ModelLod> lods;
-      lods.reserve(model.numLoDs);
+      if (auto reserved = data.reserve(lods, model.numLoDs); !reserved) {
+        return std::unexpected(reserved.error());
+      }
+
+      for (const auto& [lod, offset] : *parsedLods) {
+        auto parsedLod = parseModelLod(data.withOffset(offset), lod);
+        if (!parsedLod) {
+          return std::unexpected(parsedLod.error());
+        }
 
-      for (const auto& [lod, offset] : data.parseStructArray<Structs::Vtx::ModelLoD>(
-             model.lodOffset,
-             model.numLoDs,
-             "Failed to parse VTX model LoD array"
-           )) {
-        lods.push_back(parseModelLod(data.withOffset(offset), lod));
+        lods.push_back(std::move(*parsedLod));
       }
 
-      return { .levelOfDetails = std::move(lods) };
+      return Vtx::Model{ .levelOfDetails = std::move(lods) };
     }
 
-    Vtx::BodyPart parseBodyPart(
+    Expected<Vtx::BodyPart> parseBodyPart(
       const OffsetDataView& data,
       const Structs::Vtx::BodyPart& bodyPart,
       const int32_t expectedLods
     ) {
+      const auto parsedModels = data.parseStructArray<Structs::Vtx::Model>(
+        bodyPart.modelOffset,
+        bodyPart.numModels,
+        "Failed to parse VTX model array"
+      );
+      if (!parsedModels) {
+        return std::unexpected(parsedModels.error());
+      }
+
       std::vector<Vtx::Model> models;
-      models.reserve(bodyPart.numModels);
+      if (auto reserved = data.reserve(models, bodyPart.numModels); !reserved) {
+        return std::unexpected(reserved.error());
+      }
 
-      for (const auto& [model, offset] : data.parseStructArray<Structs::Vtx::Model>(
-             bodyPart.modelOffset,
-             bodyPart.numModels,
-             "Failed to parse VTX model array"
-           )) {
+      for (const auto& [model, offset] : *parsedModels) {
         if (model.numLoDs != expectedLods) {
-          throw InvalidBody("VTX model LoD count does not match header");
+          return makeError(Reason::InvalidBody, offset, "VTX model LoD count does not match header");
+        }
+
+        auto parsedModel = parseModel(data.withOffset(offset), model);
+        if (!parsedModel) {
+          return std::unexpected(parsedModel.error());
+        }
+
+        models.push_back(std::move(*parsedModel));
+      }
+
+      return Vtx::BodyPart{ .models = std::move(models) };
+    }
+
+    Expected<std::vector<Vtx::MaterialReplacement>> parseMaterialReplacements(
+      const OffsetDataView& data,
+      const Structs::Vtx::MaterialReplacementList& replacementList
+    ) {
+      const auto parsedReplacements = data.parseStructArray<Structs::Vtx::MaterialReplacement>(
+        replacementList.replacementOffset,
+        replacementList.replacementCount,
+        "Failed to parse VTX material replacements"
+      );
+      if (!parsedReplacements) {
+        return std::unexpected(parsedReplacements.error());
+      }
+
+      std::vector<Vtx::MaterialReplacement> replacements;
+      if (auto reserved = data.reserve(replacements, replacementList.replacementCount); !reserved) {
+        return std::unexpected(reserved.error());
+      }
+
+      for (const auto& [replacement, offset] : *parsedReplacements) {
+        auto name = data.withOffset(offset).parseString(
+          replacement.replacementMaterialNameOffset,
+          "Failed to parse VTX material replacement name"
+        );
+        if (!name) {
+          return std::unexpected(name.error());
         }
 
-        models.push_back(parseModel(data.withOffset(offset), model));
+        replacements.push_back(
+          {
+            .replacementId = replacement.materialId,
+            .replacementName = std::move(*name),
+          }
+        );
       }
 
-      return { .models = std::move(models) };
+      return std::move(replacements);
     }
   }
 
-  Vtx::Vtx(const std::span<const std::byte> data, const std::optional<int32_t>& checksum) {
-    const OffsetDataView dataView(data);
-    header = dataView.parseStruct<Header>(0, "Failed to parse VTX header").first;
+  Vtx::Vtx(
+    const std::span<const std::byte> data,
+    const std::optional<int32_t>& checksum,
+    ParseStats* stats,
+    const ParseLimits& limits
+  )
+    : Vtx(valueOrThrow(tryParse(data, checksum, stats, limits))) {}
+
+  Expected<Vtx> Vtx::tryParse(
+    const std::span<const std::byte> data,
+    const std::optional<int32_t>& checksum,
+    ParseStats* stats,
+    const ParseLimits& limits
+  ) {
+    const StatsScope scope(stats, "vtx");
+    const OffsetDataView dataView(data, stats, limits);
+    Vtx vtx;
+
+    const auto parsedHeader = dataView.parseStruct<Header>(0, "Failed to parse VTX header");
+    if (!parsedHeader) {
+      return std::unexpected(parsedHeader.error());
+    }
+    const auto& header = vtx.header = parsedHeader->first;
 
     if (header.version != Header::SUPPORTED_VERSION) {
-      throw UnsupportedVersion("VTX version is unsupported");
+      return makeError(Reason::UnsupportedVersion, 0, "VTX version is unsupported");
     }
     if (checksum.has_value() && header.checksum != checksum.value()) {
-      throw InvalidChecksum("VTX checksum does not match");
+      return makeError(Reason::InvalidChecksum, 0, "VTX checksum does not match");
+    }
+
+    {
+      const StatsScope bodyPartsScope(stats, "vtx.bodyParts");
+      bodyPartsScope.addElements(header.numBodyParts);
+
+      const auto bodyParts = dataView.parseStructArray<Structs::Vtx::BodyPart>(
+        header.bodyPartOffset,
+        header.numBodyParts,
+        "Failed to parse VTX body part array"
+      );
+      if (!bodyParts) {
+        return std::unexpected(bodyParts.error());
+      }
+
+      if (auto reserved = dataView.reserve(vtx.bodyParts, header.numBodyParts); !reserved) {
+        return std::unexpected(reserved.error());
+      }
+      for (const auto& [bodyPart, offset] : *bodyParts) {
+        auto parsedBodyPart = parseBodyPart(dataView.withOffset(offset), bodyPart, header.numLoDs);
+        if (!parsedBodyPart) {
+          return std::unexpected(parsedBodyPart.error());
+        }
+
+        vtx.bodyParts.push_back(std::move(*parsedBodyPart));
+      }
     }
 
-    bodyParts.reserve(header.numBodyParts);
-    for (const auto& [bodyPart, offset] : dataView.parseStructArray<Structs::Vtx::BodyPart>(
-           header.bodyPartOffset,
-           header.numBodyParts,
-           "Failed to parse VTX body part array"
-         )) {
-      bodyParts.push_back(parseBodyPart(dataView.withOffset(offset), bodyPart, header.numLoDs));
+    const StatsScope materialReplacementsScope(stats, "vtx.materialReplacements");
+    materialReplacementsScope.addElements(header.numLoDs);
+
+    const auto replacementLists = dataView.parseStructArray<Structs::Vtx::MaterialReplacementList>(
+      header.materialReplacementListOffset,
+      header.numLoDs,
+      "Failed to parse VTX material replacement lists"
+    );
+    if (!replacementLists) {
+      return std::unexpected(replacementLists.error());
     }
 
-    materialReplacementsByLod.reserve(header.numLoDs);
-    for (const auto& [replacementList, replacementListOffset] :
-         dataView.parseStructArray<Structs::Vtx::MaterialReplacementList>(
-           header.materialReplacementListOffset,
-           header.numLoDs,
-           "Failed to parse VTX material replacement lists"
-         )) {
-      std::vector<MaterialReplacement> replacements;
-      replacements.reserve(replacementList.replacementCount);
-
-      for (const auto& [replacement, replacementOffset] : dataView.withOffset(replacementListOffset)
-           .parseStructArray<Structs::Vtx::MaterialReplacement>(
-             replacementList.replacementOffset,
-             replacementList.replacementCount,
-             "Failed to parse VTX material replacements"
-           )) {
-        replacements.push_back(
-          {
-            .replacementId = replacement.materialId,
-            .replacementName =
-            dataView.withOffset(replacementOffset)
-            .parseString(replacement.replacementMaterialNameOffset, "Failed to parse VTX material replacement name"),
-          }
-        );
+    if (auto reserved = dataView.reserve(vtx.materialReplacementsByLod, header.numLoDs); !reserved) {
+      return std::unexpected(reserved.error());
+    }
+    for (const auto& [replacementList, replacementListOffset] : *replacementLists) {
+      auto replacements = parseMaterialReplacements(dataView.withOffset(replacementListOffset), replacementList);
+      if (!replacements) {
+        return std::unexpected(replacements.error());
       }
 
-      materialReplacementsByLod.push_back(std::move(replacements));
+      vtx.materialReplacementsByLod.push_back(std::move(*replacements));
     }
+
+    return std::move(vtx);
   }
 
   int32_t Vtx::getChecksum() const {
     return header.checksum;
   }
 
+  uint16_t Vtx::getMaxBonesPerStrip() const {
+    return header.maxBonesPerStrip;
+  }
+
+  uint16_t Vtx::getMaxBonesPerTri() const {
+    return header.maxBonesPerTri;
+  }
+
+  int32_t Vtx::getMaxBonesPerVertex() const {
+    return header.maxBonesPerVert;
+  }
+
   const std::vector<Vtx::MaterialReplacement>& Vtx::getMaterialReplacements(const int lod) const {
-    checkBounds(lod, 1, materialReplacementsByLod.size(), "Level of detail is outside range");
+    valueOrThrow(checkBounds(lod, 1, materialReplacementsByLod.size(), "Level of detail is outside range"));
     return materialReplacementsByLod[lod];
   }
 
   const std::vector<Vtx::BodyPart>& Vtx::getBodyParts() const {
     return bodyParts;
   }
+
+  size_t Vtx::getMemoryUsage() const {
+    const auto getStripGroupSize = [](const StripGroup& stripGroup) {
+      return getHeapSize(stripGroup.vertices) + getHeapSize(stripGroup.indices) +
+        getHeapSize(stripGroup.strips, [](const Strip& strip) { return getHeapSize(strip.boneStateChanges); });
+    };
+    const auto getLodSize = [&](const ModelLod& lod) {
+      return getHeapSize(lod.meshes, [&](const Mesh& mesh) {
+        return getHeapSize(mesh.stripGroups, getStripGroupSize);
+      });
+    };
+    const auto getBodyPartSize = [&](const BodyPart& bodyPart) {
+      return getHeapSize(bodyPart.models, [&](const Model& model) {
+        return getHeapSize(model.levelOfDetails, getLodSize);
+      });
+    };
+    const auto getReplacementsSize = [](const std::vector<MaterialReplacement>& replacements) {
+      return getHeapSize(replacements, [](const MaterialReplacement& replacement) {
+        return getHeapSize(replacement.replacementName);
+      });
+    };
+
+    return sizeof(Vtx) + getHeapSize(bodyParts, getBodyPartSize) +
+      getHeapSize(materialReplacementsByLod, getReplacementsSize);
+  }
 }
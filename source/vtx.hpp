@@ -5,6 +5,9 @@
 #include <string>
 #include <vector>
 #include "enums.hpp"
+#include "errors.hpp"
+#include "parse-limits.hpp"
+#include "parse-stats.hpp"
 #include "structs/vtx.hpp"
 
 namespace MdlParser {
@@ -13,6 +16,20 @@ namespace MdlParser {
    */
   class Vtx {
   public:
+    /**
+     * Loads a bone into a slot of the hardware bone palette used for skinning.
+     */
+    struct BoneStateChange {
+      /**
+       * The palette slot, as referenced by the boneId of the strip group's vertices.
+       */
+      int32_t hardwareId;
+      /**
+       * The index of the bone in the MDL to load into the slot.
+       */
+      int32_t boneId;
+    };
+
     /**
      * A primitive storing offsets into the parent strip group's vertices and indices.
      */
@@ -39,6 +56,16 @@ namespace MdlParser {
        * Bitflags describing the strip.
        */
       Enums::Vtx::StripFlags flags;
+
+      /**
+       * The number of bones referenced by the strip's vertices.
+       */
+      int16_t bonesCount;
+      /**
+       * Changes to make to the hardware bone palette before drawing this strip.
+       * @remarks The palette is not reset between strips, so slots loaded by earlier strips in the group remain in use.
+       */
+      std::vector<BoneStateChange> boneStateChanges;
     };
 
     /**
@@ -130,10 +157,31 @@ namespace MdlParser {
      *
      * @param data
      * @param checksum Optional checksum to validate against the header's
+     * @param stats Optional sink for statistics about the parse
+     * @param limits Limits on the memory the parse may allocate
      */
     explicit Vtx(
       std::span<const std::byte> data,
-      const std::optional<int32_t>& checksum = std::nullopt
+      const std::optional<int32_t>& checksum = std::nullopt,
+      ParseStats* stats = nullptr,
+      const ParseLimits& limits = {}
+    );
+
+    /**
+     * Parses a .vtx file in the same way as the constructor, but returns any error instead of throwing it.
+     * Prefer this when parsing untrusted data where failures are expected to be common.
+     *
+     * @param data
+     * @param checksum Optional checksum to validate against the header's
+     * @param stats Optional sink for statistics about the parse
+     * @param limits Limits on the memory the parse may allocate
+     * @return The parsed Vtx, or the reason and offset parsing failed at.
+     */
+    [[nodiscard]] static Errors::Expected<Vtx> tryParse(
+      std::span<const std::byte> data,
+      const std::optional<int32_t>& checksum = std::nullopt,
+      ParseStats* stats = nullptr,
+      const ParseLimits& limits = {}
     );
 
     /**
@@ -143,6 +191,24 @@ namespace MdlParser {
      */
     [[nodiscard]] int32_t getChecksum() const;
 
+    /**
+     * Gets the maximum number of bones referenced by any one strip, i.e. the hardware bone palette size required.
+     * @return uint16_t maxBonesPerStrip
+     */
+    [[nodiscard]] uint16_t getMaxBonesPerStrip() const;
+
+    /**
+     * Gets the maximum number of bones referenced by any one triangle.
+     * @return uint16_t maxBonesPerTri
+     */
+    [[nodiscard]] uint16_t getMaxBonesPerTri() const;
+
+    /**
+     * Gets the maximum number of bones influencing any one vertex.
+     * @return int32_t maxBonesPerVert
+     */
+    [[nodiscard]] int32_t getMaxBonesPerVertex() const;
+
     /**
      * Gets the material replacements for a given level of detail.
      * @param lod
@@ -156,7 +222,15 @@ namespace MdlParser {
      */
     [[nodiscard]] const std::vector<BodyPart>& getBodyParts() const;
 
+    /**
+     * Gets the number of bytes of memory used by this instance, including everything it has allocated on the heap.
+     * @return Memory usage in bytes.
+     */
+    [[nodiscard]] size_t getMemoryUsage() const;
+
   private:
+    Vtx() = default;
+
     Structs::Vtx::Header header;
     std::vector<BodyPart> bodyParts;
     std::vector<std::vector<MaterialReplacement>> materialReplacementsByLod;
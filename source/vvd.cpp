@@ -1,91 +1,159 @@
 #include "vvd.hpp"
 #include <memory>
 #include <optional>
+#include "helpers/heap-size.hpp"
 #include "helpers/offset-data-view.hpp"
+#include "helpers/stats-scope.hpp"
 
 namespace MdlParser {
   using Structs::Vector4D;
   using namespace Structs::Vvd;
   using namespace Errors;
 
-  namespace {
-    constexpr auto FILE_ID = u'I' + (u'D' << 8u) + (u'S' << 16u) + (u'V' << 24u);
-  }
-
-  Vvd::Vvd(const std::span<const std::byte> data, const std::optional<int32_t>& checksum) {
-    const OffsetDataView dataView(data);
+  Vvd::Vvd(
+    const std::span<const std::byte> data,
+    const std::optional<int32_t>& checksum,
+    ParseStats* stats,
+    const ParseLimits& limits
+  )
+    : Vvd(valueOrThrow(tryParse(data, checksum, stats, limits))) {}
+
+  Expected<Vvd> Vvd::tryParse(
+    const std::span<const std::byte> data,
+    const std::optional<int32_t>& checksum,
+    ParseStats* stats,
+    const ParseLimits& limits
+  ) {
+    const StatsScope scope(stats, "vvd");
+    const OffsetDataView dataView(data, stats, limits);
     constexpr auto rootLod = 0;
+    Vvd vvd;
 
-    header = dataView.parseStruct<Header>(0, "Failed to parse VVD header").first;
+    const auto parsedHeader = dataView.parseStruct<Header>(0, "Failed to parse VVD header");
+    if (!parsedHeader) {
+      return std::unexpected(parsedHeader.error());
+    }
+    const auto& header = vvd.header = parsedHeader->first;
 
-    if (header.id != FILE_ID) {
-      throw InvalidHeader("VVD header ID does not match IDSV");
+    if (header.id != Header::FILE_ID) {
+      return makeError(Reason::InvalidHeader, 0, "VVD header ID does not match IDSV");
     }
     if (header.version != Header::SUPPORTED_VERSION) {
-      throw UnsupportedVersion("VVD version is unsupported");
+      return makeError(Reason::UnsupportedVersion, 0, "VVD version is unsupported");
     }
     if (checksum.has_value() && header.checksum != checksum.value()) {
-      throw InvalidChecksum("VVD checksum does not match");
+      return makeError(Reason::InvalidChecksum, 0, "VVD checksum does not match");
     }
 
     const auto numVertices = header.numLoDVertices[rootLod];
+    if (numVertices < 0 || header.numFixups < 0) {
+      return makeError(Reason::InvalidBody, 0, "VVD vertex or fixup count is negative");
+    }
+
     const auto sizeOfFixups = sizeof(Fixup) * header.numFixups;
     const auto sizeOfVertices = (sizeof(Vector4D) + sizeof(Vertex)) * numVertices;
     if (sizeof(Header) + sizeOfFixups + sizeOfVertices > data.size()) {
-      throw InvalidBody("Size of VVD with given number of vertices exceeds data size");
+      return makeError(Reason::InvalidBody, 0, "Size of VVD with given number of vertices exceeds data size");
     }
 
     if (header.numFixups == 0) {
-      vertices = dataView.parseStructArrayWithoutOffsets<Vertex>(
+      const StatsScope verticesScope(stats, "vvd.vertices");
+      verticesScope.addElements(numVertices);
+
+      auto vertices = dataView.parseStructArrayWithoutOffsets<Vertex>(
         header.vertexDataOffset,
         numVertices,
         "Failed to parse VVD vertices"
       );
-      tangents = dataView.parseStructArrayWithoutOffsets<Vector4D>(
+      if (!vertices) {
+        return std::unexpected(vertices.error());
+      }
+
+      auto tangents = dataView.parseStructArrayWithoutOffsets<Vector4D>(
         header.tangentDataOffset,
         numVertices,
         "Failed to parse VVD tangents"
       );
+      if (!tangents) {
+        return std::unexpected(tangents.error());
+      }
+
+      vvd.vertices = std::move(*vertices);
+      vvd.tangents = std::move(*tangents);
     } else {
+      const StatsScope fixupsScope(stats, "vvd.fixups");
+      fixupsScope.addElements(header.numFixups);
+
       const auto fixups = dataView.parseStructArrayWithoutOffsets<Fixup>(
         header.fixupTableOffset,
         header.numFixups,
         "Failed to parse VVD fixups"
       );
+      if (!fixups) {
+        return std::unexpected(fixups.error());
+      }
+
       const auto originalVertices = dataView.parseStructArrayWithoutOffsets<Vertex>(
         header.vertexDataOffset,
         numVertices,
         "Failed to parse VVD vertices"
       );
+      if (!originalVertices) {
+        return std::unexpected(originalVertices.error());
+      }
+
       const auto originalTangents = dataView.parseStructArrayWithoutOffsets<Vector4D>(
         header.tangentDataOffset,
         numVertices,
         "Failed to parse VVD tangents"
       );
+      if (!originalTangents) {
+        return std::unexpected(originalTangents.error());
+      }
 
-      vertices.reserve(numVertices);
-      tangents.reserve(numVertices);
+      if (auto reserved = dataView.reserve(vvd.vertices, numVertices); !reserved) {
+        return std::unexpected(reserved.error());
+      }
+      if (auto reserved = dataView.reserve(vvd.tangents, numVertices); !reserved) {
+        return std::unexpected(reserved.error());
+      }
 
-      for (const auto& fixup : fixups) {
+      for (size_t i = 0; i < fixups->size(); i++) {
+        const auto& fixup = (*fixups)[i];
         if (fixup.lod < rootLod || fixup.numVertices <= 0 || fixup.sourceVertexId < 0) {
           continue;
         }
 
-        checkBounds(fixup.sourceVertexId, fixup.numVertices, numVertices, "VVD fixup accesses outside vertex data");
+        const auto inBounds =
+          checkBounds(fixup.sourceVertexId, fixup.numVertices, numVertices, "VVD fixup accesses outside vertex data");
+        if (!inBounds) {
+          const auto fixupOffset = header.fixupTableOffset + i * sizeof(Fixup);
+          return makeError(Reason::OutOfBoundsAccess, fixupOffset, inBounds.error().message);
+        }
+
+        // Fixups may overlap, so without this a small file could expand to many times its vertex count
+        if (vvd.vertices.size() + fixup.numVertices > static_cast<size_t>(numVertices)) {
+          const auto fixupOffset = header.fixupTableOffset + i * sizeof(Fixup);
+          return makeError(
+            Reason::InvalidBody, fixupOffset, "VVD fixups produce more vertices than the level of detail"
+          );
+        }
 
-        vertices.insert(
-          vertices.end(),
-          originalVertices.begin() + fixup.sourceVertexId,
-          originalVertices.begin() + fixup.sourceVertexId + fixup.numVertices
+        vvd.vertices.insert(
+          vvd.vertices.end(),
+          originalVertices->begin() + fixup.sourceVertexId,
+          originalVertices->begin() + fixup.sourceVertexId + fixup.numVertices
         );
 
-        tangents.insert(
-          tangents.end(),
-          originalTangents.begin() + fixup.sourceVertexId,
-          originalTangents.begin() + fixup.sourceVertexId + fixup.numVertices
+        vvd.tangents.insert(
+          vvd.tangents.end(),
+          originalTangents->begin() + fixup.sourceVertexId,
+          originalTangents->begin() + fixup.sourceVertexId + fixup.numVertices
         );
       }
     }
+
+    return std::move(vvd);
   }
 
   int32_t Vvd::getChecksum() const {
@@ -100,6 +168,10 @@ namespace MdlParser {
     return tangents;
   }
 
+  size_t Vvd::getMemoryUsage() const {
+    return sizeof(Vvd) + getHeapSize(vertices) + getHeapSize(tangents);
+  }
+
   int32_t Vvd::getLevelsOfDetail() const {
     return header.numLoDs;
   }
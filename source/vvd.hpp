@@ -3,6 +3,9 @@
 #include <optional>
 #include <span>
 #include <vector>
+#include "errors.hpp"
+#include "parse-limits.hpp"
+#include "parse-stats.hpp"
 #include "structs/vvd.hpp"
 
 namespace MdlParser {
@@ -17,10 +20,31 @@ namespace MdlParser {
      *
      * @param data
      * @param checksum Optional checksum to validate against the header's.
+     * @param stats Optional sink for statistics about the parse.
+     * @param limits Limits on the memory the parse may allocate.
      */
     explicit Vvd(
       std::span<const std::byte> data,
-      const std::optional<int32_t>& checksum = std::nullopt
+      const std::optional<int32_t>& checksum = std::nullopt,
+      ParseStats* stats = nullptr,
+      const ParseLimits& limits = {}
+    );
+
+    /**
+     * Parses a .vvd file in the same way as the constructor, but returns any error instead of throwing it.
+     * Prefer this when parsing untrusted data where failures are expected to be common.
+     *
+     * @param data
+     * @param checksum Optional checksum to validate against the header's.
+     * @param stats Optional sink for statistics about the parse.
+     * @param limits Limits on the memory the parse may allocate.
+     * @return The parsed Vvd, or the reason and offset parsing failed at.
+     */
+    [[nodiscard]] static Errors::Expected<Vvd> tryParse(
+      std::span<const std::byte> data,
+      const std::optional<int32_t>& checksum = std::nullopt,
+      ParseStats* stats = nullptr,
+      const ParseLimits& limits = {}
     );
 
     /**
@@ -49,7 +73,15 @@ namespace MdlParser {
      */
     [[nodiscard]] int32_t getLevelsOfDetail() const;
 
+    /**
+     * Gets the number of bytes of memory used by this instance, including everything it has allocated on the heap.
+     * @return Memory usage in bytes.
+     */
+    [[nodiscard]] size_t getMemoryUsage() const;
+
   private:
+    Vvd() = default;
+
     Structs::Vvd::Header header;
     std::vector<Structs::Vvd::Vertex> vertices;
     std::vector<Structs::Vector4D> tangents;
@@ -0,0 +1,68 @@
+#include "welded-mesh.hpp"
+#include <algorithm>
+#include <limits>
+#include "errors.hpp"
+
+namespace MdlParser {
+  WeldedMesh weldMesh(const Mdl::Mesh& mdlMesh, const Vtx::Mesh& vtxMesh) {
+    constexpr auto unassigned = std::numeric_limits<uint32_t>::max();
+
+    if (mdlMesh.vertexCount < 0) {
+      throw Errors::OutOfBoundsAccess("MDL mesh has a negative vertex count");
+    }
+
+    // origMeshVertId is 16 bit and bounded by the mesh's vertex count, so a flat table is cheaper than hashing
+    constexpr size_t maxVertexCount = std::numeric_limits<uint16_t>::max() + 1;
+    std::vector<uint32_t> weldedIndices(std::min<size_t>(mdlMesh.vertexCount, maxVertexCount), unassigned);
+    WeldedMesh welded;
+
+    size_t indexCount = 0;
+    for (const auto& stripGroup : vtxMesh.stripGroups) {
+      indexCount += stripGroup.indices.size();
+    }
+
+    welded.indices.reserve(indexCount);
+    welded.stripGroups.reserve(vtxMesh.stripGroups.size());
+
+    std::vector<uint16_t> groupToWelded;
+    for (const auto& stripGroup : vtxMesh.stripGroups) {
+      groupToWelded.clear();
+      groupToWelded.reserve(stripGroup.vertices.size());
+
+      for (const auto& vertex : stripGroup.vertices) {
+        // Copied out as the packed struct leaves the field unaligned
+        const uint16_t origMeshVertId = vertex.origMeshVertId;
+        if (origMeshVertId >= weldedIndices.size()) {
+          throw Errors::OutOfBoundsAccess("VTX vertex references a vertex outside its MDL mesh");
+        }
+
+        auto& weldedIndex = weldedIndices[origMeshVertId];
+        if (weldedIndex == unassigned) {
+          weldedIndex = static_cast<uint32_t>(welded.vertices.size());
+          welded.vertices.push_back(origMeshVertId);
+        }
+
+        // At most one welded vertex exists per (16 bit) origMeshVertId, so this never truncates
+        groupToWelded.push_back(static_cast<uint16_t>(weldedIndex));
+      }
+
+      welded.stripGroups.push_back(
+        {
+          .indexOffset = static_cast<uint32_t>(welded.indices.size()),
+          .indexCount = static_cast<uint32_t>(stripGroup.indices.size()),
+          .flags = stripGroup.flags,
+        }
+      );
+
+      for (const auto index : stripGroup.indices) {
+        if (index >= groupToWelded.size()) {
+          throw Errors::OutOfBoundsAccess("VTX index references a vertex outside its strip group");
+        }
+
+        welded.indices.push_back(groupToWelded[index]);
+      }
+    }
+
+    return welded;
+  }
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "enums.hpp"
+#include "mdl.hpp"
+#include "vtx.hpp"
+
+namespace MdlParser {
+  /**
+   * A mesh whose strip groups have been merged to index into a single set of unique vertices.
+   *
+   * The VTX splits meshes into strip groups (e.g. hardware vs software skinned), each with its own copy of any vertices
+   * it uses, so the same vertex is often duplicated across several groups. Welding keeps one copy of each.
+   */
+  struct WeldedMesh {
+    /**
+     * The indices drawn by a single strip group of the original mesh.
+     */
+    struct StripGroupRange {
+      /**
+       * Offset of the strip group's first index in indices.
+       * The strip group's strips keep their indicesOffset, which is relative to this.
+       */
+      uint32_t indexOffset;
+
+      uint32_t indexCount;
+
+      Enums::Vtx::StripGroupFlags flags;
+    };
+
+    /**
+     * The unique vertices of the mesh in order of first use, as offsets into the mesh's vertices in the VVD
+     * (the VTX vertex origMeshVertId).
+     * @remarks The per-strip group hardware bone palette in the VTX vertices is not kept,
+     * use the bone weights of the VVD vertices instead.
+     */
+    std::vector<uint16_t> vertices;
+
+    /**
+     * The indices of every strip group, in strip group order, indexing into vertices.
+     */
+    std::vector<uint16_t> indices;
+
+    /**
+     * The range of indices drawn by each of the original strip groups.
+     */
+    std::vector<StripGroupRange> stripGroups;
+  };
+
+  /**
+   * Welds the strip groups of a mesh into a single unique vertex buffer keyed by origMeshVertId.
+   * @param mdlMesh Mesh in the MDL data, giving the number of vertices in the mesh.
+   * @param vtxMesh The corresponding mesh in the VTX data at the desired level of detail.
+   * @return The welded mesh.
+   * @throws Errors::OutOfBoundsAccess if a vertex or index refers to a vertex outside of the mesh.
+   */
+  [[nodiscard]] WeldedMesh weldMesh(const Mdl::Mesh& mdlMesh, const Vtx::Mesh& vtxMesh);
+}
@@ -0,0 +1,522 @@
+/**
+ * mdlstat - parses every model in a directory tree in parallel and reports aggregate statistics about them.
+ *
+ * Usage: mdlstat <directory> [--format json|csv] [--threads N] [--vtx-extension .dx90.vtx] [--outliers N]
+ */
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <new>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+#include "../MDLParser.hpp"
+
+namespace {
+  /**
+   * Heap allocations made by the current thread, counted by the replacement operator new below so that every
+   * allocation made while parsing is measured, whether or not parse statistics are compiled in.
+   */
+  thread_local size_t allocationCount = 0;
+}
+
+void* operator new(const size_t size) {
+  allocationCount++;
+  if (auto* pointer = std::malloc(size == 0 ? 1 : size)) {
+    return pointer;
+  }
+
+  throw std::bad_alloc();
+}
+
+void* operator new(const size_t size, const std::align_val_t alignment) {
+  allocationCount++;
+
+  // aligned_alloc requires the size to be a multiple of the alignment
+  const auto align = static_cast<size_t>(alignment);
+  if (auto* pointer = std::aligned_alloc(align, (std::max<size_t>(size, 1) + align - 1) / align * align)) {
+    return pointer;
+  }
+
+  throw std::bad_alloc();
+}
+
+void operator delete(void* pointer) noexcept {
+  std::free(pointer);
+}
+
+void operator delete(void* pointer, size_t) noexcept {
+  std::free(pointer);
+}
+
+void operator delete(void* pointer, std::align_val_t) noexcept {
+  std::free(pointer);
+}
+
+void operator delete(void* pointer, size_t, std::align_val_t) noexcept {
+  std::free(pointer);
+}
+
+namespace {
+  using namespace MdlParser;
+  using Clock = std::chrono::steady_clock;
+
+  enum class Format : uint8_t {
+    JSON,
+    CSV,
+  };
+
+  struct Options {
+    std::filesystem::path directory;
+    Format format = Format::JSON;
+    size_t threadCount = std::max(1U, std::thread::hardware_concurrency());
+    std::string vtxExtension = ".dx90.vtx";
+    size_t outlierCount = 10;
+  };
+
+  /**
+   * The measurements taken of each model, in the order they are reported.
+   */
+  enum Metric : uint8_t {
+    VERTICES,
+    INDICES,
+    BONES,
+    LODS,
+    STRIP_GROUPS,
+    MATERIALS,
+    FILE_BYTES,
+    PARSE_MICROSECONDS_PER_MEGABYTE,
+    PARSE_ALLOCATIONS,
+    MEMORY_BYTES,
+    METRIC_COUNT,
+  };
+
+  constexpr std::array<std::string_view, METRIC_COUNT> METRIC_NAMES{
+    "vertices",
+    "indices",
+    "bones",
+    "lods",
+    "stripGroups",
+    "materials",
+    "fileBytes",
+    "parseMicrosecondsPerMegabyte",
+    "parseAllocations",
+    "memoryBytes",
+  };
+
+  struct ModelResult {
+    std::filesystem::path path;
+    std::array<double, METRIC_COUNT> metrics{};
+
+    /**
+     * Why the model failed to load, or empty if it was parsed successfully.
+     */
+    std::string failure;
+  };
+
+  std::string_view getReasonName(const Errors::Reason reason) {
+    switch (reason) {
+      case Errors::Reason::InvalidHeader:
+        return "InvalidHeader";
+      case Errors::Reason::InvalidBody:
+        return "InvalidBody";
+      case Errors::Reason::InvalidChecksum:
+        return "InvalidChecksum";
+      case Errors::Reason::UnsupportedVersion:
+        return "UnsupportedVersion";
+      case Errors::Reason::OutOfBoundsAccess:
+        return "OutOfBoundsAccess";
+      case Errors::Reason::AllocationLimitExceeded:
+        return "AllocationLimitExceeded";
+    }
+
+    return "Unknown";
+  }
+
+  std::optional<std::vector<std::byte>> readFile(const std::filesystem::path& path) {
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file) {
+      return std::nullopt;
+    }
+
+    std::vector<std::byte> data(static_cast<size_t>(file.tellg()));
+    file.seekg(0);
+    if (!file.read(reinterpret_cast<char*>(data.data()), static_cast<std::streamsize>(data.size()))) {
+      return std::nullopt;
+    }
+
+    return std::move(data);
+  }
+
+  void measure(const ModelTriple& model, ModelResult& result) {
+    auto& metrics = result.metrics;
+    metrics[VERTICES] = static_cast<double>(model.vvd.getVertices().size());
+    metrics[BONES] = static_cast<double>(model.mdl.getBones().size());
+    metrics[LODS] = model.vvd.getLevelsOfDetail();
+    metrics[MATERIALS] = static_cast<double>(model.mdl.getTextures().size());
+    metrics[MEMORY_BYTES] = static_cast<double>(model.getMemoryUsage());
+
+    // Indices are counted at the highest level of detail, strip groups across all of them
+    for (const auto& bodyPart : model.vtx.getBodyParts()) {
+      for (const auto& vtxModel : bodyPart.models) {
+        for (size_t lod = 0; lod < vtxModel.levelOfDetails.size(); lod++) {
+          for (const auto& mesh : vtxModel.levelOfDetails[lod].meshes) {
+            metrics[STRIP_GROUPS] += static_cast<double>(mesh.stripGroups.size());
+
+            if (lod == 0) {
+              for (const auto& stripGroup : mesh.stripGroups) {
+                metrics[INDICES] += static_cast<double>(stripGroup.indices.size());
+              }
+            }
+          }
+        }
+      }
+    }
+  }
+
+  ModelResult analyse(const std::filesystem::path& mdlPath, const Options& options) {
+    ModelResult result{ .path = mdlPath };
+    const auto paths = ModelPaths::fromMdl(mdlPath, options.vtxExtension);
+
+    const auto mdlData = readFile(paths.mdl);
+    const auto vtxData = readFile(paths.vtx);
+    const auto vvdData = readFile(paths.vvd);
+    if (!mdlData || !vtxData || !vvdData) {
+      result.failure = "MissingFile";
+      return result;
+    }
+
+    const auto bytes = mdlData->size() + vtxData->size() + vvdData->size();
+    result.metrics[FILE_BYTES] = static_cast<double>(bytes);
+
+    try {
+      const auto allocationsBefore = allocationCount;
+      const auto start = Clock::now();
+      const ModelTriple model(*mdlData, *vtxData, *vvdData);
+      const std::chrono::duration<double, std::micro> parseTime = Clock::now() - start;
+      const auto allocations = allocationCount - allocationsBefore;
+
+      result.metrics[PARSE_MICROSECONDS_PER_MEGABYTE] =
+        bytes > 0 ? parseTime.count() / (static_cast<double>(bytes) / (1024.0 * 1024.0)) : 0.0;
+      result.metrics[PARSE_ALLOCATIONS] = static_cast<double>(allocations);
+      measure(model, result);
+    } catch (Errors::Error& error) {
+      result.failure = getReasonName(error.getReason());
+    } catch (const std::exception&) {
+      result.failure = "Other";
+    }
+
+    return result;
+  }
+
+  struct Summary {
+    size_t count = 0;
+    double min = 0;
+    double mean = 0;
+    double p50 = 0;
+    double p90 = 0;
+    double p99 = 0;
+    double max = 0;
+
+    /**
+     * Number of values in each power of two bucket, keyed by the bucket's exclusive upper bound.
+     */
+    std::map<double, size_t> histogram;
+  };
+
+  Summary summarise(std::vector<double> values) {
+    Summary summary{ .count = values.size() };
+    if (values.empty()) {
+      return summary;
+    }
+
+    std::ranges::sort(values);
+    const auto percentile = [&](const double fraction) {
+      const auto rank = static_cast<size_t>(std::ceil(fraction * static_cast<double>(values.size())));
+      return values[std::clamp<size_t>(rank, 1, values.size()) - 1];
+    };
+
+    summary.min = values.front();
+    summary.max = values.back();
+    summary.p50 = percentile(0.5);
+    summary.p90 = percentile(0.9);
+    summary.p99 = percentile(0.99);
+
+    double total = 0;
+    for (const auto value : values) {
+      total += value;
+      summary.histogram[value < 1.0 ? 1.0 : std::exp2(std::floor(std::log2(value)) + 1.0)]++;
+    }
+    summary.mean = total / static_cast<double>(values.size());
+
+    return summary;
+  }
+
+  std::string escapeJson(const std::string_view text) {
+    std::string escaped;
+    for (const auto character : text) {
+      if (character == '"' || character == '\\') {
+        escaped += '\\';
+        escaped += character;
+      } else if (static_cast<unsigned char>(character) < 0x20) {
+        escaped += ' ';
+      } else {
+        escaped += character;
+      }
+    }
+
+    return escaped;
+  }
+
+  std::string escapeCsv(const std::string_view text) {
+    if (text.find_first_of(",\"\n") == std::string_view::npos) {
+      return std::string(text);
+    }
+
+    std::string escaped = "\"";
+    for (const auto character : text) {
+      if (character == '"') {
+        escaped += '"';
+      }
+      escaped += character;
+    }
+
+    return escaped + '"';
+  }
+
+  void writeJson(
+    std::ostream& output,
+    const std::vector<ModelResult>& results,
+    const std::array<Summary, METRIC_COUNT>& summaries,
+    const std::map<std::string, size_t>& failures,
+    const double elapsedSeconds,
+    const Options& options
+  ) {
+    output << std::setprecision(10) << "{\n";
+    output << "  \"files\": " << results.size() << ",\n";
+    output << "  \"parsed\": " << summaries[VERTICES].count << ",\n";
+    output << "  \"elapsedSeconds\": " << elapsedSeconds << ",\n";
+
+    output << "  \"failures\": {";
+    auto first = true;
+    for (const auto& [reason, count] : failures) {
+      output << (first ? "" : ",") << "\n    \"" << reason << "\": " << count;
+      first = false;
+    }
+    output << (failures.empty() ? "},\n" : "\n  },\n");
+
+    output << "  \"metrics\": {";
+    for (size_t metric = 0; metric < METRIC_COUNT; metric++) {
+      const auto& summary = summaries[metric];
+      output << (metric == 0 ? "" : ",") << "\n    \"" << METRIC_NAMES[metric] << "\": {";
+      output << "\"min\": " << summary.min << ", \"mean\": " << summary.mean << ", \"p50\": " << summary.p50
+             << ", \"p90\": " << summary.p90 << ", \"p99\": " << summary.p99 << ", \"max\": " << summary.max;
+
+      output << ", \"histogram\": [";
+      first = true;
+      for (const auto& [below, count] : summary.histogram) {
+        output << (first ? "" : ", ") << "{\"below\": " << below << ", \"count\": " << count << "}";
+        first = false;
+      }
+      output << "]}";
+    }
+    output << "\n  },\n";
+
+    // The worst offenders for load time and memory, which are the assets worth looking at first
+    output << "  \"outliers\": {";
+    first = true;
+    for (const auto metric : {PARSE_MICROSECONDS_PER_MEGABYTE, MEMORY_BYTES}) {
+      std::vector<const ModelResult*> parsed;
+      for (const auto& result : results) {
+        if (result.failure.empty()) {
+          parsed.push_back(&result);
+        }
+      }
+
+      const auto outlierCount = std::min(options.outlierCount, parsed.size());
+      const auto getValue = [&](const ModelResult* result) { return result->metrics[metric]; };
+      const auto outliersEnd = parsed.begin() + static_cast<std::ptrdiff_t>(outlierCount);
+      std::ranges::partial_sort(parsed, outliersEnd, std::greater{}, getValue);
+
+      output << (first ? "" : ",") << "\n    \"" << METRIC_NAMES[metric] << "\": [";
+      for (size_t outlier = 0; outlier < outlierCount; outlier++) {
+        output << (outlier == 0 ? "" : ",") << "\n      {\"path\": \"" << escapeJson(parsed[outlier]->path.string())
+               << "\", \"value\": " << parsed[outlier]->metrics[metric] << "}";
+      }
+      output << (outlierCount == 0 ? "]" : "\n    ]");
+      first = false;
+    }
+    output << "\n  }\n}\n";
+  }
+
+  void writeCsv(
+    std::ostream& output,
+    const std::array<Summary, METRIC_COUNT>& summaries,
+    const std::map<std::string, size_t>& failures
+  ) {
+    output << std::setprecision(10) << "section,name,count,min,mean,p50,p90,p99,max\n";
+    for (size_t metric = 0; metric < METRIC_COUNT; metric++) {
+      const auto& summary = summaries[metric];
+      output << "metric," << METRIC_NAMES[metric] << ',' << summary.count << ',' << summary.min << ',' << summary.mean
+             << ',' << summary.p50 << ',' << summary.p90 << ',' << summary.p99 << ',' << summary.max << '\n';
+    }
+
+    for (size_t metric = 0; metric < METRIC_COUNT; metric++) {
+      for (const auto& [below, count] : summaries[metric].histogram) {
+        output << "histogram," << METRIC_NAMES[metric] << "<" << below << ',' << count << ",,,,,,\n";
+      }
+    }
+
+    for (const auto& [reason, count] : failures) {
+      output << "failure," << escapeCsv(reason) << ',' << count << ",,,,,,\n";
+    }
+  }
+
+  std::optional<size_t> parseCount(const std::string_view text) {
+    size_t count = 0;
+    const auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), count);
+    if (error != std::errc() || end != text.data() + text.size()) {
+      return std::nullopt;
+    }
+
+    return count;
+  }
+
+  std::optional<Options> parseArguments(const int argc, char** argv) {
+    Options options;
+    for (auto argument = 1; argument < argc; argument++) {
+      const std::string_view name = argv[argument];
+      const auto hasValue = argument + 1 < argc;
+
+      if (name == "--format" && hasValue) {
+        const std::string_view format = argv[++argument];
+        if (format == "json") {
+          options.format = Format::JSON;
+        } else if (format == "csv") {
+          options.format = Format::CSV;
+        } else {
+          return std::nullopt;
+        }
+      } else if (name == "--threads" && hasValue) {
+        const auto threadCount = parseCount(argv[++argument]);
+        if (!threadCount || *threadCount == 0) {
+          return std::nullopt;
+        }
+        options.threadCount = *threadCount;
+      } else if (name == "--vtx-extension" && hasValue) {
+        options.vtxExtension = argv[++argument];
+      } else if (name == "--outliers" && hasValue) {
+        const auto outlierCount = parseCount(argv[++argument]);
+        if (!outlierCount) {
+          return std::nullopt;
+        }
+        options.outlierCount = *outlierCount;
+      } else if (options.directory.empty() && !name.starts_with("--")) {
+        options.directory = name;
+      } else {
+        return std::nullopt;
+      }
+    }
+
+    if (options.directory.empty()) {
+      return std::nullopt;
+    }
+
+    return options;
+  }
+
+  std::vector<std::filesystem::path> findModels(const std::filesystem::path& directory) {
+    std::vector<std::filesystem::path> models;
+    for (const auto& entry : std::filesystem::recursive_directory_iterator(
+           directory, std::filesystem::directory_options::skip_permission_denied
+         )) {
+      auto extension = entry.path().extension().string();
+      std::ranges::transform(extension, extension.begin(), [](const unsigned char character) {
+        return std::tolower(character);
+      });
+
+      if (extension == ".mdl" && entry.is_regular_file()) {
+        models.push_back(entry.path());
+      }
+    }
+
+    return models;
+  }
+}
+
+int main(const int argc, char** argv) {
+  const auto options = parseArguments(argc, argv);
+  if (!options) {
+    std::cerr << "Usage: mdlstat <directory> [--format json|csv] [--threads N] [--vtx-extension .dx90.vtx] "
+                 "[--outliers N]\n";
+    return 2;
+  }
+
+  std::vector<std::filesystem::path> models;
+  try {
+    models = findModels(options->directory);
+  } catch (const std::filesystem::filesystem_error& error) {
+    std::cerr << "mdlstat: " << error.what() << '\n';
+    return 1;
+  }
+
+  const auto start = Clock::now();
+
+  // Workers claim models one at a time, so a few huge models cannot leave the other threads idle
+  std::vector<ModelResult> results(models.size());
+  std::atomic<size_t> nextModel = 0;
+  std::vector<std::thread> workers;
+
+  for (size_t worker = 0; worker < std::min(options->threadCount, std::max<size_t>(models.size(), 1)); worker++) {
+    workers.emplace_back([&] {
+      for (auto model = nextModel.fetch_add(1); model < models.size(); model = nextModel.fetch_add(1)) {
+        results[model] = analyse(models[model], *options);
+      }
+    });
+  }
+
+  for (auto& worker : workers) {
+    worker.join();
+  }
+
+  const std::chrono::duration<double> elapsed = Clock::now() - start;
+
+  std::array<std::vector<double>, METRIC_COUNT> values;
+  std::map<std::string, size_t> failures;
+  for (const auto& result : results) {
+    if (!result.failure.empty()) {
+      failures[result.failure]++;
+      continue;
+    }
+
+    for (size_t metric = 0; metric < METRIC_COUNT; metric++) {
+      values[metric].push_back(result.metrics[metric]);
+    }
+  }
+
+  std::array<Summary, METRIC_COUNT> summaries;
+  for (size_t metric = 0; metric < METRIC_COUNT; metric++) {
+    summaries[metric] = summarise(std::move(values[metric]));
+  }
+
+  if (options->format == Format::JSON) {
+    writeJson(std::cout, results, summaries, failures, elapsed.count(), *options);
+  } else {
+    writeCsv(std::cout, summaries, failures);
+  }
+
+  return 0;
+}